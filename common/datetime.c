@@ -4,6 +4,12 @@
 #include <openenclave/internal/datetime.h>
 #include <openenclave/internal/raise.h>
 
+#ifdef OE_BUILD_ENCLAVE
+#include <openenclave/corelibc/time.h>
+#else
+#include <time.h>
+#endif
+
 #define UNIX_EPOCH_YEAR (1970)
 
 oe_result_t oe_datetime_is_valid(const oe_datetime_t* datetime)
@@ -221,3 +227,43 @@ int32_t oe_datetime_compare(
 
     return 0;
 }
+
+oe_result_t oe_datetime_now(oe_datetime_t* value)
+{
+    oe_result_t result = OE_FAILURE;
+#ifdef OE_BUILD_ENCLAVE
+    time_t now = oe_time(NULL);
+    struct oe_tm tm;
+#else
+    time_t now = time(NULL);
+    struct tm tm;
+#endif
+
+    if (value == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (now == (time_t)-1)
+        OE_RAISE(OE_FAILURE);
+
+#if defined(OE_BUILD_ENCLAVE)
+    if (!oe_gmtime_r(&now, &tm))
+        OE_RAISE(OE_FAILURE);
+#elif defined(_MSC_VER)
+    if (gmtime_s(&tm, &now) != 0)
+        OE_RAISE(OE_FAILURE);
+#else
+    if (!gmtime_r(&now, &tm))
+        OE_RAISE(OE_FAILURE);
+#endif
+
+    value->year = (uint32_t)tm.tm_year + 1900;
+    value->month = (uint32_t)tm.tm_mon + 1;
+    value->day = (uint32_t)tm.tm_mday;
+    value->hours = (uint32_t)tm.tm_hour;
+    value->minutes = (uint32_t)tm.tm_min;
+    value->seconds = (uint32_t)tm.tm_sec;
+
+    result = OE_OK;
+done:
+    return result;
+}
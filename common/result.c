@@ -124,6 +124,8 @@ const char* oe_result_str(oe_result_t result)
             return "OE_THREAD_CREATE_ERROR";
         case OE_THREAD_JOIN_ERROR:
             return "OE_THREAD_JOIN_ERROR";
+        case OE_CONTEXT_SWITCHLESS_ECALL_MISSED:
+            return "OE_CONTEXT_SWITCHLESS_ECALL_MISSED";
         case __OE_RESULT_MAX:
             break;
     }
@@ -189,6 +191,7 @@ bool oe_is_valid_result(uint32_t result)
         case OE_CONTEXT_SWITCHLESS_OCALL_MISSED:
         case OE_THREAD_CREATE_ERROR:
         case OE_THREAD_JOIN_ERROR:
+        case OE_CONTEXT_SWITCHLESS_ECALL_MISSED:
         {
             return true;
         }
@@ -0,0 +1,544 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "collateralcache.h"
+#include <openenclave/bits/safecrt.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+#include "../common.h"
+
+#ifndef OE_BUILD_ENCLAVE
+#include "../../host/hostthread.h"
+#endif
+
+/*
+**==============================================================================
+**
+** Collateral cache:
+**
+**     Verifying the PCK certificate chain of a quote needs the CRLs of the
+**     chain and the TCB info of the platform, which the quote provider
+**     fetches, and which are then parsed and verified. The collateral only
+**     changes when Intel issues new CRLs or TCB info, so the cache keeps the
+**     parsed collateral of recently seen platforms until the earliest next
+**     update date of its CRLs and TCB info.
+**
+**     Collateral is keyed by the FMSPC of the platform and by the CRL
+**     distribution points of its PCK certificate chain. Only collateral that
+**     passed verification is cached. In an enclave, the current time comes
+**     from the host, which also supplies the collateral.
+**
+**     The cache also keeps the PCK certificate chains of recent quotes, keyed
+**     by the hash of their PEM, and the identity of the quoting enclave. A
+**     chain or collateral is only cached after a quote was verified with it,
+**     which also sets up any state that its keys compute on first use.
+**
+**==============================================================================
+*/
+
+#ifdef OE_BUILD_ENCLAVE
+static oe_mutex_t _lock = OE_MUTEX_INITIALIZER;
+#else
+static oe_mutex _lock = OE_H_MUTEX_INITIALIZER;
+#endif
+
+static oe_collateral_t* _head;
+static oe_pck_chain_t* _pck_chain_head;
+static oe_collateral_cache_statistics_t _statistics;
+
+static bool _have_qe_identity;
+static oe_parsed_qe_identity_info_t _qe_identity;
+
+static char* _copy_string(const char* str)
+{
+    size_t size = oe_strlen(str) + 1;
+    char* copy = (char*)oe_malloc(size);
+
+    if (copy && oe_memcpy_s(copy, size, str, size) != OE_OK)
+    {
+        oe_free(copy);
+        copy = NULL;
+    }
+
+    return copy;
+}
+
+static void _free_collateral(oe_collateral_t* collateral)
+{
+    for (size_t i = 0; i < OE_COLLATERAL_NUM_CRLS; i++)
+    {
+        oe_crl_free(&collateral->crls[i]);
+        oe_cert_chain_free(&collateral->crl_issuer_chains[i]);
+        oe_free(collateral->crl_urls[i]);
+    }
+
+    oe_cert_chain_free(&collateral->tcb_issuer_chain);
+    oe_free(collateral->tcb_info);
+    oe_free(collateral);
+}
+
+static bool _matches(
+    const oe_collateral_t* collateral,
+    const uint8_t fmspc[6],
+    const char* const crl_urls[OE_COLLATERAL_NUM_CRLS])
+{
+    if (memcmp(collateral->fmspc, fmspc, sizeof(collateral->fmspc)) != 0)
+        return false;
+
+    for (size_t i = 0; i < OE_COLLATERAL_NUM_CRLS; i++)
+    {
+        if (oe_strcmp(collateral->crl_urls[i], crl_urls[i]) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+/* Drop the reference of the cache to the collateral. The caller holds the
+ * lock and has unlinked the collateral. */
+static void _evict(oe_collateral_t* collateral)
+{
+    _statistics.entries--;
+
+    if (--collateral->refs == 0)
+        _free_collateral(collateral);
+}
+
+/* Compute the date at which the collateral expires. */
+static oe_result_t _get_expiry(
+    const oe_collateral_t* collateral,
+    oe_datetime_t* expiry)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_datetime_t next_update;
+
+    *expiry = collateral->tcb_info_next_update;
+
+    for (size_t i = 0; i < OE_COLLATERAL_NUM_CRLS; i++)
+    {
+        OE_CHECK(
+            oe_crl_get_update_dates(&collateral->crls[i], NULL, &next_update));
+
+        if (oe_datetime_compare(&next_update, expiry) < 0)
+            *expiry = next_update;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_create_collateral(
+    const uint8_t fmspc[6],
+    const char* const crl_urls[OE_COLLATERAL_NUM_CRLS],
+    oe_collateral_t** collateral_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_collateral_t* collateral = NULL;
+
+    if (collateral_out)
+        *collateral_out = NULL;
+
+    if (!fmspc || !crl_urls || !collateral_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    collateral = (oe_collateral_t*)oe_calloc(1, sizeof(oe_collateral_t));
+    if (collateral == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_memcpy_s(
+        collateral->fmspc, sizeof(collateral->fmspc), fmspc, 6));
+
+    for (size_t i = 0; i < OE_COLLATERAL_NUM_CRLS; i++)
+    {
+        if (!(collateral->crl_urls[i] = _copy_string(crl_urls[i])))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+    }
+
+    collateral->refs = 1;
+    *collateral_out = collateral;
+    collateral = NULL;
+    result = OE_OK;
+
+done:
+    if (collateral)
+        _free_collateral(collateral);
+
+    return result;
+}
+
+oe_result_t oe_get_cached_collateral(
+    const uint8_t fmspc[6],
+    const char* const crl_urls[OE_COLLATERAL_NUM_CRLS],
+    oe_collateral_t** collateral_out)
+{
+    oe_result_t result = OE_NOT_FOUND;
+    oe_collateral_t** link;
+    oe_datetime_t now;
+    bool have_time;
+
+    if (collateral_out)
+        *collateral_out = NULL;
+
+    if (!fmspc || !crl_urls || !collateral_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Without the current time, expired collateral cannot be told apart.
+    have_time = (oe_datetime_now(&now) == OE_OK);
+
+    oe_mutex_lock(&_lock);
+
+    for (link = &_head; *link; link = &(*link)->next)
+    {
+        oe_collateral_t* collateral = *link;
+
+        if (!_matches(collateral, fmspc, crl_urls))
+            continue;
+
+        *link = collateral->next;
+
+        if (!have_time || oe_datetime_compare(&now, &collateral->expiry) >= 0)
+        {
+            _statistics.expired++;
+            _evict(collateral);
+            break;
+        }
+
+        /* Move the collateral to the front */
+        collateral->next = _head;
+        _head = collateral;
+        collateral->refs++;
+
+        *collateral_out = collateral;
+        result = OE_OK;
+        break;
+    }
+
+    if (result == OE_OK)
+        _statistics.hits++;
+    else
+        _statistics.misses++;
+
+    oe_mutex_unlock(&_lock);
+
+done:
+    return result;
+}
+
+oe_result_t oe_cache_collateral(oe_collateral_t* collateral)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_collateral_t** link;
+    oe_datetime_t now;
+    size_t count = 0;
+
+    if (!collateral || collateral->next)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_get_expiry(collateral, &collateral->expiry));
+
+    // Collateral that has already expired is fetched again next time.
+    OE_CHECK(oe_datetime_now(&now));
+    if (oe_datetime_compare(&now, &collateral->expiry) >= 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    oe_mutex_lock(&_lock);
+
+    /* Replace the collateral of the same platform, cached by a concurrent
+     * verification, and evict the least recently used collateral */
+    for (link = &_head; *link;)
+    {
+        oe_collateral_t* p = *link;
+
+        if (_matches(
+                p,
+                collateral->fmspc,
+                (const char* const*)collateral->crl_urls))
+        {
+            *link = p->next;
+            _evict(p);
+            continue;
+        }
+
+        if (++count >= OE_COLLATERAL_CACHE_SIZE)
+        {
+            *link = p->next;
+            _statistics.evicted++;
+            _evict(p);
+            continue;
+        }
+
+        link = &p->next;
+    }
+
+    collateral->next = _head;
+    _head = collateral;
+    collateral->refs++;
+    _statistics.entries++;
+
+    oe_mutex_unlock(&_lock);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_put_collateral(oe_collateral_t* collateral)
+{
+    if (!collateral)
+        return;
+
+    oe_mutex_lock(&_lock);
+
+    if (--collateral->refs == 0)
+        _free_collateral(collateral);
+
+    oe_mutex_unlock(&_lock);
+}
+
+static void _free_pck_chain(oe_pck_chain_t* chain)
+{
+    oe_ec_public_key_free(&chain->leaf_public_key);
+    oe_cert_free(&chain->leaf_cert);
+    oe_cert_free(&chain->intermediate_cert);
+    oe_cert_chain_free(&chain->chain);
+    oe_free(chain);
+}
+
+/* Drop the reference of the cache to the chain. The caller holds the lock
+ * and has unlinked the chain. */
+static void _evict_pck_chain(oe_pck_chain_t* chain)
+{
+    _statistics.pck_chain_entries--;
+
+    if (--chain->refs == 0)
+        _free_pck_chain(chain);
+}
+
+oe_result_t oe_create_pck_chain(
+    const OE_SHA256* hash,
+    oe_pck_chain_t** chain_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_pck_chain_t* chain = NULL;
+
+    if (chain_out)
+        *chain_out = NULL;
+
+    if (!hash || !chain_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    chain = (oe_pck_chain_t*)oe_calloc(1, sizeof(oe_pck_chain_t));
+    if (chain == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    chain->hash = *hash;
+    chain->refs = 1;
+
+    *chain_out = chain;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_get_cached_pck_chain(
+    const OE_SHA256* hash,
+    oe_pck_chain_t** chain_out)
+{
+    oe_result_t result = OE_NOT_FOUND;
+    oe_pck_chain_t** link;
+
+    if (chain_out)
+        *chain_out = NULL;
+
+    if (!hash || !chain_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&_lock);
+
+    for (link = &_pck_chain_head; *link; link = &(*link)->next)
+    {
+        oe_pck_chain_t* chain = *link;
+
+        if (memcmp(&chain->hash, hash, sizeof(chain->hash)) != 0)
+            continue;
+
+        /* Move the chain to the front */
+        *link = chain->next;
+        chain->next = _pck_chain_head;
+        _pck_chain_head = chain;
+        chain->refs++;
+
+        *chain_out = chain;
+        result = OE_OK;
+        break;
+    }
+
+    if (result == OE_OK)
+        _statistics.pck_chain_hits++;
+    else
+        _statistics.pck_chain_misses++;
+
+    oe_mutex_unlock(&_lock);
+
+done:
+    return result;
+}
+
+oe_result_t oe_cache_pck_chain(oe_pck_chain_t* chain)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_pck_chain_t** link;
+    size_t count = 0;
+
+    if (!chain || chain->next)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&_lock);
+
+    /* Replace the same chain, cached by a concurrent verification, and evict
+     * the least recently used chains */
+    for (link = &_pck_chain_head; *link;)
+    {
+        oe_pck_chain_t* p = *link;
+
+        if (memcmp(&p->hash, &chain->hash, sizeof(p->hash)) == 0 ||
+            ++count >= OE_PCK_CHAIN_CACHE_SIZE)
+        {
+            *link = p->next;
+            _evict_pck_chain(p);
+            continue;
+        }
+
+        link = &p->next;
+    }
+
+    chain->next = _pck_chain_head;
+    _pck_chain_head = chain;
+    chain->refs++;
+    _statistics.pck_chain_entries++;
+
+    oe_mutex_unlock(&_lock);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_put_pck_chain(oe_pck_chain_t* chain)
+{
+    if (!chain)
+        return;
+
+    oe_mutex_lock(&_lock);
+
+    if (--chain->refs == 0)
+        _free_pck_chain(chain);
+
+    oe_mutex_unlock(&_lock);
+}
+
+oe_result_t oe_get_cached_qe_identity(oe_parsed_qe_identity_info_t* info)
+{
+    oe_result_t result = OE_NOT_FOUND;
+    oe_datetime_t now;
+    bool have_time;
+
+    if (!info)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    have_time = (oe_datetime_now(&now) == OE_OK);
+
+    oe_mutex_lock(&_lock);
+
+    if (_have_qe_identity && have_time &&
+        oe_datetime_compare(&now, &_qe_identity.next_update) < 0)
+    {
+        *info = _qe_identity;
+        result = OE_OK;
+    }
+
+    if (result == OE_OK)
+        _statistics.qe_identity_hits++;
+    else
+        _statistics.qe_identity_misses++;
+
+    oe_mutex_unlock(&_lock);
+
+done:
+    return result;
+}
+
+oe_result_t oe_cache_qe_identity(const oe_parsed_qe_identity_info_t* info)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!info)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&_lock);
+
+    _qe_identity = *info;
+    _qe_identity.info_start = NULL;
+    _qe_identity.info_size = 0;
+    _have_qe_identity = true;
+
+    oe_mutex_unlock(&_lock);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_get_collateral_cache_statistics(
+    oe_collateral_cache_statistics_t* statistics)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!statistics)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&_lock);
+    *statistics = _statistics;
+    oe_mutex_unlock(&_lock);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_flush_collateral_cache(void)
+{
+    oe_mutex_lock(&_lock);
+
+    while (_head)
+    {
+        oe_collateral_t* collateral = _head;
+
+        _head = collateral->next;
+        _evict(collateral);
+    }
+
+    while (_pck_chain_head)
+    {
+        oe_pck_chain_t* chain = _pck_chain_head;
+
+        _pck_chain_head = chain->next;
+        _evict_pck_chain(chain);
+    }
+
+    _have_qe_identity = false;
+
+    oe_mutex_unlock(&_lock);
+
+    return OE_OK;
+}
@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_COMMON_COLLATERALCACHE_H
+#define _OE_COMMON_COLLATERALCACHE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/crypto/cert.h>
+#include <openenclave/internal/crypto/crl.h>
+#include <openenclave/internal/crypto/ec.h>
+#include <openenclave/internal/crypto/sha.h>
+#include <openenclave/internal/datetime.h>
+#include "tcbinfo.h"
+
+OE_EXTERNC_BEGIN
+
+/* The number of platforms whose collateral the cache holds before it evicts
+ * the least recently used one */
+#define OE_COLLATERAL_CACHE_SIZE 512
+
+/* The number of PCK certificate chains that the cache holds before it evicts
+ * the least recently used one */
+#define OE_PCK_CHAIN_CACHE_SIZE 256
+
+/* The CRLs of the PCK certificate and of its intermediate CA */
+#define OE_COLLATERAL_NUM_CRLS 2
+
+typedef struct _oe_collateral oe_collateral_t;
+
+/* The revocation collateral of a platform, as fetched from the quote provider
+ * and parsed. Collateral is only shared through the cache once it has been
+ * verified, after which it must not be modified. */
+struct _oe_collateral
+{
+    /* Link in the cache, most recently used first */
+    oe_collateral_t* next;
+
+    /* The key: the FMSPC of the platform and the CRL distribution points of
+     * its PCK certificate chain */
+    uint8_t fmspc[6];
+    char* crl_urls[OE_COLLATERAL_NUM_CRLS];
+
+    oe_crl_t crls[OE_COLLATERAL_NUM_CRLS];
+    oe_cert_chain_t crl_issuer_chains[OE_COLLATERAL_NUM_CRLS];
+    oe_cert_chain_t tcb_issuer_chain;
+
+    /* The TCB info JSON, whose signature is verified, and which is parsed
+     * again for the TCB level of each platform */
+    uint8_t* tcb_info;
+    size_t tcb_info_size;
+    oe_datetime_t tcb_info_next_update;
+
+    /* The earliest next update date of the CRLs and of the TCB info */
+    oe_datetime_t expiry;
+
+    /* The number of verifications using the collateral, plus one while the
+     * collateral is in the cache */
+    uint64_t refs;
+};
+
+/* Allocate collateral for the given key, with one reference held by the
+ * caller, who fills it in. */
+oe_result_t oe_create_collateral(
+    const uint8_t fmspc[6],
+    const char* const crl_urls[OE_COLLATERAL_NUM_CRLS],
+    oe_collateral_t** collateral);
+
+/* Return the cached collateral for the given key, or OE_NOT_FOUND if the
+ * cache has none that is still current. */
+oe_result_t oe_get_cached_collateral(
+    const uint8_t fmspc[6],
+    const char* const crl_urls[OE_COLLATERAL_NUM_CRLS],
+    oe_collateral_t** collateral);
+
+/* Add verified collateral to the cache, replacing any collateral with the
+ * same key. The caller keeps its reference. */
+oe_result_t oe_cache_collateral(oe_collateral_t* collateral);
+
+/* Release a reference to the collateral. */
+void oe_put_collateral(oe_collateral_t* collateral);
+
+typedef struct _oe_pck_chain oe_pck_chain_t;
+
+/* A PCK certificate chain from a quote, parsed and checked to be rooted in
+ * the Intel root key. Whether the certificates are revoked is checked for
+ * every quote, against the current CRLs. */
+struct _oe_pck_chain
+{
+    /* Link in the cache, most recently used first */
+    oe_pck_chain_t* next;
+
+    /* The key: the SHA-256 of the PEM chain */
+    OE_SHA256 hash;
+
+    oe_cert_chain_t chain;
+    oe_cert_t leaf_cert;
+    oe_cert_t intermediate_cert;
+    oe_ec_public_key_t leaf_public_key;
+
+    /* The number of verifications using the chain, plus one while the chain
+     * is in the cache */
+    uint64_t refs;
+};
+
+/* Allocate a chain for the given hash, with one reference held by the caller,
+ * who fills it in. */
+oe_result_t oe_create_pck_chain(
+    const OE_SHA256* hash,
+    oe_pck_chain_t** chain);
+
+/* Return the cached chain with the given hash, or OE_NOT_FOUND. */
+oe_result_t oe_get_cached_pck_chain(
+    const OE_SHA256* hash,
+    oe_pck_chain_t** chain);
+
+/* Add a chain to the cache once a quote was verified with it. The caller
+ * keeps its reference. */
+oe_result_t oe_cache_pck_chain(oe_pck_chain_t* chain);
+
+/* Release a reference to the chain. */
+void oe_put_pck_chain(oe_pck_chain_t* chain);
+
+/* Return the cached QE identity, whose signature was verified, or
+ * OE_NOT_FOUND if there is none or if it has expired. The pointers into the
+ * identity JSON are not kept. */
+oe_result_t oe_get_cached_qe_identity(oe_parsed_qe_identity_info_t* info);
+
+/* Cache the verified QE identity until its next update date. */
+oe_result_t oe_cache_qe_identity(const oe_parsed_qe_identity_info_t* info);
+
+OE_EXTERNC_END
+
+#endif // _OE_COMMON_COLLATERALCACHE_H
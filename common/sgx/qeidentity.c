@@ -5,6 +5,7 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/utils.h>
 #include "../common.h"
+#include "collateralcache.h"
 #include "tcbinfo.h"
 
 // hardcoded property values used for validating quoting enclave when qe
@@ -40,9 +41,17 @@ oe_result_t oe_enforce_qe_identity(sgx_report_body_t* qe_report_body)
     size_t pem_pck_certificate_size = 0;
     oe_cert_chain_t pck_cert_chain = {0};
     oe_parsed_qe_identity_info_t parsed_info = {0};
+    bool cached = false;
 
     OE_TRACE_INFO("Calling %s\n", __FUNCTION__);
 
+    // Use the cached identity if its signature was verified already.
+    if (oe_get_cached_qe_identity(&parsed_info) == OE_OK)
+    {
+        cached = true;
+        goto check_identity;
+    }
+
     // fetch qe identity information
     result = oe_get_qe_identity_info(&qe_id_args);
     if (result == OE_QUOTE_PROVIDER_CALL_ERROR)
@@ -120,6 +129,8 @@ oe_result_t oe_enforce_qe_identity(sgx_report_body_t* qe_report_body)
         &pck_cert_chain));
     OE_TRACE_INFO("oe_verify_ecdsa256_signature succeeded\n");
 
+check_identity:
+
     // Check that issue_date and next_update are after the earliest date that
     // the enclave accepts.
     if (oe_datetime_compare(
@@ -195,10 +206,13 @@ oe_result_t oe_enforce_qe_identity(sgx_report_body_t* qe_report_body)
             parsed_info.attributes_xfrm_mask,
             parsed_info.attributes.xfrm);
 
-    oe_cleanup_qe_identity_info_args(&qe_id_args);
+    if (!cached)
+        oe_cache_qe_identity(&parsed_info);
+
     result = OE_OK;
 
 done:
+    oe_cleanup_qe_identity_info_args(&qe_id_args);
     if (pck_cert_chain.impl[0] != 0)
         oe_cert_chain_free(&pck_cert_chain);
     return result;
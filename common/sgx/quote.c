@@ -7,11 +7,17 @@
 #include <openenclave/internal/datetime.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
 #include "../common.h"
+#include "collateralcache.h"
 #include "qeidentity.h"
 #include "revocation.h"
 
+#ifndef OE_BUILD_ENCLAVE
+#include "../../host/hostthread.h"
+#endif
+
 // Public key of Intel's root certificate.
 static const char* g_expected_root_certificate_key =
     "-----BEGIN PUBLIC KEY-----\n"
@@ -19,6 +25,23 @@ static const char* g_expected_root_certificate_key =
     "SLRFhWGjbnBVJfVnkY4u3IjkDYYL0MxO4mqsyYjlBalTVYxFP2sJBK5zlA==\n"
     "-----END PUBLIC KEY-----\n";
 
+// The root key, parsed once.
+#ifdef OE_BUILD_ENCLAVE
+static oe_once_t _root_key_once = OE_ONCE_INITIALIZER;
+#else
+static oe_once_type _root_key_once = OE_H_ONCE_INITIALIZER;
+#endif
+static oe_ec_public_key_t _expected_root_public_key;
+static oe_result_t _expected_root_public_key_result = OE_UNEXPECTED;
+
+static void _read_expected_root_public_key(void)
+{
+    _expected_root_public_key_result = oe_ec_public_key_read_pem(
+        &_expected_root_public_key,
+        (const uint8_t*)g_expected_root_certificate_key,
+        oe_strlen(g_expected_root_certificate_key) + 1);
+}
+
 OE_INLINE uint16_t ReadUint16(const uint8_t* p)
 {
     return (uint16_t)(p[0] | (p[1] << 8));
@@ -134,6 +157,123 @@ done:
     return result;
 }
 
+/**
+ * Get the parsed PCK certificate chain of a quote, from the cache if a quote
+ * with the same chain was verified recently. A parsed chain is checked to be
+ * rooted in the Intel root key. **cached** may be NULL.
+ */
+static oe_result_t _get_pck_chain(
+    const uint8_t* pem_pck_certificate,
+    size_t pem_pck_certificate_size,
+    oe_pck_chain_t** pck_chain_out,
+    bool* cached)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t sha256_ctx = {0};
+    OE_SHA256 sha256 = {0};
+    oe_pck_chain_t* pck_chain = NULL;
+    oe_cert_t root_cert = {0};
+    oe_ec_public_key_t root_public_key = {0};
+    bool key_equal = false;
+
+    OE_CHECK(oe_sha256_init(&sha256_ctx));
+    OE_CHECK(oe_sha256_update(
+        &sha256_ctx, pem_pck_certificate, pem_pck_certificate_size));
+    OE_CHECK(oe_sha256_final(&sha256_ctx, &sha256));
+
+    if (oe_get_cached_pck_chain(&sha256, pck_chain_out) == OE_OK)
+    {
+        if (cached)
+            *cached = true;
+        result = OE_OK;
+        goto done;
+    }
+
+    if (cached)
+        *cached = false;
+    OE_CHECK(oe_create_pck_chain(&sha256, &pck_chain));
+
+    // Read and validate the chain.
+    OE_CHECK(oe_cert_chain_read_pem(
+        &pck_chain->chain, pem_pck_certificate, pem_pck_certificate_size));
+
+    // Fetch leaf and root certificates.
+    OE_CHECK(
+        oe_cert_chain_get_leaf_cert(&pck_chain->chain, &pck_chain->leaf_cert));
+    OE_CHECK(oe_cert_chain_get_root_cert(&pck_chain->chain, &root_cert));
+    OE_CHECK(oe_cert_chain_get_cert(
+        &pck_chain->chain, 1, &pck_chain->intermediate_cert));
+
+    OE_CHECK(oe_cert_get_ec_public_key(
+        &pck_chain->leaf_cert, &pck_chain->leaf_public_key));
+    OE_CHECK(oe_cert_get_ec_public_key(&root_cert, &root_public_key));
+
+    // Ensure that the root certificate matches root of trust.
+    oe_once(&_root_key_once, _read_expected_root_public_key);
+    OE_CHECK(_expected_root_public_key_result);
+
+    OE_CHECK(oe_ec_public_key_equal(
+        &root_public_key, &_expected_root_public_key, &key_equal));
+    if (!key_equal)
+        OE_RAISE(OE_QUOTE_VERIFICATION_ERROR);
+
+    *pck_chain_out = pck_chain;
+    pck_chain = NULL;
+    result = OE_OK;
+
+done:
+    oe_put_pck_chain(pck_chain);
+    oe_ec_public_key_free(&root_public_key);
+    oe_cert_free(&root_cert);
+    return result;
+}
+
+#ifndef OE_BUILD_ENCLAVE
+
+// Only the batch verification of the host groups quotes by FMSPC. The chain
+// is only parsed to read the FMSPC and is never cached here; the verification
+// of the quote caches it, see collateralcache.c.
+oe_result_t oe_get_quote_fmspc(
+    const uint8_t* quote,
+    size_t quote_size,
+    uint8_t fmspc[6])
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sgx_quote_t* sgx_quote = NULL;
+    sgx_quote_auth_data_t* quote_auth_data = NULL;
+    sgx_qe_auth_data_t qe_auth_data = {0};
+    sgx_qe_cert_data_t qe_cert_data = {0};
+    oe_pck_chain_t* pck_chain = NULL;
+
+    if (quote == NULL || fmspc == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_parse_quote(
+        quote,
+        quote_size,
+        &sgx_quote,
+        &quote_auth_data,
+        &qe_auth_data,
+        &qe_cert_data));
+
+    if (qe_cert_data.type != OE_SGX_PCK_ID_PCK_CERT_CHAIN ||
+        qe_cert_data.size == 0)
+        OE_RAISE(OE_MISSING_CERTIFICATE_CHAIN);
+
+    OE_CHECK(
+        _get_pck_chain(qe_cert_data.data, qe_cert_data.size, &pck_chain, NULL));
+
+    OE_CHECK(oe_get_fmspc(&pck_chain->leaf_cert, fmspc));
+
+    result = OE_OK;
+
+done:
+    oe_put_pck_chain(pck_chain);
+    return result;
+}
+
+#endif // !OE_BUILD_ENCLAVE
+
 oe_result_t oe_verify_quote_internal(
     const uint8_t* quote,
     size_t quote_size,
@@ -149,17 +289,11 @@ oe_result_t oe_verify_quote_internal(
     sgx_quote_auth_data_t* quote_auth_data = NULL;
     sgx_qe_auth_data_t qe_auth_data = {0};
     sgx_qe_cert_data_t qe_cert_data = {0};
-    oe_cert_chain_t pck_cert_chain = {0};
+    oe_pck_chain_t* pck_chain = NULL;
+    bool cached = false;
     oe_sha256_context_t sha256_ctx = {0};
     OE_SHA256 sha256 = {0};
     oe_ec_public_key_t attestation_key = {0};
-    oe_cert_t leaf_cert = {0};
-    oe_cert_t root_cert = {0};
-    oe_cert_t intermediate_cert = {0};
-    oe_ec_public_key_t leaf_public_key = {0};
-    oe_ec_public_key_t root_public_key = {0};
-    oe_ec_public_key_t expected_root_public_key = {0};
-    bool key_equal = false;
 
     OE_UNUSED(pck_crl);
     OE_UNUSED(pck_crl_size);
@@ -204,33 +338,19 @@ oe_result_t oe_verify_quote_internal(
 
     // PckCertificate Chain validations.
     {
-        // Read and validate the chain.
-        OE_CHECK(oe_cert_chain_read_pem(
-            &pck_cert_chain, pem_pck_certificate, pem_pck_certificate_size));
-
-        // Fetch leaf and root certificates.
-        OE_CHECK(oe_cert_chain_get_leaf_cert(&pck_cert_chain, &leaf_cert));
-        OE_CHECK(oe_cert_chain_get_root_cert(&pck_cert_chain, &root_cert));
-        OE_CHECK(
-            oe_cert_chain_get_cert(&pck_cert_chain, 1, &intermediate_cert));
-
-        OE_CHECK(oe_cert_get_ec_public_key(&leaf_cert, &leaf_public_key));
-        OE_CHECK(oe_cert_get_ec_public_key(&root_cert, &root_public_key));
-
-        // Ensure that the root certificate matches root of trust.
-        OE_CHECK(oe_ec_public_key_read_pem(
-            &expected_root_public_key,
-            (const uint8_t*)g_expected_root_certificate_key,
-            oe_strlen(g_expected_root_certificate_key) + 1));
-
-        OE_CHECK(oe_ec_public_key_equal(
-            &root_public_key, &expected_root_public_key, &key_equal));
-        if (!key_equal)
-            OE_RAISE(OE_QUOTE_VERIFICATION_ERROR);
-
+        // Read and validate the chain, unless it is cached.
+        OE_CHECK(_get_pck_chain(
+            pem_pck_certificate,
+            pem_pck_certificate_size,
+            &pck_chain,
+            &cached));
+
+        // Revocation is checked for every quote, as the CRLs may change.
         OE_CHECK_MSG(
             oe_enforce_revocation(
-                &leaf_cert, &intermediate_cert, &pck_cert_chain),
+                &pck_chain->leaf_cert,
+                &pck_chain->intermediate_cert,
+                &pck_chain->chain),
             "enforcing CRL",
             NULL);
     }
@@ -241,7 +361,7 @@ oe_result_t oe_verify_quote_internal(
         // PckCertificate.pub_key)
         OE_CHECK_MSG(
             _ecdsa_verify(
-                &leaf_public_key,
+                &pck_chain->leaf_public_key,
                 &quote_auth_data->qe_report_body,
                 sizeof(quote_auth_data->qe_report_body),
                 &quote_auth_data->qe_report_body_signature),
@@ -289,16 +409,14 @@ oe_result_t oe_verify_quote_internal(
         oe_enforce_qe_identity(&quote_auth_data->qe_report_body),
         "Quoting enclave identity checking",
         NULL);
+
+    if (!cached)
+        oe_cache_pck_chain(pck_chain);
+
     result = OE_OK;
 
 done:
-    oe_ec_public_key_free(&leaf_public_key);
-    oe_ec_public_key_free(&root_public_key);
-    oe_ec_public_key_free(&expected_root_public_key);
     oe_ec_public_key_free(&attestation_key);
-    oe_cert_free(&leaf_cert);
-    oe_cert_free(&root_cert);
-    oe_cert_free(&intermediate_cert);
-    oe_cert_chain_free(&pck_cert_chain);
+    oe_put_pck_chain(pck_chain);
     return result;
 }
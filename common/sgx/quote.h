@@ -20,6 +20,14 @@ oe_result_t oe_verify_quote_internal(
     const uint8_t* enc_tcb_info_json,
     size_t enc_tcb_info_json_size);
 
+// Get the FMSPC of the platform that generated the quote, from the PCK
+// certificate in the quote. This lets a batch of quotes be grouped by the
+// collateral that their verification needs.
+oe_result_t oe_get_quote_fmspc(
+    const uint8_t* quote,
+    size_t quote_size,
+    uint8_t fmspc[6]);
+
 OE_EXTERNC_END
 
 #endif // _OE_COMMON_QUOTE_H
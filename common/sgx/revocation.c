@@ -18,6 +18,7 @@
 #include <openenclave/internal/trace.h>
 #include <openenclave/internal/utils.h>
 #include "../common.h"
+#include "collateralcache.h"
 #include "tcbinfo.h"
 
 // Defaults to Intel SGX 1.8 Release Date.
@@ -79,6 +80,26 @@ done:
     return result;
 }
 
+oe_result_t oe_get_fmspc(oe_cert_t* leaf_cert, uint8_t fmspc[6])
+{
+    oe_result_t result = OE_FAILURE;
+    ParsedExtensionInfo parsed_extension_info = {{0}};
+
+    if (leaf_cert == NULL || fmspc == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_parse_sgx_extensions(leaf_cert, &parsed_extension_info));
+    OE_CHECK(oe_memcpy_s(
+        fmspc,
+        sizeof(parsed_extension_info.fmspc),
+        parsed_extension_info.fmspc,
+        sizeof(parsed_extension_info.fmspc)));
+
+    result = OE_OK;
+done:
+    return result;
+}
+
 typedef struct _url
 {
     char str[256];
@@ -152,56 +173,38 @@ static void _trace_datetime(const char* msg, const oe_datetime_t* date)
     }
 }
 
-oe_result_t oe_enforce_revocation(
-    oe_cert_t* leaf_cert,
-    oe_cert_t* intermediate_cert,
-    oe_cert_chain_t* pck_cert_chain)
+/**
+ * Fetch and parse the collateral of the platform. The collateral is verified
+ * by the caller before it is cached.
+ */
+static oe_result_t _fetch_collateral(
+    const uint8_t fmspc[6],
+    const char* const crl_urls[OE_COLLATERAL_NUM_CRLS],
+    oe_collateral_t** collateral_out)
 {
     oe_result_t result = OE_FAILURE;
-    ParsedExtensionInfo parsed_extension_info = {{0}};
     oe_get_revocation_info_args_t revocation_args = {0};
-    oe_cert_chain_t tcb_issuer_chain = {0};
-    oe_cert_chain_t crl_issuer_chain[3] = {{{0}}};
-    oe_parsed_tcb_info_t parsed_tcb_info = {0};
-    oe_tcb_level_t platform_tcb_level = {{0}};
-    char* intermediate_crl_url = NULL;
-    char* leaf_crl_url = NULL;
-    oe_crl_t crls[2] = {{{0}}};
-    const oe_crl_t* crl_ptrs[2] = {&crls[0], &crls[1]};
-    oe_datetime_t crl_this_update_date = {0};
-    oe_datetime_t crl_next_update_date = {0};
-
-    OE_UNUSED(pck_cert_chain);
-
-    if (intermediate_cert == NULL || leaf_cert == NULL)
-        OE_RAISE(OE_INVALID_PARAMETER);
+    oe_collateral_t* collateral = NULL;
 
     OE_STATIC_ASSERT(
-        OE_COUNTOF(crl_issuer_chain) ==
-        OE_COUNTOF(revocation_args.crl_issuer_chain));
+        OE_COLLATERAL_NUM_CRLS <= OE_COUNTOF(revocation_args.crl_urls));
+
+    OE_CHECK(oe_create_collateral(fmspc, crl_urls, &collateral));
 
-    // Gather fmspc.
-    OE_CHECK(_parse_sgx_extensions(leaf_cert, &parsed_extension_info));
     OE_CHECK(oe_memcpy_s(
         revocation_args.fmspc,
         sizeof(revocation_args.fmspc),
-        parsed_extension_info.fmspc,
-        sizeof(parsed_extension_info.fmspc)));
+        collateral->fmspc,
+        sizeof(collateral->fmspc)));
 
-    // Gather CRL distribution point URLs from certs.
-    OE_CHECK(
-        _get_crl_distribution_point(intermediate_cert, &intermediate_crl_url));
-    OE_CHECK(_get_crl_distribution_point(leaf_cert, &leaf_crl_url));
-
-    revocation_args.crl_urls[0] = leaf_crl_url;
-    revocation_args.crl_urls[1] = intermediate_crl_url;
-    revocation_args.num_crl_urls = 2;
+    for (uint32_t i = 0; i < OE_COLLATERAL_NUM_CRLS; ++i)
+        revocation_args.crl_urls[i] = collateral->crl_urls[i];
+    revocation_args.num_crl_urls = OE_COLLATERAL_NUM_CRLS;
 
     OE_CHECK(oe_get_revocation_info(&revocation_args));
 
-    // Apply revocation info.
     OE_CHECK(oe_cert_chain_read_pem(
-        &tcb_issuer_chain,
+        &collateral->tcb_issuer_chain,
         revocation_args.tcb_issuer_chain,
         revocation_args.tcb_issuer_chain_size));
 
@@ -210,9 +213,11 @@ oe_result_t oe_enforce_revocation(
     for (uint32_t i = 0; i < revocation_args.num_crl_urls; ++i)
     {
         OE_CHECK(oe_crl_read_der(
-            &crls[i], revocation_args.crl[i], revocation_args.crl_size[i]));
+            &collateral->crls[i],
+            revocation_args.crl[i],
+            revocation_args.crl_size[i]));
         OE_CHECK(oe_cert_chain_read_pem(
-            &crl_issuer_chain[i],
+            &collateral->crl_issuer_chains[i],
             revocation_args.crl_issuer_chain[i],
             revocation_args.crl_issuer_chain_size[i]));
         OE_TRACE_VERBOSE(
@@ -221,6 +226,82 @@ oe_result_t oe_enforce_revocation(
             revocation_args.crl_issuer_chain[i]);
     }
 
+    // Keep a copy of the TCB info, which is parsed for each platform.
+    if (revocation_args.tcb_info_size == 0)
+        OE_RAISE(OE_INVALID_REVOCATION_INFO);
+
+    collateral->tcb_info = (uint8_t*)oe_malloc(revocation_args.tcb_info_size);
+    if (collateral->tcb_info == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_memcpy_s(
+        collateral->tcb_info,
+        revocation_args.tcb_info_size,
+        revocation_args.tcb_info,
+        revocation_args.tcb_info_size));
+    collateral->tcb_info_size = revocation_args.tcb_info_size;
+
+    *collateral_out = collateral;
+    collateral = NULL;
+    result = OE_OK;
+
+done:
+    oe_put_collateral(collateral);
+    oe_cleanup_get_revocation_info_args(&revocation_args);
+
+    return result;
+}
+
+oe_result_t oe_enforce_revocation(
+    oe_cert_t* leaf_cert,
+    oe_cert_t* intermediate_cert,
+    oe_cert_chain_t* pck_cert_chain)
+{
+    oe_result_t result = OE_FAILURE;
+    ParsedExtensionInfo parsed_extension_info = {{0}};
+    oe_collateral_t* collateral = NULL;
+    bool cached = false;
+    oe_parsed_tcb_info_t parsed_tcb_info = {0};
+    oe_tcb_level_t platform_tcb_level = {{0}};
+    char* intermediate_crl_url = NULL;
+    char* leaf_crl_url = NULL;
+    const char* crl_urls[OE_COLLATERAL_NUM_CRLS];
+    const oe_crl_t* crl_ptrs[OE_COLLATERAL_NUM_CRLS];
+    oe_datetime_t crl_this_update_date = {0};
+    oe_datetime_t crl_next_update_date = {0};
+
+    OE_UNUSED(pck_cert_chain);
+
+    if (intermediate_cert == NULL || leaf_cert == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Gather fmspc.
+    OE_CHECK(_parse_sgx_extensions(leaf_cert, &parsed_extension_info));
+
+    // Gather CRL distribution point URLs from certs.
+    OE_CHECK(
+        _get_crl_distribution_point(intermediate_cert, &intermediate_crl_url));
+    OE_CHECK(_get_crl_distribution_point(leaf_cert, &leaf_crl_url));
+
+    crl_urls[0] = leaf_crl_url;
+    crl_urls[1] = intermediate_crl_url;
+
+    // Use the collateral of the platform if it is cached and current, or
+    // fetch it from the quote provider.
+    if (oe_get_cached_collateral(
+            parsed_extension_info.fmspc, crl_urls, &collateral) == OE_OK)
+    {
+        cached = true;
+    }
+    else
+    {
+        OE_CHECK(_fetch_collateral(
+            parsed_extension_info.fmspc, crl_urls, &collateral));
+    }
+
+    for (uint32_t i = 0; i < OE_COUNTOF(crl_ptrs); ++i)
+        crl_ptrs[i] = &collateral->crls[i];
+
     // Verify the leaf cert.
     // oe_cert_verify incorporates openssl -crl_check_all semantics.
     // For successful verification:
@@ -237,7 +318,10 @@ oe_result_t oe_enforce_revocation(
     // chain, then verification would fail because the CRLs will not be found
     // for certificates in the chain.
     OE_CHECK(oe_cert_verify(
-        leaf_cert, crl_issuer_chain, crl_ptrs, OE_COUNTOF(crl_ptrs)));
+        leaf_cert,
+        collateral->crl_issuer_chains,
+        crl_ptrs,
+        OE_COUNTOF(crl_ptrs)));
 
     for (uint32_t i = 0; i < OE_COUNTOF(platform_tcb_level.sgx_tcb_comp_svn);
          ++i)
@@ -249,16 +333,20 @@ oe_result_t oe_enforce_revocation(
     platform_tcb_level.status = OE_TCB_LEVEL_STATUS_UNKNOWN;
 
     OE_CHECK(oe_parse_tcb_info_json(
-        revocation_args.tcb_info,
-        revocation_args.tcb_info_size,
+        collateral->tcb_info,
+        collateral->tcb_info_size,
         &platform_tcb_level,
         &parsed_tcb_info));
 
-    OE_CHECK(oe_verify_ecdsa256_signature(
-        parsed_tcb_info.tcb_info_start,
-        parsed_tcb_info.tcb_info_size,
-        (sgx_ecdsa256_signature_t*)parsed_tcb_info.signature,
-        &tcb_issuer_chain));
+    // The signature of cached TCB info was verified when it was fetched.
+    if (!cached)
+    {
+        OE_CHECK(oe_verify_ecdsa256_signature(
+            parsed_tcb_info.tcb_info_start,
+            parsed_tcb_info.tcb_info_size,
+            (sgx_ecdsa256_signature_t*)parsed_tcb_info.signature,
+            &collateral->tcb_issuer_chain));
+    }
 
     // Check that the tcb has been issued after the earliest date that the
     // enclave accepts.
@@ -269,10 +357,12 @@ oe_result_t oe_enforce_revocation(
     // Check that the CRLs have not expired.
     // The next update of the CRL must be after the earliest date that
     // the enclave accepts.
-    for (uint32_t i = 0; i < OE_COUNTOF(crls); ++i)
+    for (uint32_t i = 0; i < OE_COUNTOF(collateral->crls); ++i)
     {
         OE_CHECK(oe_crl_get_update_dates(
-            &crls[i], &crl_this_update_date, &crl_next_update_date));
+            &collateral->crls[i],
+            &crl_this_update_date,
+            &crl_next_update_date));
 
         _trace_datetime("crl this update date ", &crl_this_update_date);
         _trace_datetime("crl next update date ", &crl_next_update_date);
@@ -288,22 +378,20 @@ oe_result_t oe_enforce_revocation(
             OE_RAISE(OE_INVALID_REVOCATION_INFO);
     }
 
-    result = OE_OK;
-
-done:
-    for (int32_t i = (int32_t)revocation_args.num_crl_urls - 1; i >= 0; --i)
+    // Cache the collateral now that it is verified. Failing to cache it does
+    // not fail the verification.
+    if (!cached)
     {
-        oe_crl_free(&crls[i]);
+        collateral->tcb_info_next_update = parsed_tcb_info.next_update;
+        oe_cache_collateral(collateral);
     }
-    for (uint32_t i = 0; i < revocation_args.num_crl_urls; ++i)
-    {
-        oe_cert_chain_free(&crl_issuer_chain[i]);
-    }
-    oe_cert_chain_free(&tcb_issuer_chain);
 
+    result = OE_OK;
+
+done:
+    oe_put_collateral(collateral);
     oe_free(leaf_crl_url);
     oe_free(intermediate_crl_url);
-    oe_cleanup_get_revocation_info_args(&revocation_args);
 
     return result;
 }
@@ -17,6 +17,9 @@ oe_result_t oe_enforce_revocation(
     oe_cert_t* intermediate_cert,
     oe_cert_chain_t* pck_cert_chain);
 
+// Get the FMSPC of the platform from its PCK certificate.
+oe_result_t oe_get_fmspc(oe_cert_t* leaf_cert, uint8_t fmspc[6]);
+
 // Fetch revocation info using the specified args structure.
 oe_result_t oe_get_revocation_info(oe_get_revocation_info_args_t* args);
 
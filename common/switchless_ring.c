@@ -0,0 +1,132 @@
+/* Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. */
+
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/switchless_ring.h>
+#include <openenclave/internal/utils.h>
+
+#define OE_SWITCHLESS_RING_MASK (OE_SWITCHLESS_RING_CAPACITY - 1)
+
+OE_STATIC_ASSERT(
+    (OE_SWITCHLESS_RING_CAPACITY & OE_SWITCHLESS_RING_MASK) == 0);
+OE_STATIC_ASSERT(
+    sizeof(oe_switchless_ring_slot) == OE_SWITCHLESS_RING_CACHE_LINE_SIZE);
+
+/* functions for oe_switchless_ring */
+/*---------------------------------------------------------------------------*/
+void oe_switchless_ring_init(oe_switchless_ring* p_ring)
+{
+    p_ring->enqueue_pos = 0;
+    p_ring->dequeue_pos = 0;
+
+    /* slot i is free for the producer that claims position i */
+    for (uint64_t i = 0; i < OE_SWITCHLESS_RING_CAPACITY; i++)
+    {
+        p_ring->slots[i].sequence = i;
+        p_ring->slots[i].item = NULL;
+    }
+
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+} /* oe_switchless_ring_init */
+
+bool oe_switchless_ring_push(oe_switchless_ring* p_ring, void* item)
+{
+    oe_switchless_ring_slot* p_slot = NULL;
+    uint64_t pos = p_ring->enqueue_pos;
+
+    for (;;)
+    {
+        p_slot = &p_ring->slots[pos & OE_SWITCHLESS_RING_MASK];
+        uint64_t sequence = p_slot->sequence;
+        OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+        int64_t diff = (int64_t)(sequence - pos);
+
+        if (diff == 0)
+        {
+            /* the slot is free for this lap, try to claim the position */
+            if (oe_atomic_compare_and_swap(
+                    (int64_t volatile*)&p_ring->enqueue_pos,
+                    (int64_t)pos,
+                    (int64_t)(pos + 1)))
+                break;
+        }
+        else if (diff < 0)
+        {
+            /* the slot still holds an item from the previous lap */
+            return false;
+        }
+
+        /* another producer claimed the position, reload it */
+        pos = p_ring->enqueue_pos;
+    }
+
+    /* publish the item to the consumers */
+    p_slot->item = item;
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    p_slot->sequence = pos + 1;
+
+    return true;
+} /* oe_switchless_ring_push */
+
+size_t oe_switchless_ring_pop(
+    oe_switchless_ring* p_ring,
+    void** items,
+    size_t count)
+{
+    uint64_t pos = 0;
+    size_t n = 0;
+
+    if (count == 0)
+        return 0;
+
+    if (count > OE_SWITCHLESS_RING_CAPACITY)
+        count = OE_SWITCHLESS_RING_CAPACITY;
+
+    for (;;)
+    {
+        pos = p_ring->dequeue_pos;
+
+        /* count the consecutive slots that are filled for this lap */
+        for (n = 0; n < count; n++)
+        {
+            const oe_switchless_ring_slot* p_slot =
+                &p_ring->slots[(pos + n) & OE_SWITCHLESS_RING_MASK];
+            uint64_t sequence = p_slot->sequence;
+            OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+
+            if (sequence != pos + n + 1)
+            {
+                /* the head slot is not filled yet, so the ring is empty */
+                if (n == 0 && (int64_t)(sequence - (pos + 1)) < 0)
+                    return 0;
+                break;
+            }
+        }
+
+        /* claim all of the filled slots at once */
+        if (n > 0 &&
+            oe_atomic_compare_and_swap(
+                (int64_t volatile*)&p_ring->dequeue_pos,
+                (int64_t)pos,
+                (int64_t)(pos + n)))
+            break;
+    }
+
+    /* take the items and free the slots for the next lap */
+    for (size_t i = 0; i < n; i++)
+    {
+        oe_switchless_ring_slot* p_slot =
+            &p_ring->slots[(pos + i) & OE_SWITCHLESS_RING_MASK];
+
+        items[i] = p_slot->item;
+        OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+        p_slot->sequence = pos + i + OE_SWITCHLESS_RING_CAPACITY;
+    }
+
+    return n;
+} /* oe_switchless_ring_pop */
+
+bool oe_switchless_ring_is_empty(const oe_switchless_ring* p_ring)
+{
+    return p_ring->dequeue_pos == p_ring->enqueue_pos;
+} /* oe_switchless_ring_is_empty */
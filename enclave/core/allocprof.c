@@ -0,0 +1,331 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#define USE_DL_PREFIX
+#include "allocprof.h"
+#include <openenclave/bits/safecrt.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/backtrace.h>
+#include <openenclave/internal/print.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/types.h>
+#include "../3rdparty/dlmalloc/dlmalloc/malloc.h"
+
+#if defined(OE_USE_ALLOCATION_PROFILER)
+
+/*
+**==============================================================================
+**
+** Sampling allocation profiler:
+**
+**     When the profiler runs, oe_malloc() and friends call
+**     oe_allocation_profiler_sample() after each successful allocation. Every
+**     interval-th call takes a backtrace and adds the allocation to the site
+**     with the same call stack in an open addressing hash table.
+**
+**     The table is allocated from dlmalloc directly, so that the profiler
+**     never samples its own allocations, and sampling itself never
+**     allocates. Samples whose site finds no free slot are counted as
+**     dropped.
+**
+**==============================================================================
+*/
+
+/* The capacity of the site table (a power of two) */
+#define MAX_SITES 512
+
+volatile uint32_t oe_allocation_profiler_interval;
+
+static oe_allocation_site_t* _sites;
+static size_t _num_sites;
+static uint64_t _dropped_samples;
+static volatile uint64_t _allocations;
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+
+static uint64_t _hash(void* const* frames, size_t num_frames)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+
+    for (size_t i = 0; i < num_frames; i++)
+    {
+        hash ^= (uint64_t)frames[i];
+        hash *= 0x100000001b3;
+    }
+
+    return hash;
+}
+
+/* Add a sample to the site of the call stack. Called with the lock held. */
+static void _record(void* const* frames, size_t num_frames, size_t size)
+{
+    const size_t start = (size_t)_hash(frames, num_frames);
+
+    for (size_t i = 0; i < MAX_SITES; i++)
+    {
+        oe_allocation_site_t* site = &_sites[(start + i) & (MAX_SITES - 1)];
+
+        if (site->samples == 0)
+        {
+            site->num_frames = num_frames;
+            oe_memcpy_s(
+                site->frames,
+                sizeof(site->frames),
+                frames,
+                num_frames * sizeof(void*));
+            _num_sites++;
+        }
+        else if (
+            site->num_frames != num_frames ||
+            memcmp(site->frames, frames, num_frames * sizeof(void*)) != 0)
+        {
+            continue;
+        }
+
+        site->samples++;
+        site->bytes += size;
+        return;
+    }
+
+    _dropped_samples++;
+}
+
+/* Use OE_NEVER_INLINE so that the frame to skip is always this one */
+OE_NEVER_INLINE void oe_allocation_profiler_sample(size_t size)
+{
+    void* frames[OE_ALLOCATION_PROFILE_MAX_FRAMES + 1];
+    const uint32_t interval = oe_allocation_profiler_interval;
+    int n;
+
+    if (!interval || oe_atomic_increment(&_allocations) % interval != 0)
+        return;
+
+    /* Take the backtrace outside of the lock, and drop this function */
+    if ((n = oe_backtrace(frames, (int)OE_COUNTOF(frames))) > 0)
+        n--;
+
+    oe_spin_lock(&_lock);
+    {
+        if (_sites)
+            _record(frames + 1, (size_t)(n > 0 ? n : 0), size);
+    }
+    oe_spin_unlock(&_lock);
+}
+
+oe_result_t oe_start_allocation_profiler(uint32_t sample_interval)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_allocation_site_t* sites = NULL;
+
+    if (!sample_interval)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(sites = dlcalloc(MAX_SITES, sizeof(oe_allocation_site_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    oe_spin_lock(&_lock);
+    {
+        oe_allocation_site_t* old_sites = _sites;
+
+        _sites = sites;
+        _num_sites = 0;
+        _dropped_samples = 0;
+        _allocations = 0;
+        oe_allocation_profiler_interval = sample_interval;
+
+        sites = old_sites;
+    }
+    oe_spin_unlock(&_lock);
+
+    result = OE_OK;
+
+done:
+    dlfree(sites);
+    return result;
+}
+
+oe_result_t oe_stop_allocation_profiler(void)
+{
+    oe_allocation_site_t* sites;
+
+    oe_spin_lock(&_lock);
+    {
+        oe_allocation_profiler_interval = 0;
+        sites = _sites;
+        _sites = NULL;
+        _num_sites = 0;
+    }
+    oe_spin_unlock(&_lock);
+
+    dlfree(sites);
+
+    return OE_OK;
+}
+
+/* Copy the sites out of the table, largest first, so that the caller can
+ * work on them without holding the lock. */
+static oe_result_t _get_sites(
+    oe_allocation_site_t** sites_out,
+    size_t* num_sites_out,
+    uint64_t* dropped_samples_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_allocation_site_t* sites;
+    size_t num_sites = 0;
+
+    if (!(sites = dlmalloc(MAX_SITES * sizeof(oe_allocation_site_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    oe_spin_lock(&_lock);
+    {
+        if (_sites)
+        {
+            for (size_t i = 0; i < MAX_SITES; i++)
+            {
+                if (_sites[i].samples)
+                    sites[num_sites++] = _sites[i];
+            }
+        }
+
+        *dropped_samples_out = _dropped_samples;
+        result = _sites ? OE_OK : OE_NOT_FOUND;
+    }
+    oe_spin_unlock(&_lock);
+
+    if (result != OE_OK)
+        OE_RAISE_NO_TRACE(result);
+
+    /* Insertion sort, as there are few sites */
+    for (size_t i = 1; i < num_sites; i++)
+    {
+        oe_allocation_site_t site = sites[i];
+        size_t j = i;
+
+        for (; j > 0 && sites[j - 1].bytes < site.bytes; j--)
+            sites[j] = sites[j - 1];
+
+        sites[j] = site;
+    }
+
+    *sites_out = sites;
+    *num_sites_out = num_sites;
+    sites = NULL;
+
+done:
+    dlfree(sites);
+    return result;
+}
+
+oe_result_t oe_get_allocation_profile(
+    oe_allocation_site_t* sites,
+    size_t* num_sites)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_allocation_site_t* copy = NULL;
+    size_t count;
+    uint64_t dropped_samples;
+
+    if (!num_sites)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK_NO_TRACE(_get_sites(&copy, &count, &dropped_samples));
+
+    if (!sites || *num_sites < count)
+    {
+        *num_sites = count;
+
+        if (count)
+            OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+    }
+    else
+    {
+        OE_CHECK(oe_memcpy_s(
+            sites,
+            *num_sites * sizeof(oe_allocation_site_t),
+            copy,
+            count * sizeof(oe_allocation_site_t)));
+        *num_sites = count;
+    }
+
+    result = OE_OK;
+
+done:
+    dlfree(copy);
+    return result;
+}
+
+oe_result_t oe_dump_allocation_profile(void)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_allocation_site_t* sites = NULL;
+    size_t num_sites;
+    uint64_t dropped_samples;
+
+    OE_CHECK_NO_TRACE(_get_sites(&sites, &num_sites, &dropped_samples));
+
+    oe_host_printf(
+        "=== allocation profile: %zu sites, 1 in %u allocations sampled, "
+        "%llu samples dropped\n",
+        num_sites,
+        oe_allocation_profiler_interval,
+        OE_LLU(dropped_samples));
+
+    for (size_t i = 0; i < num_sites; i++)
+    {
+        const oe_allocation_site_t* site = &sites[i];
+        char** syms = oe_backtrace_symbols(site->frames, (int)site->num_frames);
+
+        oe_host_printf(
+            "%llu bytes in %llu samples\n",
+            OE_LLU(site->bytes),
+            OE_LLU(site->samples));
+
+        for (size_t j = 0; j < site->num_frames; j++)
+        {
+            oe_host_printf(
+                "%s(): %p\n", syms ? syms[j] : "?", site->frames[j]);
+        }
+
+        oe_host_printf("\n");
+
+        if (syms)
+            oe_backtrace_symbols_free(syms);
+    }
+
+    result = OE_OK;
+
+done:
+    dlfree(sites);
+    return result;
+}
+
+#else /* !defined(OE_USE_ALLOCATION_PROFILER) */
+
+oe_result_t oe_start_allocation_profiler(uint32_t sample_interval)
+{
+    OE_UNUSED(sample_interval);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_stop_allocation_profiler(void)
+{
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_get_allocation_profile(
+    oe_allocation_site_t* sites,
+    size_t* num_sites)
+{
+    OE_UNUSED(sites);
+    OE_UNUSED(num_sites);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_dump_allocation_profile(void)
+{
+    return OE_UNSUPPORTED;
+}
+
+#endif /* defined(OE_USE_ALLOCATION_PROFILER) */
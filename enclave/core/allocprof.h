@@ -0,0 +1,14 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_ALLOCATION_PROFILER_H
+#define _OE_ALLOCATION_PROFILER_H
+
+#include <openenclave/bits/types.h>
+
+/* The number of allocations per sample, or zero if the profiler is stopped */
+extern volatile uint32_t oe_allocation_profiler_interval;
+
+void oe_allocation_profiler_sample(size_t size);
+
+#endif /* _OE_ALLOCATION_PROFILER_H */
@@ -14,9 +14,21 @@
 #include <openenclave/internal/types.h>
 #include <openenclave/internal/utils.h>
 #include "../3rdparty/dlmalloc/dlmalloc/malloc.h"
+#include "threadcache.h"
 
 #if defined(OE_USE_DEBUG_MALLOC)
 
+/* Allocate the blocks from the thread caches if they are enabled */
+#if defined(OE_USE_THREAD_CACHE_MALLOC)
+#define BLOCK_MALLOC oe_thread_cache_malloc
+#define BLOCK_MEMALIGN oe_thread_cache_memalign
+#define BLOCK_FREE oe_thread_cache_free
+#else
+#define BLOCK_MALLOC dlmalloc
+#define BLOCK_MEMALIGN dlmemalign
+#define BLOCK_FREE dlfree
+#endif
+
 /*
 **==============================================================================
 **
@@ -312,7 +324,7 @@ void* oe_debug_malloc(size_t size)
     void* block;
     const size_t block_size = _calculate_block_size(0, size);
 
-    if (!(block = dlmalloc(block_size)))
+    if (!(block = BLOCK_MALLOC(block_size)))
         return NULL;
 
     /* Fill block with 0xAA (Allocated) bytes */
@@ -339,7 +351,7 @@ void oe_debug_free(void* ptr)
         size_t block_size = _get_block_size(ptr);
         oe_memset_s(block, block_size, 0xDD, block_size);
 
-        dlfree(block);
+        BLOCK_FREE(block);
     }
 }
 
@@ -404,7 +416,7 @@ void* oe_debug_memalign(size_t alignment, size_t size)
     void* block;
     header_t* header;
 
-    if (!(block = dlmemalign(alignment, block_size)))
+    if (!(block = BLOCK_MEMALIGN(alignment, block_size)))
         return NULL;
 
     header = (header_t*)((uint8_t*)block + padding_size);
@@ -10,7 +10,9 @@
 #include <openenclave/internal/malloc.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/thread.h>
+#include "allocprof.h"
 #include "debugmalloc.h"
+#include "threadcache.h"
 
 /* The use of dlmalloc/malloc.c below requires stdc names from these headers */
 #define OE_NEED_STDC_NAMES
@@ -51,6 +53,13 @@ static int _dlmalloc_stats_fprintf(FILE* stream, const char* format, ...);
 #define MEMALIGN oe_debug_memalign
 #define POSIX_MEMALIGN oe_debug_posix_memalign
 #define FREE oe_debug_free
+#elif defined(OE_USE_THREAD_CACHE_MALLOC)
+#define MALLOC oe_thread_cache_malloc
+#define CALLOC oe_thread_cache_calloc
+#define REALLOC oe_thread_cache_realloc
+#define MEMALIGN oe_thread_cache_memalign
+#define POSIX_MEMALIGN oe_thread_cache_posix_memalign
+#define FREE oe_thread_cache_free
 #else
 #define MALLOC dlmalloc
 #define CALLOC dlcalloc
@@ -60,6 +69,18 @@ static int _dlmalloc_stats_fprintf(FILE* stream, const char* format, ...);
 #define FREE dlfree
 #endif
 
+/* Let the allocation profiler sample successful allocations */
+#if defined(OE_USE_ALLOCATION_PROFILER)
+#define PROFILE_ALLOCATION(PTR, SIZE)                 \
+    do                                                \
+    {                                                 \
+        if (oe_allocation_profiler_interval && (PTR)) \
+            oe_allocation_profiler_sample(SIZE);      \
+    } while (0)
+#else
+#define PROFILE_ALLOCATION(PTR, SIZE)
+#endif
+
 static oe_allocation_failure_callback_t _failure_callback;
 
 void oe_set_allocation_failure_callback(
@@ -80,6 +101,8 @@ void* oe_malloc(size_t size)
             _failure_callback(__FILE__, __LINE__, __FUNCTION__, size);
     }
 
+    PROFILE_ALLOCATION(p, size);
+
     return p;
 }
 
@@ -105,6 +128,8 @@ void* oe_calloc(size_t nmemb, size_t size)
             _failure_callback(__FILE__, __LINE__, __FUNCTION__, nmemb * size);
     }
 
+    PROFILE_ALLOCATION(p, nmemb * size);
+
     return p;
 }
 
@@ -120,6 +145,8 @@ void* oe_realloc(void* ptr, size_t size)
             _failure_callback(__FILE__, __LINE__, __FUNCTION__, size);
     }
 
+    PROFILE_ALLOCATION(p, size);
+
     return p;
 }
 
@@ -135,6 +162,8 @@ int oe_posix_memalign(void** memptr, size_t alignment, size_t size)
             _failure_callback(__FILE__, __LINE__, __FUNCTION__, size);
     }
 
+    PROFILE_ALLOCATION(rc == 0 ? *memptr : NULL, size);
+
     return rc;
 }
 
@@ -150,6 +179,8 @@ void* oe_memalign(size_t alignment, size_t size)
             _failure_callback(__FILE__, __LINE__, __FUNCTION__, size);
     }
 
+    PROFILE_ALLOCATION(p, size);
+
     return p;
 }
 
@@ -241,3 +272,83 @@ done:
     oe_mutex_unlock(&_mutex);
     return result;
 }
+
+/*
+**==============================================================================
+**
+** oe_get_heap_stats()
+**
+** dlmalloc has no function that reports the sizes of its free chunks. This
+** function walks the chunks of each segment the same way as the mallinfo()
+** implementation in the dlmalloc sources included above.
+**
+**==============================================================================
+*/
+
+static void _add_free_chunk(oe_heap_stats_t* stats, size_t size)
+{
+    size_t bucket = 0;
+
+    stats->free_bytes += size;
+    stats->free_chunks++;
+
+    if (size > stats->largest_free_chunk)
+        stats->largest_free_chunk = size;
+
+    while (bucket + 1 < OE_HEAP_STATS_HISTOGRAM_SIZE && (size >> (bucket + 5)))
+        bucket++;
+
+    stats->free_chunk_histogram[bucket]++;
+}
+
+oe_result_t oe_get_heap_stats(oe_heap_stats_t* stats)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    mstate m = gm;
+
+    if (!stats)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    memset(stats, 0, sizeof(oe_heap_stats_t));
+    stats->heap_size = __oe_get_heap_size();
+
+    ensure_initialization();
+
+    if (PREACTION(m))
+        OE_RAISE(OE_FAILURE);
+
+    if (is_initialized(m))
+    {
+        stats->system_bytes = m->footprint;
+        stats->peak_system_bytes = m->max_footprint;
+
+        if (m->topsize)
+            _add_free_chunk(stats, m->topsize);
+
+        for (msegmentptr s = &m->seg; s; s = s->next)
+        {
+            mchunkptr q = align_as_chunk(s->base);
+
+            while (segment_holds(s, q) && q != m->top &&
+                   q->head != FENCEPOST_HEAD)
+            {
+                if (!is_inuse(q))
+                    _add_free_chunk(stats, chunksize(q));
+
+                q = next_chunk(q);
+            }
+        }
+
+        stats->in_use_bytes =
+            m->footprint - TOP_FOOT_SIZE - stats->free_bytes;
+    }
+
+    POSTACTION(m);
+
+    stats->sbrk_extent = oe_get_sbrk_extent();
+
+    result = OE_OK;
+
+done:
+    return result;
+}
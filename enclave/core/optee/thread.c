@@ -9,6 +9,7 @@
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/thread.h>
+#include <openenclave/internal/threadpool.h>
 
 /*
 **==============================================================================
@@ -469,3 +470,10 @@ void oe_thread_destruct_specific(void)
         oe_spin_unlock(&_lock);
     }
 }
+
+/* There are no thread pool workers, so only the thread-specific data of the
+ * thread is released. */
+void oe_thread_pool_reset_thread(void)
+{
+    oe_thread_destruct_specific();
+}
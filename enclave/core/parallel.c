@@ -0,0 +1,301 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/threadpool.h>
+#include <openenclave/internal/utils.h>
+
+/*
+**==============================================================================
+**
+** Work-stealing parallel loops:
+**
+**     oe_parallel_for() recruits the idle workers of the thread pool as
+**     helpers of the calling thread. Each participant owns a deque of
+**     subranges. The owner pushes and pops subranges at the bottom of its
+**     deque, depth first, and the others steal from the top, where the
+**     largest subranges are. Every deque starts with an equal share of the
+**     range, so that the participants only steal once they run out of work.
+**
+**     The participants and their deques live in a single allocation made by
+**     the calling thread, which does not return before every helper has
+**     finished with it.
+**
+**==============================================================================
+*/
+
+/* Each split halves a subrange, so a deque never holds more subranges than
+ * the number of bits in size_t. */
+#define DEQUE_CAPACITY 64
+
+/* With the automatic grain, each participant gets this many subranges */
+#define SUBRANGES_PER_PARTICIPANT 8
+
+typedef struct _range
+{
+    size_t begin;
+    size_t end;
+} range_t;
+
+typedef struct _job job_t;
+
+typedef struct _participant
+{
+    /* The task that runs a helper on a worker of the pool */
+    oe_thread_pool_task_t task;
+    job_t* job;
+    uint64_t seed;
+
+    /* The deque, in which ranges[top] is the oldest subrange */
+    oe_spinlock_t lock;
+    volatile size_t top;
+    volatile size_t bottom;
+    range_t ranges[DEQUE_CAPACITY];
+} participant_t;
+
+struct _job
+{
+    oe_parallel_for_function_t function;
+    void* arg;
+    size_t grain;
+
+    /* The number of indices that no call has returned from yet */
+    size_t remaining;
+
+    /* The number of helpers that were submitted and have not finished */
+    size_t num_helpers;
+
+    size_t num_participants;
+    participant_t participants[];
+};
+
+static bool _push(participant_t* self, range_t range)
+{
+    bool pushed = false;
+
+    oe_spin_lock(&self->lock);
+
+    if (self->bottom < DEQUE_CAPACITY)
+    {
+        self->ranges[self->bottom++] = range;
+        pushed = true;
+    }
+
+    oe_spin_unlock(&self->lock);
+
+    return pushed;
+}
+
+/* Take the newest subrange of the deque of self. */
+static bool _pop(participant_t* self, range_t* range)
+{
+    bool popped = false;
+
+    oe_spin_lock(&self->lock);
+
+    if (self->top < self->bottom)
+    {
+        *range = self->ranges[--self->bottom];
+        popped = true;
+    }
+
+    if (self->top == self->bottom)
+        self->top = self->bottom = 0;
+
+    oe_spin_unlock(&self->lock);
+
+    return popped;
+}
+
+/* Take the oldest subrange of the deque of another participant, starting at
+ * a random one so that thieves spread across the victims. */
+static bool _steal(job_t* job, participant_t* self, range_t* range)
+{
+    const size_t n = job->num_participants;
+    size_t start;
+
+    /* xorshift64 */
+    self->seed ^= self->seed << 13;
+    self->seed ^= self->seed >> 7;
+    self->seed ^= self->seed << 17;
+    start = (size_t)(self->seed % n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        participant_t* victim = &job->participants[(start + i) % n];
+        bool stolen = false;
+
+        /* Do not contend for the lock of an empty deque */
+        if (victim == self || victim->top == victim->bottom)
+            continue;
+
+        oe_spin_lock(&victim->lock);
+
+        if (victim->top < victim->bottom)
+        {
+            *range = victim->ranges[victim->top++];
+            stolen = true;
+        }
+
+        if (victim->top == victim->bottom)
+            victim->top = victim->bottom = 0;
+
+        oe_spin_unlock(&victim->lock);
+
+        if (stolen)
+            return true;
+    }
+
+    return false;
+}
+
+static void _participate(job_t* job, participant_t* self)
+{
+    for (;;)
+    {
+        range_t range;
+
+        if (!_pop(self, &range) && !_steal(job, self, &range))
+        {
+            if (__atomic_load_n(&job->remaining, __ATOMIC_ACQUIRE) == 0)
+                break;
+
+            OE_CPU_RELAX();
+            continue;
+        }
+
+        /* Leave the upper halves for the thieves, down to a single grain. If
+         * the deque is full, run the rest of the subrange in one call. */
+        while (range.end - range.begin > job->grain)
+        {
+            size_t middle = range.begin + (range.end - range.begin) / 2;
+            range_t upper = {middle, range.end};
+
+            if (!_push(self, upper))
+                break;
+
+            range.end = middle;
+        }
+
+        job->function(range.begin, range.end, job->arg);
+
+        __atomic_sub_fetch(
+            &job->remaining, range.end - range.begin, __ATOMIC_RELEASE);
+    }
+}
+
+static void _run_helper(oe_thread_pool_task_t* task)
+{
+    participant_t* self = (participant_t*)task;
+
+    _participate(self->job, self);
+}
+
+static void _finish_helper(oe_thread_pool_task_t* task)
+{
+    participant_t* self = (participant_t*)task;
+
+    /* The calling thread may free the job as soon as this reaches 0 */
+    __atomic_sub_fetch(&self->job->num_helpers, 1, __ATOMIC_RELEASE);
+}
+
+oe_result_t oe_parallel_for(
+    size_t begin,
+    size_t end,
+    size_t grain,
+    oe_parallel_for_function_t function,
+    void* arg)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const size_t num_workers = oe_thread_pool_get_num_workers();
+    size_t count;
+    size_t num_participants;
+    size_t share;
+    job_t* job = NULL;
+
+    if (!function || end < begin)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    count = end - begin;
+
+    if (grain == 0)
+    {
+        grain = count / ((num_workers + 1) * SUBRANGES_PER_PARTICIPANT);
+
+        if (grain == 0)
+            grain = 1;
+    }
+
+    /* Recruit no more helpers than there are grains to share */
+    num_participants = (count + grain - 1) / grain;
+
+    if (num_participants > num_workers + 1)
+        num_participants = num_workers + 1;
+
+    if (num_participants <= 1)
+    {
+        if (count)
+            function(begin, end, arg);
+
+        result = OE_OK;
+        goto done;
+    }
+
+    if (!(job = oe_calloc(
+              1, sizeof(job_t) + num_participants * sizeof(participant_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    job->function = function;
+    job->arg = arg;
+    job->grain = grain;
+    job->remaining = count;
+    job->num_participants = num_participants;
+
+    /* Give every participant an equal share before any of them starts */
+    share = count / num_participants;
+
+    for (size_t i = 0; i < num_participants; i++)
+    {
+        participant_t* p = &job->participants[i];
+
+        p->job = job;
+        p->seed = 0x9e3779b97f4a7c15 * (i + 1);
+        p->lock = OE_SPINLOCK_INITIALIZER;
+        p->ranges[0].begin = begin + i * share;
+        p->ranges[0].end = begin + (i + 1) * share;
+        p->bottom = 1;
+    }
+
+    job->participants[num_participants - 1].ranges[0].end = end;
+
+    /* Helpers that cannot be submitted leave their share to be stolen */
+    for (size_t i = 1; i < num_participants; i++)
+    {
+        participant_t* p = &job->participants[i];
+
+        p->task.run = _run_helper;
+        p->task.finish = _finish_helper;
+
+        __atomic_add_fetch(&job->num_helpers, 1, __ATOMIC_RELAXED);
+
+        if (oe_thread_pool_submit(&p->task) != OE_OK)
+        {
+            __atomic_sub_fetch(&job->num_helpers, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+
+    _participate(job, &job->participants[0]);
+
+    while (__atomic_load_n(&job->num_helpers, __ATOMIC_ACQUIRE) != 0)
+        OE_CPU_RELAX();
+
+    result = OE_OK;
+
+done:
+    oe_free(job);
+    return result;
+}
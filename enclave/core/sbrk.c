@@ -3,12 +3,14 @@
 
 #include <openenclave/enclave.h>
 #include <openenclave/internal/globals.h>
+#include <openenclave/internal/malloc.h>
 #include <openenclave/internal/thread.h>
 
+static unsigned char* _heap_next;
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+
 void* oe_sbrk(ptrdiff_t increment)
 {
-    static unsigned char* _heap_next;
-    static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
     void* ptr = (void*)-1;
 
     oe_spin_lock(&_lock);
@@ -30,3 +32,20 @@ void* oe_sbrk(ptrdiff_t increment)
 
     return ptr;
 }
+
+size_t oe_get_sbrk_extent(void)
+{
+    size_t extent = 0;
+
+    oe_spin_lock(&_lock);
+    {
+        if (_heap_next)
+        {
+            extent = (size_t)(
+                _heap_next - (const unsigned char*)__oe_get_heap_base());
+        }
+    }
+    oe_spin_unlock(&_lock);
+
+    return extent;
+}
@@ -0,0 +1,466 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/safemath.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/edger8r/enclave.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+#include "../switchlesscalls.h"
+
+// The maximum number of asynchronous OCALLs that can be in flight at once.
+#define OE_MAX_ASYNC_OCALLS 256
+
+// The size of the call arguments that precede the marshalling buffer in the
+// host block of an asynchronous OCALL.
+#define OE_ASYNC_OCALL_ARGS_SIZE                                      \
+    ((sizeof(oe_call_host_function_args_t) +                          \
+      OE_EDGER8R_BUFFER_ALIGNMENT - 1) /                              \
+     OE_EDGER8R_BUFFER_ALIGNMENT * OE_EDGER8R_BUFFER_ALIGNMENT)
+
+typedef enum _async_ocall_state
+{
+    // The slot is unused, but may still cache a host block.
+    ASYNC_OCALL_FREE,
+    // The marshalling buffer was handed out, but the call was not made.
+    ASYNC_OCALL_ALLOCATED,
+    // The call was made, and the caller holds a handle to it.
+    ASYNC_OCALL_PENDING,
+    // A thread is waiting for the call, and releases the slot when it is done.
+    ASYNC_OCALL_WAITING,
+    // The call was made without a handle, and is released on completion.
+    ASYNC_OCALL_DETACHED,
+} async_ocall_state_t;
+
+typedef struct _async_ocall
+{
+    // Host memory laid out as [oe_call_host_function_args_t][buffer].
+    uint8_t* block;
+    size_t capacity;
+    uint8_t* output_buffer;
+    size_t output_buffer_size;
+    uint32_t generation;
+    async_ocall_state_t state;
+} async_ocall_t;
+
+// The slots live in enclave memory, so the host cannot tamper with the
+// bookkeeping. Only the call arguments and the buffers are shared.
+static async_ocall_t _async_ocalls[OE_MAX_ASYNC_OCALLS];
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+
+// The indices of the freed slots, and the index of the first slot that was
+// never used. Both are protected by the lock.
+static uint32_t _free_slots[OE_MAX_ASYNC_OCALLS];
+static size_t _num_free_slots;
+static size_t _num_unused_slots_start;
+
+// The number of DETACHED slots, which are protected by the lock.
+static size_t _num_detached;
+
+// The slot whose marshalling buffer was last handed out to this thread. The
+// oeedger8r wrappers make or abandon the call before allocating again.
+static __thread async_ocall_t* _allocated;
+
+static oe_call_host_function_args_t* _get_args(const async_ocall_t* ocall)
+{
+    return (oe_call_host_function_args_t*)ocall->block;
+}
+
+static uint8_t* _get_buffer(const async_ocall_t* ocall)
+{
+    return ocall->block + OE_ASYNC_OCALL_ARGS_SIZE;
+}
+
+static bool _is_completed(const async_ocall_t* ocall)
+{
+    oe_call_host_function_args_t* args = _get_args(ocall);
+    bool completed =
+        __atomic_load_n(&args->result, __ATOMIC_SEQ_CST) != __OE_RESULT_MAX;
+
+    OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+    return completed;
+}
+
+/*
+**==============================================================================
+**
+** _release()
+**
+**     Return a slot to the free list, which invalidates its handle. Must be
+**     called with the lock held.
+**
+**==============================================================================
+*/
+
+static void _release(async_ocall_t* ocall)
+{
+    ocall->generation++;
+    ocall->state = ASYNC_OCALL_FREE;
+    _free_slots[_num_free_slots++] = (uint32_t)(ocall - _async_ocalls);
+}
+
+/*
+**==============================================================================
+**
+** _reclaim_detached()
+**
+**     Release the DETACHED slots that the host has completed. Must be called
+**     with the lock held.
+**
+**==============================================================================
+*/
+
+static void _reclaim_detached(void)
+{
+    for (size_t i = 0; i < _num_unused_slots_start && _num_detached; i++)
+    {
+        async_ocall_t* ocall = &_async_ocalls[i];
+
+        if (ocall->state == ASYNC_OCALL_DETACHED && _is_completed(ocall))
+        {
+            _num_detached--;
+            _release(ocall);
+        }
+    }
+}
+
+/*
+**==============================================================================
+**
+** _find_allocated()
+**
+**     Find the slot that handed out the given marshalling buffer to this
+**     thread. The slot is owned by the thread, so no lock is needed.
+**
+**==============================================================================
+*/
+
+static async_ocall_t* _find_allocated(const void* buffer)
+{
+    async_ocall_t* ocall = _allocated;
+
+    if (!ocall || ocall->state != ASYNC_OCALL_ALLOCATED ||
+        _get_buffer(ocall) != (const uint8_t*)buffer)
+        return NULL;
+
+    _allocated = NULL;
+    return ocall;
+}
+
+/*
+**==============================================================================
+**
+** _find_pending()
+**
+**     Find the slot that a handle refers to, unless a thread is already
+**     waiting for it. Must be called with the lock held.
+**
+**==============================================================================
+*/
+
+static async_ocall_t* _find_pending(oe_async_ocall_t handle)
+{
+    uint64_t index = (handle & OE_UINT32_MAX);
+    uint32_t generation = (uint32_t)(handle >> 32);
+    async_ocall_t* ocall = NULL;
+
+    if (index == 0 || index > OE_MAX_ASYNC_OCALLS)
+        return NULL;
+
+    ocall = &_async_ocalls[index - 1];
+
+    if (ocall->state != ASYNC_OCALL_PENDING ||
+        ocall->generation != generation)
+        return NULL;
+
+    return ocall;
+}
+
+// Function used by oeedger8r for allocating asynchronous ocall buffers.
+// A slot is taken from the free list, and its host block is reused if it is
+// large enough, which saves the OCALLs to oe_host_malloc and oe_host_free in
+// the steady state. Slots of detached calls are reclaimed once the host has
+// completed them. If every slot is held by a handle, NULL is returned.
+void* oe_allocate_async_ocall_buffer(size_t size)
+{
+    async_ocall_t* ocall = NULL;
+    size_t block_size = 0;
+
+    if (oe_safe_add_sizet(OE_ASYNC_OCALL_ARGS_SIZE, size, &block_size) !=
+        OE_OK)
+        return NULL;
+
+    for (;;)
+    {
+        bool has_detached = false;
+
+        oe_spin_lock(&_lock);
+
+        if (_num_free_slots == 0 &&
+            _num_unused_slots_start == OE_MAX_ASYNC_OCALLS)
+            _reclaim_detached();
+
+        if (_num_free_slots > 0)
+            ocall = &_async_ocalls[_free_slots[--_num_free_slots]];
+        else if (_num_unused_slots_start < OE_MAX_ASYNC_OCALLS)
+            ocall = &_async_ocalls[_num_unused_slots_start++];
+
+        if (ocall)
+            ocall->state = ASYNC_OCALL_ALLOCATED;
+
+        has_detached = _num_detached > 0;
+
+        oe_spin_unlock(&_lock);
+
+        if (ocall || !has_detached)
+            break;
+
+        // Wait for the host to complete one of the detached calls.
+        asm volatile("pause");
+    }
+
+    if (!ocall)
+        return NULL;
+
+    // Only this thread looks at the slot while it is ALLOCATED.
+    if (ocall->capacity < size)
+    {
+        uint8_t* block = oe_host_malloc(block_size);
+
+        oe_host_free(ocall->block);
+        ocall->block = block;
+        ocall->capacity = block ? size : 0;
+
+        if (!block)
+        {
+            oe_spin_lock(&_lock);
+            _release(ocall);
+            oe_spin_unlock(&_lock);
+            return NULL;
+        }
+    }
+
+    _allocated = ocall;
+    return _get_buffer(ocall);
+}
+
+// Function used by oeedger8r for freeing the buffer of an asynchronous ocall
+// that was not made.
+void oe_free_async_ocall_buffer(void* buffer)
+{
+    async_ocall_t* ocall = _find_allocated(buffer);
+
+    if (ocall)
+    {
+        oe_spin_lock(&_lock);
+        _release(ocall);
+        oe_spin_unlock(&_lock);
+    }
+}
+
+/*
+**==============================================================================
+**
+** oe_async_call_host_function()
+**
+**     Post the call to the switchless host workers, and fall back to a
+**     regular OCALL if none of them can take it. Either way, the host reports
+**     the completion through args->result.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_async_call_host_function(
+    size_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    oe_async_ocall_t* handle)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    async_ocall_t* ocall = NULL;
+    oe_call_host_function_args_t* args = NULL;
+    size_t buffer_size = 0;
+    uint32_t generation = 0;
+    oe_result_t post_result = OE_UNEXPECTED;
+
+    if (handle)
+        *handle = 0;
+
+    if (!(ocall = _find_allocated(input_buffer)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // The buffers must lie within the marshalling buffer of the slot.
+    if (oe_safe_add_sizet(
+            input_buffer_size, output_buffer_size, &buffer_size) != OE_OK ||
+        buffer_size > ocall->capacity ||
+        (uint8_t*)output_buffer != _get_buffer(ocall) + input_buffer_size)
+    {
+        oe_spin_lock(&_lock);
+        _release(ocall);
+        oe_spin_unlock(&_lock);
+        OE_RAISE(OE_INVALID_PARAMETER);
+    }
+
+    ocall->output_buffer = (uint8_t*)output_buffer;
+    ocall->output_buffer_size = output_buffer_size;
+
+    args = _get_args(ocall);
+    memset(args, 0, sizeof(*args));
+    args->table_id = OE_UINT64_MAX;
+    args->function_id = function_id;
+    args->input_buffer = input_buffer;
+    args->input_buffer_size = input_buffer_size;
+    args->output_buffer = output_buffer;
+    args->output_buffer_size = output_buffer_size;
+    args->result = __OE_RESULT_MAX;
+
+    // Hand the slot over before posting, as the host may complete the call
+    // right away.
+    oe_spin_lock(&_lock);
+    generation = ocall->generation;
+    if (handle)
+        ocall->state = ASYNC_OCALL_PENDING;
+    else
+    {
+        ocall->state = ASYNC_OCALL_DETACHED;
+        _num_detached++;
+    }
+    oe_spin_unlock(&_lock);
+
+    post_result = oe_is_switchless_initialized()
+                      ? oe_post_switchless_ocall(args)
+                      : OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
+
+    if (post_result == OE_CONTEXT_SWITCHLESS_OCALL_MISSED)
+    {
+        // Make a regular OCALL, which completes the call before returning.
+        if ((post_result = oe_ocall(
+                 OE_OCALL_CALL_HOST_FUNCTION, (uint64_t)args, NULL)) != OE_OK)
+        {
+            OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+            args->result = post_result;
+        }
+        post_result = OE_OK;
+
+        // The call is complete, so a detached slot can be released right
+        // away, unless another thread has reclaimed it in the meantime.
+        if (!handle)
+        {
+            oe_spin_lock(&_lock);
+            if (ocall->state == ASYNC_OCALL_DETACHED &&
+                ocall->generation == generation)
+            {
+                _num_detached--;
+                _release(ocall);
+            }
+            oe_spin_unlock(&_lock);
+        }
+    }
+
+    // The call may have been posted before the failure, so leave the slot to
+    // be reclaimed when the host completes it.
+    if (post_result != OE_OK)
+    {
+        if (handle)
+        {
+            oe_spin_lock(&_lock);
+            ocall->state = ASYNC_OCALL_DETACHED;
+            _num_detached++;
+            oe_spin_unlock(&_lock);
+        }
+        OE_RAISE(post_result);
+    }
+
+    if (handle)
+    {
+        *handle = ((uint64_t)generation << 32) |
+                  (uint64_t)(ocall - _async_ocalls + 1);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_poll_async_ocall()
+**
+**==============================================================================
+*/
+
+oe_result_t oe_poll_async_ocall(oe_async_ocall_t handle, bool* completed)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    async_ocall_t* ocall = NULL;
+
+    if (!completed)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_spin_lock(&_lock);
+    ocall = _find_pending(handle);
+    oe_spin_unlock(&_lock);
+
+    if (!ocall)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    *completed = _is_completed(ocall);
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_wait_async_ocall()
+**
+**     Claim the slot, so that no other thread waits for it or releases it,
+**     then spin until the host completes the call and release the slot. The
+**     result of the host function wrapper is the first member of the
+**     marshalling struct that it writes to the output buffer.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_wait_async_ocall(oe_async_ocall_t handle)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    async_ocall_t* ocall = NULL;
+
+    oe_spin_lock(&_lock);
+    ocall = _find_pending(handle);
+    if (ocall)
+        ocall->state = ASYNC_OCALL_WAITING;
+    oe_spin_unlock(&_lock);
+
+    if (!ocall)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    while (!_is_completed(ocall))
+    {
+        /* Yield to CPU */
+        asm volatile("pause");
+    }
+
+    result = _get_args(ocall)->result;
+
+    if (result == OE_OK && ocall->output_buffer_size >= sizeof(oe_result_t))
+        result = *(volatile oe_result_t*)ocall->output_buffer;
+
+    oe_spin_lock(&_lock);
+    _release(ocall);
+    oe_spin_unlock(&_lock);
+
+done:
+    return result;
+}
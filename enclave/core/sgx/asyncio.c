@@ -0,0 +1,411 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/safecrt.h>
+#include <openenclave/bits/safemath.h>
+#include <openenclave/corelibc/errno.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/asyncio.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+
+typedef enum _slot_state
+{
+    SLOT_FREE,
+    // The slot was submitted and the host has not completed it yet.
+    SLOT_PENDING,
+    // The outcome was copied into the slot and is waiting to be reaped.
+    SLOT_COMPLETED,
+} slot_state_t;
+
+// The enclave side of a request slot. The slots live in enclave memory, so
+// the host cannot tamper with the bookkeeping.
+typedef struct _slot
+{
+    slot_state_t state;
+    // Whether a thread waits for the slot in oe_async_io_call_host(), in
+    // which case oe_async_io_reap() leaves it alone.
+    bool is_waited;
+    oe_async_io_opcode_t opcode;
+    void* buf;
+    size_t count;
+    uint64_t user_data;
+    ssize_t result;
+    int error;
+} slot_t;
+
+// The rings and the layout of the host memory, copied once at initialization
+// so that the host cannot change them afterwards.
+static oe_async_io_rings_t* _rings;
+static oe_async_io_request_t* _requests;
+static uint8_t* _buffers;
+static size_t _num_requests;
+static size_t _buffer_size;
+static size_t _num_workers;
+
+static slot_t _slots[OE_ASYNC_IO_MAX_REQUESTS];
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+
+// The number of PENDING slots, each of which may keep a host worker busy.
+static size_t _num_pending;
+
+oe_result_t oe_handle_init_async_io(uint64_t arg_in)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_async_io_rings_t* rings = (oe_async_io_rings_t*)arg_in;
+    oe_async_io_request_t* requests = NULL;
+    uint8_t* buffers = NULL;
+    uint64_t num_requests = 0;
+    uint64_t buffer_size = 0;
+    uint64_t num_workers = 0;
+    size_t size = 0;
+
+    if (!rings || !oe_is_outside_enclave(rings, sizeof(*rings)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* The rings are set up once, when the enclave is created. */
+    if (_rings)
+        OE_RAISE(OE_UNEXPECTED);
+
+    requests = rings->requests;
+    buffers = rings->buffers;
+    num_requests = rings->num_requests;
+    buffer_size = rings->buffer_size;
+    num_workers = rings->num_workers;
+
+    if (num_requests == 0 || num_requests > OE_ASYNC_IO_MAX_REQUESTS ||
+        buffer_size == 0 || buffer_size > OE_ASYNC_IO_MAX_BUFFER_SIZE ||
+        num_workers == 0)
+    {
+        OE_RAISE(OE_INVALID_PARAMETER);
+    }
+
+    OE_CHECK(oe_safe_mul_sizet(num_requests, sizeof(*requests), &size));
+    if (!requests || !oe_is_outside_enclave(requests, size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_safe_mul_sizet(num_requests, buffer_size, &size));
+    if (!buffers || !oe_is_outside_enclave(buffers, size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    _requests = requests;
+    _buffers = buffers;
+    _num_requests = num_requests;
+    _buffer_size = buffer_size;
+    _num_workers = num_workers;
+
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    _rings = rings;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+bool oe_async_io_is_available(void)
+{
+    return _rings != NULL;
+}
+
+size_t oe_async_io_get_buffer_size(void)
+{
+    return _buffer_size;
+}
+
+static uint8_t* _get_buffer(size_t index)
+{
+    return _buffers + index * _buffer_size;
+}
+
+static bool _is_input(oe_async_io_opcode_t opcode)
+{
+    return opcode == OE_ASYNC_IO_OP_WRITE || opcode == OE_ASYNC_IO_OP_SEND;
+}
+
+/*
+**==============================================================================
+**
+** _submit()
+**
+**     Claim a free slot, fill in its request and push it to the submission
+**     ring. Returns the index of the slot, or -1 with oe_errno set.
+**
+**     A request that the caller waits for is only submitted while a host
+**     worker is free, since the request may block until another request is
+**     served, e.g. a read from a pipe that the enclave writes to later. The
+**     caller makes an OCALL instead.
+**
+**==============================================================================
+*/
+
+static int _submit(
+    oe_async_io_opcode_t opcode,
+    int64_t host_fd,
+    void* buf,
+    size_t count,
+    int flags,
+    uint64_t user_data,
+    bool is_waited)
+{
+    int ret = -1;
+    oe_async_io_request_t* request;
+    slot_t* slot = NULL;
+    size_t index = 0;
+
+    if (!_rings)
+    {
+        oe_errno = OE_ENOSYS;
+        goto done;
+    }
+
+    OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+
+    if (opcode < OE_ASYNC_IO_OP_READ || opcode > OE_ASYNC_IO_OP_SEND ||
+        (count && !buf))
+    {
+        oe_errno = OE_EINVAL;
+        goto done;
+    }
+
+    if (count > _buffer_size)
+        count = _buffer_size;
+
+    oe_spin_lock(&_lock);
+
+    for (index = 0; index < _num_requests; index++)
+    {
+        if (is_waited && _num_pending >= _num_workers)
+            break;
+
+        /* Claim the first free slot */
+        if (_slots[index].state == SLOT_FREE)
+        {
+            slot = &_slots[index];
+            slot->state = SLOT_PENDING;
+            _num_pending++;
+            break;
+        }
+    }
+
+    oe_spin_unlock(&_lock);
+
+    if (!slot)
+    {
+        oe_errno = OE_EAGAIN;
+        goto done;
+    }
+
+    slot->is_waited = is_waited;
+    slot->opcode = opcode;
+    slot->buf = buf;
+    slot->count = count;
+    slot->user_data = user_data;
+
+    request = &_requests[index];
+    request->opcode = (uint32_t)opcode;
+    request->flags = flags;
+    request->fd = host_fd;
+    request->count = count;
+    request->result = -1;
+    request->error = 0;
+
+    if (_is_input(opcode) && count)
+        oe_memcpy_s(_get_buffer(index), _buffer_size, buf, count);
+
+    /* Publish the request before the host can see the slot. */
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+
+    /* The ring holds every slot, unless the host filled it with junk. */
+    if (!oe_switchless_ring_push(&_rings->submission_ring, request))
+    {
+        oe_spin_lock(&_lock);
+        slot->state = SLOT_FREE;
+        _num_pending--;
+        oe_spin_unlock(&_lock);
+
+        oe_errno = OE_EAGAIN;
+        goto done;
+    }
+
+    ret = (int)index;
+
+done:
+    return ret;
+}
+
+int oe_async_io_submit_host(
+    oe_async_io_opcode_t opcode,
+    int64_t host_fd,
+    void* buf,
+    size_t count,
+    int flags,
+    uint64_t user_data)
+{
+    int index = _submit(opcode, host_fd, buf, count, flags, user_data, false);
+
+    return index == -1 ? -1 : 0;
+}
+
+/*
+**==============================================================================
+**
+** _complete()
+**
+**     Check the outcome that the host filled in for a slot the way an OCALL
+**     result is checked, and copy out the data that was read. Must be called
+**     with the lock held.
+**
+**==============================================================================
+*/
+
+static void _complete(size_t index)
+{
+    slot_t* slot = &_slots[index];
+    const oe_async_io_request_t* request = &_requests[index];
+    int64_t result = request->result;
+    int error = request->error;
+
+    slot->result = -1;
+    slot->error = OE_EINVAL;
+
+    if (result == -1)
+    {
+        /* The host must report why the operation failed. */
+        if (error > 0)
+            slot->error = error;
+    }
+    else if (result >= 0 && (uint64_t)result <= slot->count)
+    {
+        if (!_is_input(slot->opcode) && result > 0)
+        {
+            oe_memcpy_s(
+                slot->buf,
+                slot->count,
+                _get_buffer(index),
+                (size_t)result);
+        }
+
+        slot->result = (ssize_t)result;
+        slot->error = 0;
+    }
+
+    slot->state = SLOT_COMPLETED;
+    _num_pending--;
+}
+
+/* Move the slots that the host completed from the completion ring into the
+ * enclave bookkeeping. */
+static void _drain_completions(void)
+{
+    void* items[OE_ASYNC_IO_MAX_REQUESTS];
+    size_t count;
+
+    while ((count = oe_switchless_ring_pop(
+                &_rings->completion_ring, items, OE_COUNTOF(items))) > 0)
+    {
+        OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+
+        oe_spin_lock(&_lock);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            uint8_t* item = (uint8_t*)items[i];
+            uint8_t* base = (uint8_t*)_requests;
+            size_t offset;
+            size_t index;
+
+            /* Ignore anything but a pending slot. */
+            if (item < base)
+                continue;
+
+            offset = (size_t)(item - base);
+            index = offset / sizeof(oe_async_io_request_t);
+
+            if (offset % sizeof(oe_async_io_request_t) != 0 ||
+                index >= _num_requests || _slots[index].state != SLOT_PENDING)
+            {
+                continue;
+            }
+
+            _complete(index);
+        }
+
+        oe_spin_unlock(&_lock);
+    }
+}
+
+size_t oe_async_io_reap(oe_async_io_completion_t* completions, size_t count)
+{
+    size_t n = 0;
+
+    if (!_rings || !completions)
+        return 0;
+
+    OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+
+    _drain_completions();
+
+    oe_spin_lock(&_lock);
+
+    for (size_t i = 0; i < _num_requests && n < count; i++)
+    {
+        slot_t* slot = &_slots[i];
+
+        if (slot->state == SLOT_COMPLETED && !slot->is_waited)
+        {
+            completions[n].user_data = slot->user_data;
+            completions[n].result = slot->result;
+            completions[n].error = slot->error;
+            slot->state = SLOT_FREE;
+            n++;
+        }
+    }
+
+    oe_spin_unlock(&_lock);
+
+    return n;
+}
+
+bool oe_async_io_call_host(
+    oe_async_io_opcode_t opcode,
+    int64_t host_fd,
+    void* buf,
+    size_t count,
+    int flags,
+    ssize_t* result)
+{
+    slot_t* slot;
+    int index;
+
+    if ((index = _submit(opcode, host_fd, buf, count, flags, 0, true)) == -1)
+        return false;
+
+    slot = &_slots[index];
+
+    for (;;)
+    {
+        _drain_completions();
+
+        oe_spin_lock(&_lock);
+
+        if (slot->state == SLOT_COMPLETED)
+        {
+            *result = slot->result;
+            if (slot->result == -1)
+                oe_errno = slot->error;
+
+            slot->state = SLOT_FREE;
+            oe_spin_unlock(&_lock);
+            break;
+        }
+
+        oe_spin_unlock(&_lock);
+
+        OE_CPU_RELAX();
+    }
+
+    return true;
+}
@@ -40,7 +40,7 @@ int oe_backtrace(void** buffer, int size)
 {
     OE_UNUSED(buffer);
     OE_UNUSED(size);
-#ifdef OE_USE_DEBUG_MALLOC
+#if defined(OE_USE_DEBUG_MALLOC) || defined(OE_USE_ALLOCATION_PROFILER)
     // Fetch the frame-pointer of the current function.
     // The current function oe_backtrace is not expected to be inlined.
     // The rbp register contains the frame-pointer upon entry to the function.
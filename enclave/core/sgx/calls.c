@@ -8,6 +8,7 @@
 #include <openenclave/corelibc/string.h>
 #include <openenclave/edger8r/enclave.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/asyncio.h>
 #include <openenclave/internal/atomic.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/fault.h>
@@ -17,7 +18,10 @@
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/switchless.h>
 #include <openenclave/internal/thread.h>
+#include <openenclave/internal/threadpool.h>
+#include <openenclave/internal/time.h>
 #include <openenclave/internal/trace.h>
 #include <openenclave/internal/utils.h>
 #include "../../sgx/report.h"
@@ -291,8 +295,10 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
         // Copy outputs to host memory.
         memcpy(args.output_buffer, output_buffer, output_bytes_written);
 
-        // The ecall succeeded.
+        // The ecall succeeded. The release barrier orders the writes above
+        // before the result, which switchless callers poll for.
         args_ptr->output_bytes_written = output_bytes_written;
+        OE_ATOMIC_MEMORY_BARRIER_RELEASE();
         args_ptr->result = OE_OK;
     }
 
@@ -303,6 +309,96 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** _handle_switchless_enclave_worker()
+**
+**     Handle the OE_ECALL_CONTEXT_SWITCHLESS_WORKER from host. The calling
+**     host thread lends its TCS to the enclave: poll the worker context for
+**     switchless ECALLs posted by the host and execute them until the host
+**     asks the worker to stop. An idle worker polls up to its spin budget,
+**     and then parks in the host until the host posts an ECALL to it.
+**
+**==============================================================================
+*/
+static oe_result_t _handle_switchless_enclave_worker(uint64_t arg_in)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_enclave_worker_context_t* context = (oe_enclave_worker_context_t*)arg_in;
+    uint64_t spins = 0;
+
+    // Ensure the worker context is outside of the enclave.
+    if (!context ||
+        !oe_is_outside_enclave(context, sizeof(oe_enclave_worker_context_t)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* lfence after checks. */
+    oe_lfence();
+
+    while (!context->is_stopping)
+    {
+        oe_call_enclave_function_args_t* args =
+            (oe_call_enclave_function_args_t*)context->call_arg;
+
+        if (args == NULL)
+        {
+            if (spins++ < OE_SWITCHLESS_ENCLAVE_WORKER_SPIN_COUNT)
+            {
+                /* Yield to CPU */
+                asm volatile("pause");
+                continue;
+            }
+
+            spins = 0;
+
+            // Publish the PARKED state before checking for a call once more.
+            // The host checks the state after posting a call, so either this
+            // check sees the call or the host sees the worker parked.
+            oe_atomic_compare_and_swap_32(
+                &context->state,
+                OE_ENCLAVE_WORKER_RUNNING,
+                OE_ENCLAVE_WORKER_PARKED);
+
+            if (context->call_arg == NULL && !context->is_stopping)
+            {
+                context->park_count++;
+                OE_CHECK(oe_ocall(
+                    OE_OCALL_PARK_SWITCHLESS_WORKER, (uint64_t)context, NULL));
+            }
+
+            context->state = OE_ENCLAVE_WORKER_RUNNING;
+            continue;
+        }
+
+        spins = 0;
+        context->call_arg = NULL;
+        context->call_count++;
+
+        // On success, _handle_call_enclave_function has already published
+        // the result. Only report failures here, since the host may reclaim
+        // args as soon as it observes a result.
+        oe_result_t call_result = _handle_call_enclave_function((uint64_t)args);
+        if (call_result != OE_OK)
+        {
+            if (!oe_is_outside_enclave(args, sizeof(*args)))
+                OE_RAISE(OE_INVALID_PARAMETER);
+
+            OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+            args->result = call_result;
+        }
+
+        // The worker never returns from its ECALL, so reclaim the arena used
+        // by switchless OCALLs of the finished call here.
+        oe_arena_free_all();
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 /*
 **==============================================================================
 **
@@ -348,6 +444,15 @@ static void _handle_ecall(
 
     td_push_callsite(td, &callsite);
 
+    // No OCALL can be in flight when the outermost ECALL starts, so release
+    // anything left in the per-TCS OCALL buffer by an aborted OCALL.
+    if (td->depth == 1)
+    {
+        td->base.ocall_buffer_used = 0;
+        td->base.ocall_buffer_top = 0;
+        td->base.ocall_buffer_live = 0;
+    }
+
     // Acquire release semantics for __oe_initialized are present in
     // _handle_init_enclave.
     if (!__oe_initialized)
@@ -423,6 +528,36 @@ static void _handle_ecall(
             arg_out = oe_handle_init_switchless(arg_in);
             break;
         }
+        case OE_ECALL_CONTEXT_SWITCHLESS_WORKER:
+        {
+            arg_out = _handle_switchless_enclave_worker(arg_in);
+            break;
+        }
+        case OE_ECALL_INIT_TIME_PAGE:
+        {
+            arg_out = oe_handle_init_time_page(arg_in);
+            break;
+        }
+        case OE_ECALL_INIT_ASYNC_IO:
+        {
+            arg_out = oe_handle_init_async_io(arg_in);
+            break;
+        }
+        case OE_ECALL_INIT_THREAD_POOL:
+        {
+            arg_out = oe_handle_init_thread_pool(arg_in);
+            break;
+        }
+        case OE_ECALL_THREAD_POOL_WORKER:
+        {
+            arg_out = oe_handle_thread_pool_worker();
+            break;
+        }
+        case OE_ECALL_STOP_THREAD_POOL:
+        {
+            arg_out = oe_handle_stop_thread_pool();
+            break;
+        }
         default:
         {
             /* No function found with the number */
@@ -575,7 +710,7 @@ oe_result_t oe_call_host_function_by_table_id(
 
     /* Initialize the arguments */
     args = switchless ? oe_arena_calloc(1, sizeof(*args))
-                      : oe_host_calloc(1, sizeof(*args));
+                      : oe_allocate_ocall_buffer(sizeof(*args));
 
     if (args == NULL)
     {
@@ -584,6 +719,8 @@ oe_result_t oe_call_host_function_by_table_id(
         OE_RAISE(OE_OUT_OF_MEMORY);
     }
 
+    memset(args, 0, sizeof(*args));
+
     args->table_id = table_id;
     args->function_id = function_id;
     args->input_buffer = input_buffer;
@@ -629,9 +766,9 @@ oe_result_t oe_call_host_function_by_table_id(
     result = OE_OK;
 
 done:
-    if (!switchless)
+    if (!switchless && args)
     {
-        oe_host_free(args);
+        oe_free_ocall_buffer(args);
     }
 
     return result;
@@ -3,18 +3,103 @@
 
 #include <openenclave/edger8r/enclave.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/utils.h>
+#include "td.h"
 
-// Function used by oeedger8r for allocating ocall buffers. This function can be
-// optimized by allocating a buffer for making ocalls and pass it in to the
-// ecall and making it available for use here.
+/*
+**==============================================================================
+**
+** _get_ocall_buffer()
+**
+**     Get the host memory region that the host reserved for OCALLs made on
+**     the current TCS. The region is requested and validated once, and then
+**     cached in the thread data, which persists across ECALLs.
+**
+**==============================================================================
+*/
+
+static uint8_t* _get_ocall_buffer(td_t* td)
+{
+    uint64_t arg_out = 0;
+
+    if (td->base.ocall_buffer)
+        return td->base.ocall_buffer;
+
+    if (oe_ocall(OE_OCALL_GET_OCALL_BUFFER, 0, &arg_out) != OE_OK || !arg_out)
+        return NULL;
+
+    if (!oe_is_outside_enclave((void*)arg_out, OE_OCALL_BUFFER_SIZE))
+        oe_abort();
+
+    /* lfence after checks. */
+    oe_lfence();
+
+    td->base.ocall_buffer = (uint8_t*)arg_out;
+    td->base.ocall_buffer_used = 0;
+    td->base.ocall_buffer_top = 0;
+    td->base.ocall_buffer_live = 0;
+
+    return td->base.ocall_buffer;
+}
+
+// Function used by oeedger8r for allocating ocall buffers. Buffers are
+// bump-allocated from the per-TCS host region, which saves the OCALLs to
+// oe_host_malloc and oe_host_free. Since a TCS makes at most one OCALL at a
+// time, allocations are usually freed in the reverse order in which they are
+// made. Requests that do not fit in the region fall back to oe_host_malloc.
 void* oe_allocate_ocall_buffer(size_t size)
 {
+    td_t* td = oe_get_td();
+    uint8_t* buffer = _get_ocall_buffer(td);
+    size_t total_size =
+        oe_round_up_to_multiple(size, OE_EDGER8R_BUFFER_ALIGNMENT);
+
+    if (buffer && total_size >= size &&
+        total_size <= OE_OCALL_BUFFER_SIZE - td->base.ocall_buffer_used)
+    {
+        void* ptr = buffer + td->base.ocall_buffer_used;
+        td->base.ocall_buffer_top = td->base.ocall_buffer_used;
+        td->base.ocall_buffer_used += (uint32_t)total_size;
+        td->base.ocall_buffer_live++;
+        return ptr;
+    }
+
     return oe_host_malloc(size);
 }
 
-// Function used by oeedger8r for freeing ocall buffers.
+// Function used by oeedger8r for freeing ocall buffers. Only the most recent
+// allocation is given back right away. An allocation freed out of order stays
+// in use until all the allocations from the region are freed, so that it never
+// overlaps one that is still live.
 void oe_free_ocall_buffer(void* buffer)
 {
+    td_t* td = oe_get_td();
+    uint8_t* ptr = (uint8_t*)buffer;
+    uint8_t* region = td->base.ocall_buffer;
+
+    if (region && ptr >= region && ptr < region + OE_OCALL_BUFFER_SIZE)
+    {
+        oe_assert(td->base.ocall_buffer_live > 0);
+
+        if (td->base.ocall_buffer_live == 0)
+            return;
+
+        if (--td->base.ocall_buffer_live == 0)
+        {
+            td->base.ocall_buffer_used = 0;
+            td->base.ocall_buffer_top = 0;
+        }
+        else if (ptr == region + td->base.ocall_buffer_top)
+        {
+            // The allocation before it is not known, so the new top is the
+            // end of the bytes in use, where no live allocation starts.
+            td->base.ocall_buffer_used = td->base.ocall_buffer_top;
+        }
+
+        return;
+    }
+
     oe_host_free(buffer);
 }
 
@@ -12,6 +12,7 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
 #include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
 #include "sgx_t.h"
 
@@ -120,14 +121,82 @@ done:
     return result;
 }
 
-static oe_result_t _get_sgx_target_info(sgx_target_info_t* target_info)
+/*
+**==============================================================================
+**
+** QE target info and quote size:
+**
+**     The target info of the Quoting Enclave and the size of its quotes only
+**     change when the QE does, so they are kept from the last remote report.
+**     This saves the OCALL for the target info, and lets oe_get_report() ask
+**     for the quote in a buffer of the right size. A quote that fails to be
+**     generated for a report that targets the kept QE drops the target info,
+**     in case the QE was updated, and the report is made again.
+**
+**==============================================================================
+*/
+
+static oe_spinlock_t _qe_lock = OE_SPINLOCK_INITIALIZER;
+static sgx_target_info_t _qe_target_info;
+static bool _have_qe_target_info;
+static size_t _quote_size;
+
+static oe_result_t _get_sgx_target_info(
+    sgx_target_info_t* target_info,
+    bool* cached)
 {
+    oe_result_t result = OE_UNEXPECTED;
     uint32_t retval;
 
+    oe_spin_lock(&_qe_lock);
+    *cached = _have_qe_target_info;
+    if (*cached)
+        *target_info = _qe_target_info;
+    oe_spin_unlock(&_qe_lock);
+
+    if (*cached)
+        return OE_OK;
+
     if (oe_get_qetarget_info_ocall(&retval, target_info) != OE_OK)
         return OE_FAILURE;
 
-    return (oe_result_t)retval;
+    result = (oe_result_t)retval;
+
+    if (result == OE_OK)
+    {
+        oe_spin_lock(&_qe_lock);
+        _qe_target_info = *target_info;
+        _have_qe_target_info = true;
+        oe_spin_unlock(&_qe_lock);
+    }
+
+    return result;
+}
+
+static void _forget_sgx_target_info(void)
+{
+    oe_spin_lock(&_qe_lock);
+    _have_qe_target_info = false;
+    _quote_size = 0;
+    oe_spin_unlock(&_qe_lock);
+}
+
+static void _set_quote_size(size_t quote_size)
+{
+    oe_spin_lock(&_qe_lock);
+    _quote_size = quote_size;
+    oe_spin_unlock(&_qe_lock);
+}
+
+static size_t _get_quote_size(void)
+{
+    size_t quote_size;
+
+    oe_spin_lock(&_qe_lock);
+    quote_size = _quote_size;
+    oe_spin_unlock(&_qe_lock);
+
+    return quote_size;
 }
 
 static oe_result_t _get_quote(
@@ -166,36 +235,71 @@ oe_result_t oe_get_remote_report(
     sgx_report_t sgx_report = {{{0}}};
     size_t sgx_report_size = sizeof(sgx_report);
     sgx_quote_t* sgx_quote = NULL;
+    size_t buffer_size;
 
     // For remote attestation, the Quoting Enclave's target info is used.
     // opt_params must not be supplied.
     if (opt_params != NULL || opt_params_size != 0)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    /*
-     * OCall: Get target info from Quoting Enclave.
-     * This involves a call to host. The target provided by targetinfo does not
-     * need to be trusted because returning a report is not an operation that
-     * requires privacy. The trust decision is one of integrity verification
-     * on the part of the report recipient.
-     */
-    OE_CHECK(_get_sgx_target_info(&sgx_target_info));
+    if (!report_buffer_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
 
-    /*
-     * Get enclave's local report passing in the quoting enclave's target info.
-     */
-    OE_CHECK(_get_local_report(
-        report_data,
-        report_data_size,
-        &sgx_target_info,
-        sizeof(sgx_target_info),
-        &sgx_report,
-        &sgx_report_size));
+    // The host writes the quote size even when it fails, so each attempt
+    // starts from the size of the caller's buffer.
+    buffer_size = report_buffer ? *report_buffer_size : 0;
+
+    for (;;)
+    {
+        bool cached;
+
+        *report_buffer_size = buffer_size;
+
+        /*
+         * OCall: Get target info from Quoting Enclave, unless it is cached.
+         * This involves a call to host. The target provided by targetinfo
+         * does not need to be trusted because returning a report is not an
+         * operation that requires privacy. The trust decision is one of
+         * integrity verification on the part of the report recipient.
+         */
+        OE_CHECK(_get_sgx_target_info(&sgx_target_info, &cached));
+
+        /*
+         * Get enclave's local report passing in the quoting enclave's target
+         * info.
+         */
+        OE_CHECK(_get_local_report(
+            report_data,
+            report_data_size,
+            &sgx_target_info,
+            sizeof(sgx_target_info),
+            &sgx_report,
+            &sgx_report_size));
+
+        /*
+         * OCall: Get the quote for the local report.
+         */
+        result = _get_quote(&sgx_report, report_buffer, report_buffer_size);
+
+        // A quote larger than the buffer cannot have been written to it.
+        if (result == OE_OK && *report_buffer_size > buffer_size)
+            OE_RAISE(OE_UNEXPECTED);
+
+        if (result == OE_OK || result == OE_BUFFER_TOO_SMALL)
+        {
+            // The size comes from the host, so only sane sizes are kept.
+            if (*report_buffer_size <= OE_MAX_REPORT_SIZE)
+                _set_quote_size(*report_buffer_size);
+            break;
+        }
+
+        // The QE may have changed since its target info was cached.
+        _forget_sgx_target_info();
+
+        if (!cached)
+            break;
+    }
 
-    /*
-     * OCall: Get the quote for the local report.
-     */
-    result = _get_quote(&sgx_report, report_buffer, report_buffer_size);
     if (result == OE_BUFFER_TOO_SMALL)
         OE_CHECK_NO_TRACE(result);
     else
@@ -314,23 +418,21 @@ oe_result_t oe_get_report_v2(
     *report_buffer = NULL;
     *report_buffer_size = 0;
 
-    result = _oe_get_report_internal(
-        flags,
-        report_data,
-        report_data_size,
-        opt_params,
-        opt_params_size,
-        NULL,
-        &tmp_buffer_size);
-    if (result != OE_BUFFER_TOO_SMALL)
-    {
-        return result;
-    }
+    // Guess the size of the report, so that it is usually made in one pass.
+    if (flags & OE_REPORT_FLAGS_REMOTE_ATTESTATION)
+        tmp_buffer_size = _get_quote_size();
+    else
+        tmp_buffer_size = sizeof(sgx_report_t);
 
-    tmp_buffer = oe_calloc(1, tmp_buffer_size);
-    if (tmp_buffer == NULL)
+    if (tmp_buffer_size != 0)
     {
-        return OE_OUT_OF_MEMORY;
+        tmp_buffer_size += sizeof(oe_report_header_t);
+
+        tmp_buffer = oe_calloc(1, tmp_buffer_size);
+        if (tmp_buffer == NULL)
+        {
+            return OE_OUT_OF_MEMORY;
+        }
     }
 
     result = _oe_get_report_internal(
@@ -341,6 +443,25 @@ oe_result_t oe_get_report_v2(
         opt_params_size,
         tmp_buffer,
         &tmp_buffer_size);
+    if (result == OE_BUFFER_TOO_SMALL)
+    {
+        oe_free(tmp_buffer);
+
+        tmp_buffer = oe_calloc(1, tmp_buffer_size);
+        if (tmp_buffer == NULL)
+        {
+            return OE_OUT_OF_MEMORY;
+        }
+
+        result = _oe_get_report_internal(
+            flags,
+            report_data,
+            report_data_size,
+            opt_params,
+            opt_params_size,
+            tmp_buffer,
+            &tmp_buffer_size);
+    }
     if (result != OE_OK)
     {
         oe_free(tmp_buffer);
@@ -9,6 +9,7 @@
 #include <openenclave/internal/fault.h>
 #include <openenclave/internal/globals.h>
 #include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/threadpool.h>
 #include <openenclave/internal/utils.h>
 #include "asmdefs.h"
 #include "thread.h"
@@ -247,8 +248,10 @@ void td_init(td_t* td)
         // td_t.hostsp, td_t.hostbp, and td_t.retaddr already set by
         // oe_enter().
 
-        /* Clear base structure */
+        /* Clear base structure, except for the OCALL buffer of the TCS */
+        uint8_t* ocall_buffer = td->base.ocall_buffer;
         memset(&td->base, 0, sizeof(td->base));
+        td->base.ocall_buffer = ocall_buffer;
 
         /* Set pointer to self */
         td->base.self_addr = (uint64_t)td;
@@ -302,11 +305,38 @@ void td_clear(td_t* td)
     if (td->depth != 0 || td->callsites != NULL)
         oe_abort();
 
-    /* Clear base structure */
+    /* Clear base structure, except for the OCALL buffer of the TCS */
+    uint8_t* ocall_buffer = td->base.ocall_buffer;
     memset(&td->base, 0, sizeof(td->base));
+    td->base.ocall_buffer = ocall_buffer;
 
     /* Clear the magic number */
     td->magic = 0;
 
     /* Never clear td_t.initialized nor host registers */
 }
+
+/*
+**==============================================================================
+**
+** oe_thread_pool_reset_thread()
+**
+**     Release the thread-specific data and the thread-local storage of the
+**     current thread as td_clear() does, then initialize the thread-local
+**     storage again as td_init() does. The ECALL of a thread pool worker
+**     never returns, so this is called after each of its tasks instead.
+**
+**==============================================================================
+*/
+
+void oe_thread_pool_reset_thread(void)
+{
+    oe_thread_destruct_specific();
+
+#if __linux__
+    td_t* td = oe_get_td();
+
+    oe_thread_local_cleanup(td);
+    oe_thread_local_init(td);
+#endif
+}
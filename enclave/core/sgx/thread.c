@@ -5,6 +5,7 @@
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sgxtypes.h>
@@ -17,22 +18,161 @@
 **
 ** Host requests:
 **
+**     A thread that has to wait first spins for the wake, and only asks the
+**     host to park it if the wake does not come within the spin budget. The
+**     td_t.wait_state field tells the waker whether the waiting thread is
+**     parked, in which case the host has to be asked to wake it up:
+**
+**         IDLE     -> SPINNING (waiter starts spinning)
+**         SPINNING -> PARKED   (waiter gives up spinning)
+**         IDLE     -> WOKEN    (wake before wait)
+**         SPINNING -> WOKEN    (wake while spinning, no OCALL needed)
+**         PARKED   -> WAKING   (wake while parked, OCALL needed)
+**         WOKEN    -> IDLE     (waiter consumes the wake)
+**         WAKING   -> IDLE     (waiter returns from the host)
+**
 **==============================================================================
 */
 
-static int _thread_wait(oe_thread_data_t* self)
+#define WAIT_STATE_IDLE 0
+#define WAIT_STATE_SPINNING 1
+#define WAIT_STATE_PARKED 2
+#define WAIT_STATE_WOKEN 3
+#define WAIT_STATE_WAKING 4
+
+static uint32_t _spin_count = OE_LOCK_DEFAULT_SPIN_COUNT;
+static oe_lock_statistics_t _statistics;
+
+void oe_set_lock_spin_count(uint32_t spin_count)
+{
+    __atomic_store_n(&_spin_count, spin_count, __ATOMIC_RELAXED);
+}
+
+oe_result_t oe_get_lock_statistics(oe_lock_statistics_t* statistics)
+{
+    if (!statistics)
+        return OE_INVALID_PARAMETER;
+
+    statistics->mutex_spins =
+        __atomic_load_n(&_statistics.mutex_spins, __ATOMIC_RELAXED);
+    statistics->mutex_parks =
+        __atomic_load_n(&_statistics.mutex_parks, __ATOMIC_RELAXED);
+    statistics->rwlock_spins =
+        __atomic_load_n(&_statistics.rwlock_spins, __ATOMIC_RELAXED);
+    statistics->rwlock_parks =
+        __atomic_load_n(&_statistics.rwlock_parks, __ATOMIC_RELAXED);
+    statistics->cond_spins =
+        __atomic_load_n(&_statistics.cond_spins, __ATOMIC_RELAXED);
+    statistics->cond_parks =
+        __atomic_load_n(&_statistics.cond_parks, __ATOMIC_RELAXED);
+
+    return OE_OK;
+}
+
+static void _count(uint64_t* counter)
+{
+    __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
+
+static uint32_t _get_spin_count(void)
+{
+    return __atomic_load_n(&_spin_count, __ATOMIC_RELAXED);
+}
+
+/* Consume a wake that was delivered without the host */
+static bool _consume_wake(td_t* td)
+{
+    return oe_atomic_compare_and_swap_32(
+        &td->wait_state, WAIT_STATE_WOKEN, WAIT_STATE_IDLE);
+}
+
+/* Deliver a wake to the given thread. Return true if the thread is parked,
+ * in which case the caller must ask the host to wake it up. */
+static bool _deliver_wake(td_t* td)
 {
-    const void* tcs = td_to_tcs((td_t*)self);
+    for (;;)
+    {
+        uint32_t state = td->wait_state;
+
+        switch (state)
+        {
+            case WAIT_STATE_IDLE:
+            case WAIT_STATE_SPINNING:
+                if (oe_atomic_compare_and_swap_32(
+                        &td->wait_state, state, WAIT_STATE_WOKEN))
+                    return false;
+                break;
+            case WAIT_STATE_PARKED:
+                if (oe_atomic_compare_and_swap_32(
+                        &td->wait_state, state, WAIT_STATE_WAKING))
+                    return true;
+                break;
+            default:
+                /* The thread already has a wake on the way */
+                return false;
+        }
+    }
+}
+
+/* Spin until a wake is delivered or the spin budget runs out. Return true if
+ * the wake was consumed, or else leave the thread in the PARKED state. */
+static bool _spin_for_wake(td_t* td)
+{
+    if (_consume_wake(td))
+        return true;
+
+    if (!oe_atomic_compare_and_swap_32(
+            &td->wait_state, WAIT_STATE_IDLE, WAIT_STATE_SPINNING))
+        return _consume_wake(td);
+
+    for (uint32_t i = _get_spin_count(); i > 0; i--)
+    {
+        if (td->wait_state == WAIT_STATE_WOKEN)
+            break;
+
+        asm volatile("pause");
+    }
+
+    if (oe_atomic_compare_and_swap_32(
+            &td->wait_state, WAIT_STATE_SPINNING, WAIT_STATE_PARKED))
+        return false;
+
+    return _consume_wake(td);
+}
+
+static int _thread_wait(
+    oe_thread_data_t* self,
+    uint64_t* spins,
+    uint64_t* parks)
+{
+    td_t* td = (td_t*)self;
+    const void* tcs = td_to_tcs(td);
+    int ret = 0;
+
+    if (_spin_for_wake(td))
+    {
+        _count(spins);
+        return 0;
+    }
+
+    _count(parks);
 
     if (oe_ocall(OE_OCALL_THREAD_WAIT, (uint64_t)tcs, NULL) != OE_OK)
-        return -1;
+        ret = -1;
 
-    return 0;
+    /* Either woken by the host or spuriously, the callers check again */
+    td->wait_state = WAIT_STATE_IDLE;
+
+    return ret;
 }
 
-static int _thread_wake(oe_thread_data_t* self)
+static int _thread_wake(oe_thread_data_t* waiter)
 {
-    const void* tcs = td_to_tcs((td_t*)self);
+    td_t* td = (td_t*)waiter;
+    const void* tcs = td_to_tcs(td);
+
+    if (!_deliver_wake(td))
+        return 0;
 
     if (oe_ocall(OE_OCALL_THREAD_WAKE, (uint64_t)tcs, NULL) != OE_OK)
         return -1;
@@ -40,16 +180,46 @@ static int _thread_wake(oe_thread_data_t* self)
     return 0;
 }
 
-static int _thread_wake_wait(oe_thread_data_t* waiter, oe_thread_data_t* self)
+static int _thread_wake_wait(
+    oe_thread_data_t* waiter,
+    oe_thread_data_t* self,
+    uint64_t* spins,
+    uint64_t* parks)
 {
     int ret = -1;
-    uint64_t waiter_tcs = (uint64_t)td_to_tcs((td_t*)waiter);
-    uint64_t self_tcs = (uint64_t)td_to_tcs((td_t*)self);
+    td_t* waiter_td = (td_t*)waiter;
+    td_t* self_td = (td_t*)self;
+    uint64_t waiter_tcs = (uint64_t)td_to_tcs(waiter_td);
+    uint64_t self_tcs = (uint64_t)td_to_tcs(self_td);
+
+    /* If the waiter can be woken without the host, just wait */
+    if (!_deliver_wake(waiter_td))
+        return _thread_wait(self, spins, parks);
+
+    /* Exiting the enclave is needed anyway, so park without spinning */
+    if (!oe_atomic_compare_and_swap_32(
+            &self_td->wait_state, WAIT_STATE_IDLE, WAIT_STATE_PARKED))
+    {
+        _consume_wake(self_td);
+        _count(spins);
+
+        if (oe_ocall(OE_OCALL_THREAD_WAKE, waiter_tcs, NULL) != OE_OK)
+            goto done;
+
+        ret = 0;
+        goto done;
+    }
+
+    _count(parks);
 
     if (oe_thread_wake_wait_ocall(oe_get_enclave(), waiter_tcs, self_tcs) !=
         OE_OK)
+    {
+        self_td->wait_state = WAIT_STATE_IDLE;
         goto done;
+    }
 
+    self_td->wait_state = WAIT_STATE_IDLE;
     ret = 0;
 
 done:
@@ -214,16 +384,31 @@ static int _mutex_lock(oe_mutex_impl_t* m, oe_thread_data_t* self)
     return -1;
 }
 
+/* Poll the mutex without holding its spinlock until it is released, for up
+ * to the spin budget */
+static void _spin_while_mutex_owned(oe_mutex_impl_t* m)
+{
+    for (uint32_t i = _get_spin_count(); i > 0; i--)
+    {
+        if (__atomic_load_n(&m->owner, __ATOMIC_RELAXED) == NULL &&
+            __atomic_load_n(&m->queue.front, __ATOMIC_RELAXED) == NULL)
+            break;
+
+        asm volatile("pause");
+    }
+}
+
 oe_result_t oe_mutex_lock(oe_mutex_t* mutex)
 {
     oe_mutex_impl_t* m = (oe_mutex_impl_t*)mutex;
     oe_thread_data_t* self = oe_get_thread_data();
+    bool queued = false;
 
     if (!m)
         return OE_INVALID_PARAMETER;
 
     /* Loop until SELF obtains mutex */
-    for (;;)
+    for (bool spun = false;; spun = true)
     {
         oe_spin_lock(&m->lock);
         {
@@ -231,20 +416,34 @@ oe_result_t oe_mutex_lock(oe_mutex_t* mutex)
             if (_mutex_lock(m, self) == 0)
             {
                 oe_spin_unlock(&m->lock);
+
+                if (spun && !queued)
+                    _count(&_statistics.mutex_spins);
+
                 return OE_OK;
             }
 
+            /* Spin once before queueing, as the owner may be about to
+             * release the mutex. Queued threads are woken up in order. */
+            if (!spun && m->queue.front == NULL)
+            {
+                oe_spin_unlock(&m->lock);
+                _spin_while_mutex_owned(m);
+                continue;
+            }
+
             /* If the waiters queue does not contain this thread */
             if (!_queue_contains(&m->queue, self))
             {
                 /* Insert thread at back of waiters queue */
                 _queue_push_back(&m->queue, self);
+                queued = true;
             }
         }
         oe_spin_unlock(&m->lock);
 
         /* Ask host to wait for an event on this thread */
-        _thread_wait(self);
+        _thread_wait(self, &_statistics.mutex_spins, &_statistics.mutex_parks);
     }
 
     /* Unreachable! */
@@ -431,12 +630,19 @@ oe_result_t oe_cond_wait(oe_cond_t* condition, oe_mutex_t* mutex)
             {
                 if (waiter)
                 {
-                    _thread_wake_wait(waiter, self);
+                    _thread_wake_wait(
+                        waiter,
+                        self,
+                        &_statistics.cond_spins,
+                        &_statistics.cond_parks);
                     waiter = NULL;
                 }
                 else
                 {
-                    _thread_wait(self);
+                    _thread_wait(
+                        self,
+                        &_statistics.cond_spins,
+                        &_statistics.cond_parks);
                 }
             }
             oe_spin_lock(&cond->lock);
@@ -544,6 +750,21 @@ oe_result_t oe_rwlock_init(oe_rwlock_t* read_write_lock)
     return result;
 }
 
+// Poll the lock without holding its spinlock until the writer, and for a
+// writer also the readers, have released it, for up to the spin budget.
+static void _spin_while_rwlock_owned(oe_rwlock_impl_t* rw_lock, bool writer)
+{
+    for (uint32_t i = _get_spin_count(); i > 0; i--)
+    {
+        if (__atomic_load_n(&rw_lock->writer, __ATOMIC_RELAXED) == NULL &&
+            (!writer ||
+             __atomic_load_n(&rw_lock->readers, __ATOMIC_RELAXED) == 0))
+            break;
+
+        asm volatile("pause");
+    }
+}
+
 oe_result_t oe_rwlock_rdlock(oe_rwlock_t* read_write_lock)
 {
     oe_rwlock_impl_t* rw_lock = (oe_rwlock_impl_t*)read_write_lock;
@@ -554,6 +775,17 @@ oe_result_t oe_rwlock_rdlock(oe_rwlock_t* read_write_lock)
 
     oe_spin_lock(&rw_lock->lock);
 
+    // Spin once before queueing, as the writer may be about to finish.
+    if (rw_lock->writer != NULL)
+    {
+        oe_spin_unlock(&rw_lock->lock);
+        _spin_while_rwlock_owned(rw_lock, false);
+        oe_spin_lock(&rw_lock->lock);
+
+        if (rw_lock->writer == NULL)
+            _count(&_statistics.rwlock_spins);
+    }
+
     // Wait for writer to finish.
     // Multiple readers can concurrently operate.
     while (rw_lock->writer != NULL)
@@ -563,7 +795,8 @@ oe_result_t oe_rwlock_rdlock(oe_rwlock_t* read_write_lock)
             _queue_push_back(&rw_lock->queue, self);
 
         oe_spin_unlock(&rw_lock->lock);
-        _thread_wait(self);
+        _thread_wait(
+            self, &_statistics.rwlock_spins, &_statistics.rwlock_parks);
 
         // Upon waking, re-acquire the lock.
         // Just like a condition variable.
@@ -669,6 +902,17 @@ oe_result_t oe_rwlock_wrlock(oe_rwlock_t* read_write_lock)
         return OE_BUSY;
     }
 
+    // Spin once before queueing, as the owners may be about to finish.
+    if (rw_lock->readers > 0 || rw_lock->writer != NULL)
+    {
+        oe_spin_unlock(&rw_lock->lock);
+        _spin_while_rwlock_owned(rw_lock, true);
+        oe_spin_lock(&rw_lock->lock);
+
+        if (rw_lock->readers == 0 && rw_lock->writer == NULL)
+            _count(&_statistics.rwlock_spins);
+    }
+
     // Wait for all readers and any other writer to finish.
     while (rw_lock->readers > 0 || rw_lock->writer != NULL)
     {
@@ -678,7 +922,8 @@ oe_result_t oe_rwlock_wrlock(oe_rwlock_t* read_write_lock)
 
         oe_spin_unlock(&rw_lock->lock);
 
-        _thread_wait(self);
+        _thread_wait(
+            self, &_statistics.rwlock_spins, &_statistics.rwlock_parks);
 
         // Upon waking, re-acquire the lock.
         // Just like a condition variable.
@@ -14,6 +14,10 @@ static size_t _host_worker_count = 0;
 // The array of host worker contexts. Initialized by host through ECALL
 static oe_host_worker_context_t* _host_worker_contexts = NULL;
 
+// The ring that switchless OCALLs are posted to. Initialized by host through
+// ECALL
+static oe_switchless_ring* _switchless_ring = NULL;
+
 /*
 **==============================================================================
 **
@@ -60,6 +64,8 @@ oe_result_t oe_handle_init_switchless(uint64_t arg_in)
             safe_manager.host_worker_contexts, contexts_size) ||
         !oe_is_outside_enclave(
             safe_manager.host_worker_threads, threads_size) ||
+        !oe_is_outside_enclave(
+            safe_manager.ring, sizeof(oe_switchless_ring)) ||
         safe_manager.num_host_workers == 0)
     {
         OE_RAISE(OE_INVALID_PARAMETER);
@@ -71,19 +77,69 @@ oe_result_t oe_handle_init_switchless(uint64_t arg_in)
     // Copy the worker context array pointer and its size to avoid TOCTOU
     _host_worker_count = safe_manager.num_host_workers;
     _host_worker_contexts = safe_manager.host_worker_contexts;
+    _switchless_ring = safe_manager.ring;
     result = OE_OK;
 
 done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** _is_host_worker_running()
+**
+**  Return whether at least one host worker is polling the ring.
+**
+**==============================================================================
+*/
+static bool _is_host_worker_running(void)
+{
+    for (size_t i = 0; i < _host_worker_count; i++)
+    {
+        if (_host_worker_contexts[i].state == OE_HOST_WORKER_RUNNING)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+**==============================================================================
+**
+** _request_host_worker_wake()
+**
+**  Ask the host to wake up a parked host worker. Return false if no worker
+**  is parked. The caller must make an OCALL afterwards, while handling which
+**  the host wakes up the worker.
+**
+**==============================================================================
+*/
+static bool _request_host_worker_wake(void)
+{
+    for (size_t i = 0; i < _host_worker_count; i++)
+    {
+        if (oe_atomic_compare_and_swap_32(
+                &_host_worker_contexts[i].state,
+                OE_HOST_WORKER_PARKED,
+                OE_HOST_WORKER_WAKING))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /*
 **==============================================================================
 **
 ** oe_post_switchless_ocall()
 **
-**  Post the function call (wrapped in args) to a free host worker thread
-**  by writing to its context.
+**  Post the function call (wrapped in args) to the ring that the host workers
+**  drain. Fail if all of the host workers are parked, in which case one of
+**  them is asked to wake up while the caller falls back to a regular OCALL,
+**  or if the ring is full.
 **
 **==============================================================================
 */
@@ -94,24 +150,23 @@ oe_result_t oe_post_switchless_ocall(oe_call_host_function_args_t* args)
     OE_ATOMIC_MEMORY_BARRIER_RELEASE();
     args->result = __OE_RESULT_MAX; // Means the call hasn't been processed.
 
-    // Cycle through the worker contexts until we find a free worker.
-    size_t tries = _host_worker_count;
-    while (tries--)
+    if (!_is_host_worker_running())
     {
-        if (_host_worker_contexts[tries].call_arg == NULL)
-        {
-            if (oe_atomic_compare_and_swap_ptr(
-                    (void* volatile*)&_host_worker_contexts[tries].call_arg,
-                    NULL,
-                    args))
-            {
-                return OE_OK;
-            }
-        }
+        _request_host_worker_wake();
+        OE_RAISE_NO_TRACE(OE_CONTEXT_SWITCHLESS_OCALL_MISSED);
     }
 
-    result = OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
+    if (!oe_switchless_ring_push(_switchless_ring, args))
+        OE_RAISE_NO_TRACE(OE_CONTEXT_SWITCHLESS_OCALL_MISSED);
 
+    // The host workers check the ring after parking. Should they all have
+    // parked right before the call was posted, wake one of them up.
+    if (!_is_host_worker_running() && _request_host_worker_wake())
+        OE_CHECK(oe_ocall(OE_OCALL_WAKE_SWITCHLESS_WORKER, 0, NULL));
+
+    result = OE_OK;
+
+done:
     return result;
 }
 
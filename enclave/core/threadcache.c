@@ -0,0 +1,318 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#define USE_DL_PREFIX
+#include "threadcache.h"
+#include <openenclave/bits/safecrt.h>
+#include <openenclave/bits/safemath.h>
+#include <openenclave/corelibc/errno.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+#include "../3rdparty/dlmalloc/dlmalloc/malloc.h"
+
+#if defined(OE_USE_THREAD_CACHE_MALLOC)
+
+/*
+**==============================================================================
+**
+** Thread-caching allocator:
+**
+**     This allocator keeps a cache of free small blocks for each enclave
+**     thread, so that most allocations and frees of small blocks are served
+**     without taking the global lock of dlmalloc. Each cache has a free list
+**     per size class. An empty list is refilled with a batch of blocks that
+**     dlmalloc allocates with a single lock acquisition, and a list that grows
+**     past its budget returns half of its blocks with a single lock
+**     acquisition. Blocks larger than the largest size class, and all blocks
+**     of threads that find no free cache, go straight to dlmalloc.
+**
+**     An enclave thread is bound to a TCS, so each cache is only ever used
+**     by one thread at a time and needs no lock. A block may be freed by a
+**     different thread than the one that allocated it, in which case it
+**     joins the cache of the freeing thread.
+**
+**     Blocks carry no header. The size class of a block is derived from the
+**     usable size that dlmalloc reports for it. Cached blocks count as in use
+**     in oe_get_malloc_stats().
+**
+**==============================================================================
+*/
+
+#define NUM_SIZE_CLASSES 20
+
+/* The largest request that is served from the caches */
+#define MAX_CACHED_SIZE 1024
+
+/* The most threads that get a cache */
+#define MAX_THREAD_CACHES 64
+
+/* The number of bytes that each free list holds before it returns blocks */
+#define FREE_LIST_BYTES 4096
+
+#define MIN_FREE_LIST_BLOCKS 4
+
+static const size_t _class_sizes[NUM_SIZE_CLASSES] = {
+    16,  32,  48,  64,  80,  96,  112, 128, 160, 192,
+    224, 256, 320, 384, 448, 512, 640, 768, 896, 1024,
+};
+
+typedef struct _block
+{
+    struct _block* next;
+} block_t;
+
+typedef struct _free_list
+{
+    block_t* head;
+    size_t count;
+} free_list_t;
+
+typedef struct _thread_cache
+{
+    /* The thread that owns the cache, or 0 if the cache is unused. Threads
+     * never give up their cache, as each thread is bound to a TCS. */
+    volatile int64_t owner;
+    free_list_t lists[NUM_SIZE_CLASSES];
+} thread_cache_t;
+
+static thread_cache_t _caches[MAX_THREAD_CACHES];
+
+static thread_cache_t* _get_cache(void)
+{
+    const int64_t self = (int64_t)oe_thread_self();
+    /* Thread data is page aligned, so skip the bits that never change */
+    const size_t start = (size_t)self >> 12;
+
+    for (size_t i = 0; i < MAX_THREAD_CACHES; i++)
+    {
+        thread_cache_t* cache = &_caches[(start + i) % MAX_THREAD_CACHES];
+        int64_t owner = cache->owner;
+
+        if (owner == self)
+            return cache;
+
+        if (owner == 0 && oe_atomic_compare_and_swap(&cache->owner, 0, self))
+            return cache;
+    }
+
+    return NULL;
+}
+
+/* Return the smallest size class that holds size bytes. */
+static size_t _size_to_class(size_t size)
+{
+    size_t index;
+
+    if (size <= 128)
+        return size ? (size - 1) / 16 : 0;
+
+    for (index = 8; _class_sizes[index] < size; index++)
+        ;
+
+    return index;
+}
+
+/* Return the largest size class that fits in usable bytes, or
+ * NUM_SIZE_CLASSES if the block is too large to be cached. */
+static size_t _usable_to_class(size_t usable)
+{
+    size_t index;
+
+    /* dlmalloc rounds each request up by a few bytes of overhead */
+    if (usable > MAX_CACHED_SIZE + 16)
+        return NUM_SIZE_CLASSES;
+
+    if (usable < 160)
+    {
+        index = usable / 16 - 1;
+        return index < 8 ? index : 7;
+    }
+
+    for (index = 8; index + 1 < NUM_SIZE_CLASSES &&
+                    _class_sizes[index + 1] <= usable;
+         index++)
+        ;
+
+    return index;
+}
+
+static size_t _max_blocks(size_t index)
+{
+    size_t max = FREE_LIST_BYTES / _class_sizes[index];
+
+    return max < MIN_FREE_LIST_BLOCKS ? MIN_FREE_LIST_BLOCKS : max;
+}
+
+/* Return count blocks of the list to dlmalloc. */
+static void _drain(free_list_t* list, size_t count)
+{
+    void* blocks[FREE_LIST_BYTES / 16];
+    size_t n = 0;
+
+    while (n < count && n < OE_COUNTOF(blocks) && list->head)
+    {
+        blocks[n++] = list->head;
+        list->head = list->head->next;
+        list->count--;
+    }
+
+    if (n)
+        dlbulk_free(blocks, n);
+}
+
+static void _drain_all(thread_cache_t* cache)
+{
+    for (size_t i = 0; i < NUM_SIZE_CLASSES; i++)
+    {
+        while (cache->lists[i].head)
+            _drain(&cache->lists[i], cache->lists[i].count);
+    }
+}
+
+/* Refill an empty list with half of its budget. */
+static bool _refill(free_list_t* list, size_t index)
+{
+    size_t sizes[FREE_LIST_BYTES / 16 / 2];
+    void* blocks[OE_COUNTOF(sizes)];
+    size_t count = _max_blocks(index) / 2;
+
+    for (size_t i = 0; i < count; i++)
+        sizes[i] = _class_sizes[index];
+
+    if (!dlindependent_comalloc(count, sizes, blocks))
+        return false;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        block_t* block = (block_t*)blocks[i];
+        block->next = list->head;
+        list->head = block;
+    }
+
+    list->count += count;
+    return true;
+}
+
+void* oe_thread_cache_malloc(size_t size)
+{
+    thread_cache_t* cache;
+    free_list_t* list;
+    block_t* block;
+    size_t index;
+
+    if (size > MAX_CACHED_SIZE || !(cache = _get_cache()))
+        return dlmalloc(size);
+
+    index = _size_to_class(size);
+    list = &cache->lists[index];
+
+    if (!list->head && !_refill(list, index))
+    {
+        /* The heap is low, so give back what this thread holds */
+        _drain_all(cache);
+        return dlmalloc(size);
+    }
+
+    block = list->head;
+    list->head = block->next;
+    list->count--;
+
+    return block;
+}
+
+void oe_thread_cache_free(void* ptr)
+{
+    thread_cache_t* cache;
+    free_list_t* list;
+    block_t* block = (block_t*)ptr;
+    size_t index;
+
+    if (!ptr)
+        return;
+
+    index = _usable_to_class(dlmalloc_usable_size(ptr));
+
+    if (index == NUM_SIZE_CLASSES || !(cache = _get_cache()))
+    {
+        dlfree(ptr);
+        return;
+    }
+
+    list = &cache->lists[index];
+    block->next = list->head;
+    list->head = block;
+    list->count++;
+
+    if (list->count > _max_blocks(index))
+        _drain(list, list->count / 2);
+}
+
+void* oe_thread_cache_calloc(size_t nmemb, size_t size)
+{
+    size_t total_size;
+    void* ptr;
+
+    if (oe_safe_mul_sizet(nmemb, size, &total_size) != OE_OK)
+        return NULL;
+
+    if (!(ptr = oe_thread_cache_malloc(total_size)))
+        return NULL;
+
+    oe_memset_s(ptr, total_size, 0, total_size);
+
+    return ptr;
+}
+
+void* oe_thread_cache_realloc(void* ptr, size_t size)
+{
+    size_t usable;
+    void* new_ptr;
+
+    if (!ptr)
+        return oe_thread_cache_malloc(size);
+
+    usable = dlmalloc_usable_size(ptr);
+
+    /* Let dlmalloc grow or shrink large blocks in place */
+    if (usable > MAX_CACHED_SIZE + 16 && size > MAX_CACHED_SIZE)
+        return dlrealloc(ptr, size);
+
+    /* Keep the block if it fits without wasting more than half of it */
+    if (size <= usable && size >= usable / 2)
+        return ptr;
+
+    if (!(new_ptr = oe_thread_cache_malloc(size)))
+        return NULL;
+
+    oe_memcpy_s(new_ptr, size, ptr, usable < size ? usable : size);
+    oe_thread_cache_free(ptr);
+
+    return new_ptr;
+}
+
+void* oe_thread_cache_memalign(size_t alignment, size_t size)
+{
+    /* Every block is aligned to at least 16 bytes */
+    if (alignment <= 16)
+        return oe_thread_cache_malloc(size);
+
+    return dlmemalign(alignment, size);
+}
+
+int oe_thread_cache_posix_memalign(void** memptr, size_t alignment, size_t size)
+{
+    if (!memptr)
+        return OE_EINVAL;
+
+    if (!oe_is_ptrsize_multiple(alignment) || !oe_is_pow2(alignment))
+        return OE_EINVAL;
+
+    if (!(*memptr = oe_thread_cache_memalign(alignment, size)))
+        return OE_ENOMEM;
+
+    return 0;
+}
+
+#endif /* defined(OE_USE_THREAD_CACHE_MALLOC) */
@@ -0,0 +1,21 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_THREAD_CACHE_H
+#define _OE_THREAD_CACHE_H
+
+#include <openenclave/bits/types.h>
+
+void* oe_thread_cache_malloc(size_t size);
+
+void oe_thread_cache_free(void* ptr);
+
+void* oe_thread_cache_calloc(size_t nmemb, size_t size);
+
+void* oe_thread_cache_realloc(void* ptr, size_t size);
+
+void* oe_thread_cache_memalign(size_t alignment, size_t size);
+
+int oe_thread_cache_posix_memalign(void** memptr, size_t alignment, size_t size);
+
+#endif /* _OE_THREAD_CACHE_H */
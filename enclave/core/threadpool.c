@@ -0,0 +1,164 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/threadpool.h>
+#include <openenclave/internal/utils.h>
+#include "arena.h"
+
+/* The number of times an idle worker checks the queue before it sleeps */
+#define OE_THREAD_POOL_SPIN_COUNT 4096
+
+/* Each worker occupies a TCS of its own, of which there are no more than 64 */
+#define OE_THREAD_POOL_MAX_WORKERS 64
+
+static oe_mutex_t _mutex = OE_MUTEX_INITIALIZER;
+static oe_cond_t _cond = OE_COND_INITIALIZER;
+
+/* The queue of tasks that no worker has picked up yet */
+static oe_thread_pool_task_t* volatile _head;
+static oe_thread_pool_task_t* _tail;
+
+static size_t _num_workers;
+
+/* The number of tasks that are queued or running */
+static size_t _num_tasks;
+
+static bool _is_stopping;
+
+size_t oe_thread_pool_get_num_workers(void)
+{
+    return _num_workers;
+}
+
+oe_result_t oe_thread_pool_submit(oe_thread_pool_task_t* task)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    bool locked = false;
+
+    if (!task || !task->run)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&_mutex);
+    locked = true;
+
+    if (_num_workers == 0 || _is_stopping)
+        OE_RAISE_NO_TRACE(OE_UNSUPPORTED);
+
+    if (_num_tasks == _num_workers)
+        OE_RAISE_NO_TRACE(OE_OUT_OF_THREADS);
+
+    task->next = NULL;
+
+    if (_tail)
+        _tail->next = task;
+    else
+        _head = task;
+
+    _tail = task;
+    _num_tasks++;
+
+    /* This only leaves the enclave if a worker is asleep */
+    oe_cond_signal(&_cond);
+
+    result = OE_OK;
+
+done:
+    if (locked)
+        oe_mutex_unlock(&_mutex);
+
+    return result;
+}
+
+oe_result_t oe_handle_init_thread_pool(uint64_t arg_in)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    oe_mutex_lock(&_mutex);
+
+    if (arg_in == 0 || arg_in > OE_THREAD_POOL_MAX_WORKERS || _num_workers != 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    _num_workers = (size_t)arg_in;
+    result = OE_OK;
+
+done:
+    oe_mutex_unlock(&_mutex);
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_handle_thread_pool_worker()
+**
+**     Handle the OE_ECALL_THREAD_POOL_WORKER from the host. The calling host
+**     thread lends its TCS to the enclave: run the queued tasks until the
+**     host stops the pool. An idle worker checks the queue for a while before
+**     it sleeps, so that a burst of tasks does not pay for waking it up.
+**
+**==============================================================================
+*/
+oe_result_t oe_handle_thread_pool_worker(void)
+{
+    if (_num_workers == 0)
+        return OE_UNSUPPORTED;
+
+    for (;;)
+    {
+        oe_thread_pool_task_t* task;
+
+        for (size_t i = 0; !_head && i < OE_THREAD_POOL_SPIN_COUNT; i++)
+            OE_CPU_RELAX();
+
+        oe_mutex_lock(&_mutex);
+        {
+            while (!_head && !_is_stopping)
+                oe_cond_wait(&_cond, &_mutex);
+
+            /* Tasks that are still queued never run */
+            if (_is_stopping)
+            {
+                oe_mutex_unlock(&_mutex);
+                break;
+            }
+
+            task = _head;
+
+            if (!(_head = task->next))
+                _tail = NULL;
+        }
+        oe_mutex_unlock(&_mutex);
+
+        task->run(task);
+
+        // The worker never returns from its ECALL, so release the state that
+        // an ECALL releases when it returns: the arena used by switchless
+        // OCALLs, and the thread-specific and thread-local data of the task.
+        // This is done before the task finishes, as a joined thread has run
+        // its destructors.
+        oe_teardown_arena();
+        oe_thread_pool_reset_thread();
+
+        oe_mutex_lock(&_mutex);
+        _num_tasks--;
+        oe_mutex_unlock(&_mutex);
+
+        if (task->finish)
+            task->finish(task);
+    }
+
+    return OE_OK;
+}
+
+oe_result_t oe_handle_stop_thread_pool(void)
+{
+    oe_mutex_lock(&_mutex);
+    _is_stopping = true;
+    oe_cond_broadcast(&_cond);
+    oe_mutex_unlock(&_mutex);
+
+    return OE_OK;
+}
@@ -3,8 +3,18 @@
 
 #include <openenclave/bits/types.h>
 #include <openenclave/corelibc/time.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
 #include <openenclave/internal/time.h>
+#include <openenclave/internal/utils.h>
+
+/* The time page set up by the host, or NULL if there is none */
+static const oe_time_page_t* _time_page;
+
+/* The latest time read from the time page */
+static volatile uint64_t _last_time;
 
 int oe_sleep_msec(uint64_t milliseconds)
 {
@@ -20,13 +30,61 @@ done:
     return ret;
 }
 
-uint64_t oe_get_time(void)
+/*
+**==============================================================================
+**
+** _clamp_time()
+**
+**     The host writes the time page at any time, so make sure that the time
+**     read from it never goes backwards, by returning the maximum of the
+**     given time and of the time read last. The time returned by the
+**     OCALL is left alone, as the caller asked for the time of the host.
+**
+**==============================================================================
+*/
+
+static uint64_t _clamp_time(uint64_t time)
+{
+    uint64_t last = _last_time;
+
+    while (time > last)
+    {
+        if (oe_atomic_compare_and_swap(
+                (int64_t volatile*)&_last_time, (int64_t)last, (int64_t)time))
+            return time;
+
+        last = _last_time;
+    }
+
+    return last;
+}
+
+oe_result_t oe_handle_init_time_page(uint64_t arg_in)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const oe_time_page_t* page = (const oe_time_page_t*)arg_in;
+
+    if (!page || !oe_is_outside_enclave(page, sizeof(oe_time_page_t)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* The page is set up once, when the enclave is created. */
+    if (_time_page)
+        OE_RAISE(OE_UNEXPECTED);
+
+    _time_page = page;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+uint64_t oe_get_fresh_time(void)
 {
     uint64_t ret = (uint64_t)-1;
 
     if (oe_ocall(OE_OCALL_GET_TIME, 0, &ret) != OE_OK)
     {
-        ret = (uint32_t)-1;
+        ret = (uint64_t)-1;
         goto done;
     }
 
@@ -35,6 +93,23 @@ done:
     return ret;
 }
 
+uint64_t oe_get_time(void)
+{
+    uint64_t time = 0;
+
+    /* Read the time page, unless the host has not updated it yet. */
+    if (_time_page)
+    {
+        time = _time_page->time_msec;
+        OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+    }
+
+    if (time == 0 || time == (uint64_t)-1)
+        return oe_get_fresh_time();
+
+    return _clamp_time(time);
+}
+
 /* OE core libc wrapper for time() function */
 time_t oe_time(time_t* tloc)
 {
@@ -3,6 +3,7 @@
 
 #include <openenclave/bits/defs.h>
 #include <openenclave/bits/safecrt.h>
+#include <openenclave/bits/safemath.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/cert.h>
 #include <openenclave/internal/crypto/sha.h>
@@ -10,6 +11,9 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
 #include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/threadpool.h>
+#include <openenclave/internal/time.h>
 #include <openenclave/internal/utils.h>
 #include <stdio.h>
 
@@ -23,6 +27,12 @@
 #define DATE_NOT_VALID_BEFORE "20190501000000"
 #define DATE_NOT_VALID_AFTER "20501231235959"
 
+// The number of key pairs whose certificate is cached
+#define CERT_CACHE_SIZE 16
+
+// How long a certificate is reused by default, which is not at all
+#define CERT_DEFAULT_TTL_SECONDS 0
+
 static const unsigned char oid_oe_report[] = X509_OID_FOR_QUOTE_EXT;
 
 // Input: an issuer and subject key pair
@@ -81,29 +91,7 @@ done:
     return result;
 }
 
-/**
- * oe_generate_attestation_certificate.
- *
- * This function generates a self-signed x.509 certificate with an embedded
- * quote from the underlying enclave.
- *
- * @param[in] subject_name a string contains an X.509 distinguished
- * name (DN) for customizing the generated certificate. This name is also used
- * as the issuer name because this is a self-signed certificate
- * See RFC5280 (https://tools.ietf.org/html/rfc5280) specification for details
- * Example value "CN=Open Enclave SDK,O=OESDK TLS,C=US"
- *
- * @param[in] private_key a private key used to sign this certificate
- * @param[in] private_key_size The size of the private_key buffer
- * @param[in] public_key a public key used as the certificate's subject key
- * @param[in] public_key_size The size of the public_key buffer.
- *
- * @param[out] output_cert a pointer to buffer pointer
- * @param[out] output_cert_size size of the buffer above
- *
- * @return OE_OK on success
- */
-oe_result_t oe_generate_attestation_certificate(
+static oe_result_t _generate_attestation_certificate(
     const unsigned char* subject_name,
     uint8_t* private_key,
     size_t private_key_size,
@@ -169,6 +157,443 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** Certificate cache:
+**
+**     Generating a certificate takes a remote report, which is slow, so the
+**     certificate of each key pair and subject name is reused until its time
+**     to live has passed. Entries are looked up by a hash of the public key
+**     and the subject name; the private key is only kept to regenerate the
+**     certificate, and never compared. The validity dates of the certificates
+**     are fixed, so they are not part of the key. Once half of the time to
+**     live has passed, the certificate is regenerated on the enclave thread
+**     pool, if the enclave has one, so that callers keep finding a fresh
+**     certificate.
+**
+**==============================================================================
+*/
+
+typedef struct _cached_cert cached_cert_t;
+
+struct _cached_cert
+{
+    /* Runs the regeneration of the certificate; must be the first field */
+    oe_thread_pool_task_t task;
+
+    /* Link in the cache, most recently used first */
+    cached_cert_t* next;
+
+    /* The hash of the public key and the subject name */
+    OE_SHA256 key;
+
+    /* Copies of the arguments, to regenerate the certificate */
+    char* subject_name;
+    uint8_t* private_key;
+    size_t private_key_size;
+    uint8_t* public_key;
+    size_t public_key_size;
+
+    uint8_t* cert;
+    size_t cert_size;
+    uint64_t created_msec;
+
+    bool is_regenerating;
+
+    /* One reference while in the cache and one while regenerating */
+    size_t refs;
+};
+
+static oe_mutex_t _cache_lock = OE_MUTEX_INITIALIZER;
+static cached_cert_t* _cache_head;
+static uint64_t _ttl_msec = CERT_DEFAULT_TTL_SECONDS * 1000;
+
+static void _free_cached_cert(cached_cert_t* entry)
+{
+    if (entry->private_key)
+    {
+        oe_secure_zero_fill(entry->private_key, entry->private_key_size);
+        oe_free(entry->private_key);
+    }
+
+    oe_free(entry->subject_name);
+    oe_free(entry->public_key);
+    oe_free(entry->cert);
+    oe_free(entry);
+}
+
+/* Drop a reference to the entry. The caller holds the lock. */
+static void _put_cached_cert(cached_cert_t* entry)
+{
+    if (--entry->refs == 0)
+        _free_cached_cert(entry);
+}
+
+/* Compute the key of the cache entry for a public key and subject name. The
+ * sizes are hashed too, so that no two pairs of arguments hash the same
+ * bytes. */
+static oe_result_t _compute_cache_key(
+    const unsigned char* subject_name,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context = {0};
+    uint64_t sizes[2] = {public_key_size, OE_UINT64_MAX};
+
+    if (subject_name)
+        sizes[1] = oe_strlen((const char*)subject_name);
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(oe_sha256_update(&context, sizes, sizeof(sizes)));
+    OE_CHECK(oe_sha256_update(&context, public_key, public_key_size));
+
+    if (subject_name)
+        OE_CHECK(oe_sha256_update(&context, subject_name, sizes[1]));
+
+    OE_CHECK(oe_sha256_final(&context, key));
+
+    result = OE_OK;
+done:
+    return result;
+}
+
+static oe_result_t _copy_cert(
+    const uint8_t* cert,
+    size_t cert_size,
+    uint8_t** output_cert,
+    size_t* output_cert_size)
+{
+    uint8_t* copy = (uint8_t*)oe_malloc(cert_size);
+
+    if (copy == NULL)
+        return OE_OUT_OF_MEMORY;
+
+    memcpy(copy, cert, cert_size);
+    *output_cert = copy;
+    *output_cert_size = cert_size;
+
+    return OE_OK;
+}
+
+/* Unlink and return the entry for the key, if any. The caller holds the
+ * lock. */
+static cached_cert_t* _unlink_cached_cert(const OE_SHA256* key)
+{
+    for (cached_cert_t** link = &_cache_head; *link; link = &(*link)->next)
+    {
+        cached_cert_t* entry = *link;
+
+        if (memcmp(&entry->key, key, sizeof(*key)) == 0)
+        {
+            *link = entry->next;
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/* Put the entry at the front of the cache, evicting the least recently used
+ * entry if the cache is full. The caller holds the lock. */
+static void _link_cached_cert(cached_cert_t* entry)
+{
+    cached_cert_t** link = &_cache_head;
+
+    entry->next = _cache_head;
+    _cache_head = entry;
+
+    for (size_t i = 0; *link; i++)
+    {
+        cached_cert_t* p = *link;
+
+        if (i < CERT_CACHE_SIZE)
+        {
+            link = &p->next;
+            continue;
+        }
+
+        *link = p->next;
+        _put_cached_cert(p);
+    }
+}
+
+static void _regenerate(oe_thread_pool_task_t* task)
+{
+    cached_cert_t* entry = (cached_cert_t*)task;
+    uint8_t* cert = NULL;
+    size_t cert_size = 0;
+    oe_result_t result;
+
+    // The key of the entry never changes, so it is read without the lock.
+    result = _generate_attestation_certificate(
+        (const unsigned char*)entry->subject_name,
+        entry->private_key,
+        entry->private_key_size,
+        entry->public_key,
+        entry->public_key_size,
+        &cert,
+        &cert_size);
+
+    oe_mutex_lock(&_cache_lock);
+
+    if (result == OE_OK)
+    {
+        oe_free(entry->cert);
+        entry->cert = cert;
+        entry->cert_size = cert_size;
+        entry->created_msec = oe_get_time();
+    }
+
+    oe_mutex_unlock(&_cache_lock);
+}
+
+/* The pool reads the task after running it, so the entry is only released
+ * once the task is finished. */
+static void _finish_regeneration(oe_thread_pool_task_t* task)
+{
+    cached_cert_t* entry = (cached_cert_t*)task;
+
+    oe_mutex_lock(&_cache_lock);
+    entry->is_regenerating = false;
+    _put_cached_cert(entry);
+    oe_mutex_unlock(&_cache_lock);
+}
+
+/* Regenerate the certificate of the entry on the thread pool, if it has a
+ * free worker. The caller holds the lock. */
+static void _start_regeneration(cached_cert_t* entry)
+{
+    entry->is_regenerating = true;
+    entry->refs++;
+    entry->task.run = _regenerate;
+    entry->task.finish = _finish_regeneration;
+
+    if (oe_thread_pool_submit(&entry->task) != OE_OK)
+    {
+        entry->is_regenerating = false;
+        entry->refs--;
+    }
+}
+
+/* Return a copy of the cached certificate for the key, or OE_NOT_FOUND if it
+ * has none that is still current. */
+static oe_result_t _get_cached_cert(
+    const OE_SHA256* key,
+    uint64_t now,
+    uint8_t** output_cert,
+    size_t* output_cert_size)
+{
+    oe_result_t result = OE_NOT_FOUND;
+    cached_cert_t* entry;
+
+    oe_mutex_lock(&_cache_lock);
+
+    entry = _unlink_cached_cert(key);
+
+    if (entry && now - entry->created_msec >= _ttl_msec)
+    {
+        _put_cached_cert(entry);
+        entry = NULL;
+    }
+
+    if (entry)
+    {
+        result = _copy_cert(
+            entry->cert, entry->cert_size, output_cert, output_cert_size);
+
+        if (now - entry->created_msec >= _ttl_msec / 2 &&
+            !entry->is_regenerating)
+            _start_regeneration(entry);
+
+        _link_cached_cert(entry);
+    }
+
+    oe_mutex_unlock(&_cache_lock);
+
+    return result;
+}
+
+/* Cache a copy of a certificate. Failures only mean it is not cached. */
+static void _cache_cert(
+    const OE_SHA256* key,
+    const unsigned char* subject_name,
+    const uint8_t* private_key,
+    size_t private_key_size,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    const uint8_t* cert,
+    size_t cert_size,
+    uint64_t now)
+{
+    cached_cert_t* entry = NULL;
+    cached_cert_t* old;
+
+    if (!(entry = (cached_cert_t*)oe_calloc(1, sizeof(cached_cert_t))))
+        return;
+
+    entry->refs = 1;
+    entry->key = *key;
+    entry->created_msec = now;
+    entry->private_key_size = private_key_size;
+    entry->public_key_size = public_key_size;
+
+    if (subject_name &&
+        !(entry->subject_name = oe_strdup((const char*)subject_name)))
+        goto done;
+
+    if (!(entry->private_key = (uint8_t*)oe_malloc(private_key_size)) ||
+        !(entry->public_key = (uint8_t*)oe_malloc(public_key_size)))
+        goto done;
+
+    memcpy(entry->private_key, private_key, private_key_size);
+    memcpy(entry->public_key, public_key, public_key_size);
+
+    if (_copy_cert(cert, cert_size, &entry->cert, &entry->cert_size) != OE_OK)
+        goto done;
+
+    oe_mutex_lock(&_cache_lock);
+
+    // Another thread may have cached a certificate for the key meanwhile.
+    old = _unlink_cached_cert(key);
+
+    if (old)
+        _put_cached_cert(old);
+
+    _link_cached_cert(entry);
+    entry = NULL;
+
+    oe_mutex_unlock(&_cache_lock);
+
+done:
+    if (entry)
+        _free_cached_cert(entry);
+}
+
+/**
+ * oe_generate_attestation_certificate.
+ *
+ * This function generates a self-signed x.509 certificate with an embedded
+ * quote from the underlying enclave. A certificate already generated for the
+ * same arguments is returned again while it is younger than the time to live
+ * set by oe_set_attestation_certificate_ttl().
+ *
+ * @param[in] subject_name a string contains an X.509 distinguished
+ * name (DN) for customizing the generated certificate. This name is also used
+ * as the issuer name because this is a self-signed certificate
+ * See RFC5280 (https://tools.ietf.org/html/rfc5280) specification for details
+ * Example value "CN=Open Enclave SDK,O=OESDK TLS,C=US"
+ *
+ * @param[in] private_key a private key used to sign this certificate
+ * @param[in] private_key_size The size of the private_key buffer
+ * @param[in] public_key a public key used as the certificate's subject key
+ * @param[in] public_key_size The size of the public_key buffer.
+ *
+ * @param[out] output_cert a pointer to buffer pointer
+ * @param[out] output_cert_size size of the buffer above
+ *
+ * @return OE_OK on success
+ */
+oe_result_t oe_generate_attestation_certificate(
+    const unsigned char* subject_name,
+    uint8_t* private_key,
+    size_t private_key_size,
+    uint8_t* public_key,
+    size_t public_key_size,
+    uint8_t** output_cert,
+    size_t* output_cert_size)
+{
+    oe_result_t result = OE_FAILURE;
+    uint64_t now = oe_get_time();
+    bool use_cache;
+    OE_SHA256 key = {0};
+
+    if (!private_key || !public_key || !output_cert || !output_cert_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&_cache_lock);
+    use_cache = _ttl_msec != 0 && now != (uint64_t)-1;
+    oe_mutex_unlock(&_cache_lock);
+
+    if (use_cache)
+        use_cache = _compute_cache_key(
+                        subject_name, public_key, public_key_size, &key) ==
+                    OE_OK;
+
+    if (use_cache &&
+        _get_cached_cert(&key, now, output_cert, output_cert_size) == OE_OK)
+    {
+        OE_TRACE_VERBOSE("reusing cached certificate");
+        result = OE_OK;
+        goto done;
+    }
+
+    OE_CHECK(_generate_attestation_certificate(
+        subject_name,
+        private_key,
+        private_key_size,
+        public_key,
+        public_key_size,
+        output_cert,
+        output_cert_size));
+
+    if (use_cache)
+        _cache_cert(
+            &key,
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size,
+            *output_cert,
+            *output_cert_size,
+            now);
+
+    result = OE_OK;
+done:
+    return result;
+}
+
+oe_result_t oe_set_attestation_certificate_ttl(uint64_t ttl_seconds)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t ttl_msec;
+
+    OE_CHECK(oe_safe_mul_u64(ttl_seconds, 1000, &ttl_msec));
+
+    oe_mutex_lock(&_cache_lock);
+    _ttl_msec = ttl_msec;
+    oe_mutex_unlock(&_cache_lock);
+
+    // Certificates older than the new time to live are dropped when they are
+    // next looked up.
+    if (ttl_msec == 0)
+        OE_CHECK(oe_rotate_attestation_certificates());
+
+    result = OE_OK;
+done:
+    return result;
+}
+
+oe_result_t oe_rotate_attestation_certificates(void)
+{
+    oe_mutex_lock(&_cache_lock);
+
+    // A certificate being regenerated is freed once that is done.
+    while (_cache_head)
+    {
+        cached_cert_t* entry = _cache_head;
+        _cache_head = entry->next;
+        _put_cached_cert(entry);
+    }
+
+    oe_mutex_unlock(&_cache_lock);
+
+    return OE_OK;
+}
+
 void oe_free_attestation_certificate(uint8_t* cert)
 {
     if (cert)
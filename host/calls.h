@@ -9,6 +9,8 @@
 #ifndef OE_HOST_CALLS_H
 #define OE_HOST_CALLS_H
 
+OE_EXTERNC_BEGIN
+
 typedef struct _ocall_table
 {
     const oe_ocall_func_t* ocalls;
@@ -19,4 +21,6 @@ extern ocall_table_t _ocall_tables[];
 
 oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave);
 
+OE_EXTERNC_END
+
 #endif /* OE_HOST_CALLS_H */
@@ -0,0 +1,450 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#endif
+
+#include <openenclave/host.h>
+#include <openenclave/internal/raise.h>
+#include "hostthread.h"
+#include "strings.h"
+
+/*
+**==============================================================================
+**
+** Enclave pool:
+**
+**     The pool keeps a stack of ready enclaves. Acquiring an enclave pops
+**     the stack, and wakes the background threads of the pool, which create
+**     enclaves until the stack is full again. The threads sleep on the
+**     signal word of the pool, which is only changed with the mutex held.
+**
+**     If the pool resets released enclaves, the enclaves handed out count
+**     toward the size of the pool, since they are expected back. They are
+**     only replaced once they are released and cannot be reset.
+**
+**==============================================================================
+*/
+
+struct _oe_enclave_pool
+{
+    oe_enclave_pool_settings_t settings;
+
+    oe_mutex mutex;
+
+    /* The ready enclaves, of which there are at most settings.size */
+    oe_enclave_t** ready;
+    size_t num_ready;
+
+    /* The number of enclaves that the background threads are creating */
+    size_t num_creating;
+
+    /* The number of enclaves handed out that are expected back */
+    size_t num_acquired;
+
+    /* Incremented to wake the background threads */
+    volatile uint32_t signal;
+    bool is_stopping;
+
+    oe_thread_t* threads;
+    size_t num_threads;
+
+    oe_enclave_pool_statistics_t statistics;
+};
+
+static uint64_t _now_usec(void)
+{
+#if defined(__linux__)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+#elif defined(_WIN32)
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+
+    return (uint64_t)(counter.QuadPart * 1000000 / frequency.QuadPart);
+#endif
+}
+
+/* Block until the signal word no longer holds the value seen. */
+static void _wait_for_signal(oe_enclave_pool_t* pool, uint32_t seen)
+{
+#if defined(__linux__)
+
+    syscall(
+        __NR_futex, &pool->signal, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+
+#elif defined(_WIN32)
+
+    WaitOnAddress((volatile void*)&pool->signal, &seen, sizeof(seen), INFINITE);
+
+#endif
+}
+
+/* Whether the pool is short of enclaves. The caller holds the mutex. */
+static bool _needs_refill(oe_enclave_pool_t* pool)
+{
+    return pool->num_ready + pool->num_creating + pool->num_acquired <
+           pool->settings.size;
+}
+
+/* Wake the background threads. The caller holds the mutex. */
+static void _signal(oe_enclave_pool_t* pool)
+{
+    pool->signal++;
+
+#if defined(__linux__)
+
+    syscall(
+        __NR_futex,
+        &pool->signal,
+        FUTEX_WAKE_PRIVATE,
+        INT_MAX,
+        NULL,
+        NULL,
+        0);
+
+#elif defined(_WIN32)
+
+    WakeByAddressAll((void*)&pool->signal);
+
+#endif
+}
+
+/* Create an enclave and account for it in the statistics. */
+static oe_result_t _create(oe_enclave_pool_t* pool, oe_enclave_t** enclave)
+{
+    const oe_enclave_pool_settings_t* settings = &pool->settings;
+    uint64_t start = _now_usec();
+    uint64_t elapsed;
+    oe_result_t result;
+
+    result = settings->create(
+        settings->path,
+        settings->type,
+        settings->flags,
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+        settings->configs,
+        settings->config_count,
+#else
+        settings->config,
+        settings->config_size,
+#endif
+        enclave);
+
+    elapsed = _now_usec() - start;
+
+    oe_mutex_lock(&pool->mutex);
+
+    if (result == OE_OK)
+    {
+        pool->statistics.enclaves_created++;
+        pool->statistics.total_create_usec += elapsed;
+
+        if (elapsed > pool->statistics.max_create_usec)
+            pool->statistics.max_create_usec = elapsed;
+    }
+    else
+    {
+        pool->statistics.create_failures++;
+    }
+
+    oe_mutex_unlock(&pool->mutex);
+
+    return result;
+}
+
+/*
+** The thread function of a background thread. The thread creates enclaves
+** while the pool is short of them. After a failure, it waits for the next
+** acquisition or release rather than retrying right away.
+**
+*/
+static void* _refill_thread(void* arg)
+{
+    oe_enclave_pool_t* pool = (oe_enclave_pool_t*)arg;
+
+    oe_mutex_lock(&pool->mutex);
+
+    while (!pool->is_stopping)
+    {
+        uint32_t seen = pool->signal;
+        oe_enclave_t* enclave = NULL;
+
+        if (!_needs_refill(pool))
+        {
+            oe_mutex_unlock(&pool->mutex);
+            _wait_for_signal(pool, seen);
+            oe_mutex_lock(&pool->mutex);
+            continue;
+        }
+
+        pool->num_creating++;
+        oe_mutex_unlock(&pool->mutex);
+
+        _create(pool, &enclave);
+
+        oe_mutex_lock(&pool->mutex);
+        pool->num_creating--;
+
+        // A released enclave may have taken the slot in the meantime
+        if (enclave && !pool->is_stopping &&
+            pool->num_ready + pool->num_acquired < pool->settings.size)
+        {
+            pool->ready[pool->num_ready++] = enclave;
+        }
+        else if (enclave)
+        {
+            oe_mutex_unlock(&pool->mutex);
+            oe_terminate_enclave(enclave);
+            oe_mutex_lock(&pool->mutex);
+        }
+        else if (!pool->is_stopping)
+        {
+            oe_mutex_unlock(&pool->mutex);
+            _wait_for_signal(pool, seen);
+            oe_mutex_lock(&pool->mutex);
+        }
+    }
+
+    oe_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+static void _free_pool(oe_enclave_pool_t* pool)
+{
+    for (size_t i = 0; i < pool->num_ready; i++)
+        oe_terminate_enclave(pool->ready[i]);
+
+    oe_mutex_destroy(&pool->mutex);
+    free((char*)pool->settings.path);
+    free(pool->ready);
+    free(pool->threads);
+    free(pool);
+}
+
+oe_result_t oe_create_enclave_pool(
+    const oe_enclave_pool_settings_t* settings,
+    oe_enclave_pool_t** pool_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_enclave_pool_t* pool = NULL;
+    oe_enclave_t* enclave = NULL;
+    size_t num_threads;
+
+    if (pool_out)
+        *pool_out = NULL;
+
+    if (!settings || !settings->create || !settings->path ||
+        settings->size == 0 || !pool_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    num_threads = settings->num_threads ? settings->num_threads : 1;
+
+    if (!(pool = (oe_enclave_pool_t*)calloc(1, sizeof(oe_enclave_pool_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    pool->settings = *settings;
+
+    if (oe_mutex_init(&pool->mutex) != 0)
+    {
+        free(pool);
+        pool = NULL;
+        OE_RAISE(OE_FAILURE);
+    }
+
+    if (!(pool->settings.path = oe_strdup(settings->path)) ||
+        !(pool->ready = calloc(settings->size, sizeof(oe_enclave_t*))) ||
+        !(pool->threads = calloc(num_threads, sizeof(oe_thread_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    // Create the first enclave here, so that a bad image fails the call
+    // instead of every background attempt.
+    OE_CHECK(_create(pool, &enclave));
+    pool->ready[pool->num_ready++] = enclave;
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        if (oe_thread_create(&pool->threads[i], _refill_thread, pool) != 0)
+            OE_RAISE(OE_THREAD_CREATE_ERROR);
+
+        pool->num_threads++;
+    }
+
+    *pool_out = pool;
+    pool = NULL;
+    result = OE_OK;
+
+done:
+    if (pool)
+        oe_terminate_enclave_pool(pool);
+
+    return result;
+}
+
+oe_result_t oe_enclave_pool_acquire(
+    oe_enclave_pool_t* pool,
+    oe_enclave_t** enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    bool hit = false;
+    bool counted = false;
+
+    if (enclave)
+        *enclave = NULL;
+
+    if (!pool || !enclave)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&pool->mutex);
+
+    if (pool->num_ready)
+    {
+        *enclave = pool->ready[--pool->num_ready];
+        pool->statistics.hits++;
+        hit = true;
+    }
+    else
+    {
+        pool->statistics.misses++;
+    }
+
+    if (pool->settings.reset)
+    {
+        pool->num_acquired++;
+        counted = true;
+    }
+
+    if (_needs_refill(pool))
+        _signal(pool);
+
+    oe_mutex_unlock(&pool->mutex);
+
+    if (!hit)
+        OE_CHECK(_create(pool, enclave));
+
+    result = OE_OK;
+
+done:
+    // An enclave that could not be created is not handed out, so the pool
+    // is refilled in its place.
+    if (result != OE_OK && counted)
+    {
+        oe_mutex_lock(&pool->mutex);
+        pool->num_acquired--;
+
+        if (_needs_refill(pool))
+            _signal(pool);
+
+        oe_mutex_unlock(&pool->mutex);
+    }
+
+    return result;
+}
+
+oe_result_t oe_enclave_pool_release(
+    oe_enclave_pool_t* pool,
+    oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    bool kept = false;
+
+    if (!pool || !enclave)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (pool->settings.reset)
+    {
+        bool is_reset =
+            pool->settings.reset(enclave, pool->settings.reset_arg) == OE_OK;
+
+        oe_mutex_lock(&pool->mutex);
+
+        if (pool->num_acquired)
+            pool->num_acquired--;
+
+        if (is_reset && !pool->is_stopping &&
+            pool->num_ready < pool->settings.size)
+        {
+            pool->ready[pool->num_ready++] = enclave;
+            pool->statistics.enclaves_reused++;
+            kept = true;
+        }
+
+        oe_mutex_unlock(&pool->mutex);
+    }
+
+    if (!kept)
+    {
+        oe_mutex_lock(&pool->mutex);
+        pool->statistics.enclaves_discarded++;
+        if (_needs_refill(pool))
+            _signal(pool);
+        oe_mutex_unlock(&pool->mutex);
+
+        OE_CHECK(oe_terminate_enclave(enclave));
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_get_enclave_pool_statistics(
+    oe_enclave_pool_t* pool,
+    oe_enclave_pool_statistics_t* statistics)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!pool || !statistics)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&pool->mutex);
+    *statistics = pool->statistics;
+    statistics->enclaves_ready = pool->num_ready;
+    oe_mutex_unlock(&pool->mutex);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_terminate_enclave_pool(oe_enclave_pool_t* pool)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!pool)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&pool->mutex);
+    pool->is_stopping = true;
+    _signal(pool);
+    oe_mutex_unlock(&pool->mutex);
+
+    for (size_t i = 0; i < pool->num_threads; i++)
+        oe_thread_join(pool->threads[i]);
+
+    _free_pool(pool);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
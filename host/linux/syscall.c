@@ -152,6 +152,118 @@ oe_off_t oe_syscall_lseek_ocall(oe_host_fd_t fd, oe_off_t offset, int whence)
     return lseek((int)fd, offset, whence);
 }
 
+ssize_t oe_syscall_pread_ocall(
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    errno = 0;
+
+    return pread((int)fd, buf, count, offset);
+}
+
+ssize_t oe_syscall_pwrite_ocall(
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    errno = 0;
+
+    return pwrite((int)fd, buf, count, offset);
+}
+
+ssize_t oe_syscall_preadv_ocall(
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size,
+    oe_off_t offset)
+{
+    struct oe_iovec* iov = (struct oe_iovec*)iov_buf;
+    ssize_t ret = -1;
+
+    OE_UNUSED(iov_buf_size);
+
+    errno = 0;
+
+    if ((!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+    {
+        errno = EINVAL;
+        goto done;
+    }
+
+    /* Handle zero data case. */
+    if (!iov || iovcnt == 0)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    _relocate_iov_bases(iov, iovcnt, (ptrdiff_t)iov_buf);
+    ret = preadv((int)fd, (struct iovec*)iov, iovcnt, offset);
+    _relocate_iov_bases(iov, iovcnt, -(ptrdiff_t)iov_buf);
+
+done:
+    return ret;
+}
+
+ssize_t oe_syscall_pwritev_ocall(
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size,
+    oe_off_t offset)
+{
+    struct oe_iovec* iov = (struct oe_iovec*)iov_buf;
+    ssize_t ret = -1;
+
+    OE_UNUSED(iov_buf_size);
+
+    errno = 0;
+
+    if ((!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+    {
+        errno = EINVAL;
+        goto done;
+    }
+
+    /* Handle zero data case. */
+    if (!iov || iovcnt == 0)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    _relocate_iov_bases(iov, iovcnt, (ptrdiff_t)iov_buf);
+    ret = pwritev((int)fd, (struct iovec*)iov, iovcnt, offset);
+
+done:
+    return ret;
+}
+
+int oe_syscall_fsync_ocall(oe_host_fd_t fd)
+{
+    errno = 0;
+
+    return fsync((int)fd);
+}
+
+int oe_syscall_fdatasync_ocall(oe_host_fd_t fd)
+{
+    errno = 0;
+
+    return fdatasync((int)fd);
+}
+
+int oe_syscall_ftruncate_ocall(oe_host_fd_t fd, oe_off_t length)
+{
+    errno = 0;
+
+    return ftruncate((int)fd, length);
+}
+
 int oe_syscall_close_ocall(oe_host_fd_t fd)
 {
     errno = 0;
@@ -178,10 +290,13 @@ uint64_t oe_syscall_opendir_ocall(const char* name)
     return (uint64_t)opendir(name);
 }
 
-int oe_syscall_readdir_ocall(uint64_t dirp, struct oe_dirent* entry)
+ssize_t oe_syscall_readdir_ocall(
+    uint64_t dirp,
+    struct oe_dirent* entries,
+    size_t count)
 {
-    int ret = -1;
-    struct dirent* ent;
+    ssize_t ret = -1;
+    size_t n = 0;
 
     errno = 0;
 
@@ -191,45 +306,58 @@ int oe_syscall_readdir_ocall(uint64_t dirp, struct oe_dirent* entry)
         goto done;
     }
 
-    if (!entry)
+    if (!entries && count)
     {
         errno = EINVAL;
         goto done;
     }
 
-    /* Perform the readdir() operation. */
+    /* Read as many entries as fit into the caller's buffer. */
+    for (n = 0; n < count; n++)
     {
+        struct oe_dirent* entry = &entries[n];
+        struct dirent* ent;
+        long pos = telldir((DIR*)dirp);
+        size_t len;
+
         errno = 0;
 
         if (!(ent = readdir((DIR*)dirp)))
         {
-            if (errno)
+            /* Report an error only if no entries were read. */
+            if (errno && n == 0)
                 goto done;
 
-            ret = 1;
-            goto done;
+            break;
         }
-    }
-
-    /* Copy the local entry to the caller's entry structure. */
-    {
-        size_t len = strlen(ent->d_name);
 
-        entry->d_ino = ent->d_ino;
-        entry->d_off = ent->d_off;
-        entry->d_type = ent->d_type;
-        entry->d_reclen = sizeof(struct oe_dirent);
+        len = strlen(ent->d_name);
 
         if (len >= sizeof(entry->d_name))
         {
+            /* Return the entries read so far, and leave this one to the next
+             * call, which reports the error and then skips it. */
+            if (n > 0 && pos != -1)
+            {
+                seekdir((DIR*)dirp, pos);
+                break;
+            }
+
             errno = ENAMETOOLONG;
             goto done;
         }
 
+        /* Copy the local entry to the caller's entry structure. */
+        memset(entry, 0, sizeof(*entry));
+        entry->d_ino = ent->d_ino;
+        entry->d_off = ent->d_off;
+        entry->d_type = ent->d_type;
+        entry->d_reclen = sizeof(struct oe_dirent);
         memcpy(entry->d_name, ent->d_name, len + 1);
     }
 
-    ret = 0;
+    errno = 0;
+    ret = (ssize_t)n;
 
 done:
     return ret;
@@ -248,6 +376,26 @@ int oe_syscall_closedir_ocall(uint64_t dirp)
     return closedir((DIR*)dirp);
 }
 
+static void _copy_stat(struct oe_stat* buf, const struct stat* st)
+{
+    buf->st_dev = st->st_dev;
+    buf->st_ino = st->st_ino;
+    buf->st_nlink = st->st_nlink;
+    buf->st_mode = st->st_mode;
+    buf->st_uid = st->st_uid;
+    buf->st_gid = st->st_gid;
+    buf->st_rdev = st->st_rdev;
+    buf->st_size = st->st_size;
+    buf->st_blksize = st->st_blksize;
+    buf->st_blocks = st->st_blocks;
+    buf->st_atim.tv_sec = st->st_atim.tv_sec;
+    buf->st_atim.tv_nsec = st->st_atim.tv_nsec;
+    buf->st_mtim.tv_sec = st->st_mtim.tv_sec;
+    buf->st_mtim.tv_nsec = st->st_mtim.tv_nsec;
+    buf->st_ctim.tv_sec = st->st_ctim.tv_sec;
+    buf->st_ctim.tv_nsec = st->st_ctim.tv_nsec;
+}
+
 int oe_syscall_stat_ocall(const char* pathname, struct oe_stat* buf)
 {
     int ret = -1;
@@ -261,23 +409,26 @@ int oe_syscall_stat_ocall(const char* pathname, struct oe_stat* buf)
     if ((ret = stat(pathname, &st)) == -1)
         goto done;
 
-    buf->st_dev = st.st_dev;
-    buf->st_dev = st.st_dev;
-    buf->st_ino = st.st_ino;
-    buf->st_nlink = st.st_nlink;
-    buf->st_mode = st.st_mode;
-    buf->st_uid = st.st_uid;
-    buf->st_gid = st.st_gid;
-    buf->st_rdev = st.st_rdev;
-    buf->st_size = st.st_size;
-    buf->st_blksize = st.st_blksize;
-    buf->st_blocks = st.st_blocks;
-    buf->st_atim.tv_sec = st.st_atim.tv_sec;
-    buf->st_atim.tv_nsec = st.st_atim.tv_nsec;
-    buf->st_mtim.tv_sec = st.st_mtim.tv_sec;
-    buf->st_mtim.tv_nsec = st.st_mtim.tv_nsec;
-    buf->st_ctim.tv_sec = st.st_ctim.tv_sec;
-    buf->st_ctim.tv_nsec = st.st_ctim.tv_nsec;
+    _copy_stat(buf, &st);
+
+done:
+    return ret;
+}
+
+int oe_syscall_fstat_ocall(oe_host_fd_t fd, struct oe_stat* buf)
+{
+    int ret = -1;
+    struct stat st;
+
+    errno = 0;
+
+    if (!buf)
+        goto done;
+
+    if ((ret = fstat((int)fd, &st)) == -1)
+        goto done;
+
+    _copy_stat(buf, &st);
 
 done:
     return ret;
@@ -1353,6 +1504,139 @@ done:
     return ret;
 }
 
+/*
+**==============================================================================
+**
+** batch:
+**
+**==============================================================================
+*/
+
+static bool _check_range(uint64_t offset, uint64_t size, size_t buf_size)
+{
+    return offset <= buf_size && size <= buf_size - offset;
+}
+
+static ssize_t _batch_op(
+    const struct oe_syscall_batch_sqe* sqe,
+    const uint8_t* in_data,
+    size_t in_size,
+    uint8_t* out_data,
+    size_t out_size)
+{
+    ssize_t ret = -1;
+    int fd = (int)sqe->fd;
+    size_t count = (size_t)sqe->data_size;
+
+    switch (sqe->opcode)
+    {
+        case OE_SYSCALL_BATCH_OP_READ:
+        case OE_SYSCALL_BATCH_OP_RECV:
+        case OE_SYSCALL_BATCH_OP_FSTAT:
+        {
+            if (!_check_range(sqe->data_offset, sqe->data_size, out_size))
+            {
+                errno = EINVAL;
+                goto done;
+            }
+            break;
+        }
+        case OE_SYSCALL_BATCH_OP_WRITE:
+        case OE_SYSCALL_BATCH_OP_SEND:
+        {
+            if (!_check_range(sqe->data_offset, sqe->data_size, in_size))
+            {
+                errno = EINVAL;
+                goto done;
+            }
+            break;
+        }
+    }
+
+    switch (sqe->opcode)
+    {
+        case OE_SYSCALL_BATCH_OP_READ:
+            ret = read(fd, out_data + sqe->data_offset, count);
+            break;
+        case OE_SYSCALL_BATCH_OP_WRITE:
+            ret = write(fd, in_data + sqe->data_offset, count);
+            break;
+        case OE_SYSCALL_BATCH_OP_RECV:
+            ret = recv(fd, out_data + sqe->data_offset, count, sqe->flags);
+            break;
+        case OE_SYSCALL_BATCH_OP_SEND:
+            ret = send(fd, in_data + sqe->data_offset, count, sqe->flags);
+            break;
+        case OE_SYSCALL_BATCH_OP_CLOSE:
+            ret = close(fd);
+            break;
+        case OE_SYSCALL_BATCH_OP_FSTAT:
+        {
+            struct stat st;
+            struct oe_stat buf;
+
+            if (count != sizeof(buf))
+            {
+                errno = EINVAL;
+                goto done;
+            }
+
+            if ((ret = fstat(fd, &st)) == 0)
+            {
+                _copy_stat(&buf, &st);
+                memcpy(out_data + sqe->data_offset, &buf, sizeof(buf));
+            }
+            break;
+        }
+        default:
+            errno = EINVAL;
+            break;
+    }
+
+done:
+    return ret;
+}
+
+int oe_syscall_batch_ocall(
+    const struct oe_syscall_batch_sqe* sqes,
+    struct oe_syscall_batch_cqe* cqes,
+    size_t count,
+    const void* in_data,
+    size_t in_size,
+    void* out_data,
+    size_t out_size)
+{
+    int ret = -1;
+
+    errno = 0;
+
+    if ((count && (!sqes || !cqes)) || (in_size && !in_data) ||
+        (out_size && !out_data))
+    {
+        errno = EINVAL;
+        goto done;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        errno = 0;
+        cqes[i].result = _batch_op(
+            &sqes[i],
+            (const uint8_t*)in_data,
+            in_size,
+            (uint8_t*)out_data,
+            out_size);
+        cqes[i].error = cqes[i].result == -1 ? errno : 0;
+        cqes[i].padding = 0;
+    }
+
+    errno = 0;
+    ret = 0;
+
+done:
+    return ret;
+}
+
 /*
 **==============================================================================
 **
@@ -0,0 +1,361 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#endif
+
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+#include "../memalign.h"
+#include "asyncio.h"
+#include "enclave.h"
+
+/* The memory is shared with the enclave, so keep it apart from host data */
+#define OE_ASYNC_IO_ALIGNMENT OE_PAGE_SIZE
+
+/* The number of times an idle worker polls the submission ring before it
+ * sleeps. The enclave cannot wake a sleeping worker without leaving the
+ * enclave, so workers nap for a short while instead of parking. */
+#define OE_ASYNC_IO_SPIN_COUNT 4096
+#define OE_ASYNC_IO_IDLE_USEC 50
+
+/* How long a worker waits for a descriptor to become ready before it checks
+ * whether the manager is stopping */
+#define OE_ASYNC_IO_POLL_MSEC 100
+
+static void _idle(void)
+{
+#if defined(__linux__)
+    usleep(OE_ASYNC_IO_IDLE_USEC);
+#elif defined(_WIN32)
+    Sleep(0);
+#endif
+}
+
+#if defined(__linux__)
+
+/* Wait until the descriptor is ready for the operation, so that a worker is
+ * never blocked in it while the manager stops. Return false if the manager
+ * stops first. An error on the descriptor counts as ready, so that the
+ * operation reports it. */
+static bool _wait_until_ready(
+    oe_async_io_manager_t* manager,
+    int fd,
+    short events)
+{
+    struct pollfd pfd = {.fd = fd, .events = events, .revents = 0};
+
+    while (!manager->is_stopping)
+    {
+        int n = poll(&pfd, 1, OE_ASYNC_IO_POLL_MSEC);
+
+        if (n > 0 || (n == -1 && errno != EINTR))
+            return true;
+    }
+
+    return false;
+}
+
+#endif
+
+static void _perform(oe_async_io_manager_t* manager, size_t index)
+{
+    oe_async_io_request_t* request = &manager->requests[index];
+    uint8_t* buf = manager->buffers + index * manager->rings->buffer_size;
+    int fd = (int)request->fd;
+    size_t count = request->count;
+    int flags = request->flags;
+    int64_t result = -1;
+    int error = 0;
+
+    if (count > manager->rings->buffer_size)
+    {
+        request->error = EINVAL;
+        request->result = -1;
+        return;
+    }
+
+#if defined(__linux__)
+
+    short events = 0;
+
+    switch (request->opcode)
+    {
+        case OE_ASYNC_IO_OP_READ:
+        case OE_ASYNC_IO_OP_RECV:
+            events = POLLIN;
+            break;
+        case OE_ASYNC_IO_OP_WRITE:
+        case OE_ASYNC_IO_OP_SEND:
+            events = POLLOUT;
+            break;
+        default:
+            break;
+    }
+
+    errno = 0;
+
+    if (events && !_wait_until_ready(manager, fd, events))
+    {
+        errno = ECANCELED;
+    }
+    else
+    {
+        switch (request->opcode)
+        {
+            case OE_ASYNC_IO_OP_READ:
+                result = read(fd, buf, count);
+                break;
+            case OE_ASYNC_IO_OP_WRITE:
+                result = write(fd, buf, count);
+                break;
+            case OE_ASYNC_IO_OP_RECV:
+                result = recv(fd, buf, count, flags);
+                break;
+            case OE_ASYNC_IO_OP_SEND:
+                result = send(fd, buf, count, flags);
+                break;
+            default:
+                errno = EINVAL;
+                break;
+        }
+    }
+
+    if (result == -1)
+        error = errno ? errno : EINVAL;
+
+#else
+
+    /* Host descriptors are handles on Windows, which needs overlapped I/O */
+    OE_UNUSED(buf);
+    OE_UNUSED(fd);
+    OE_UNUSED(flags);
+    error = ENOSYS;
+
+#endif
+
+    request->error = error;
+    request->result = result;
+}
+
+/*
+** The thread function that serves asynchronous I/O. The worker drains the
+** submission ring, performs each operation and publishes its outcome on the
+** completion ring. An idle worker polls for work up to its spin budget, and
+** then sleeps briefly between polls.
+**
+*/
+static void* _async_io_worker(void* arg)
+{
+    oe_async_io_manager_t* manager = (oe_async_io_manager_t*)arg;
+    oe_async_io_rings_t* rings = manager->rings;
+    void* batch[OE_ASYNC_IO_MAX_REQUESTS];
+    uint64_t spins = 0;
+
+    while (!manager->is_stopping)
+    {
+        size_t count = oe_switchless_ring_pop(
+            &rings->submission_ring, batch, OE_COUNTOF(batch));
+
+        if (count > 0)
+        {
+            OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+
+            for (size_t i = 0; i < count; i++)
+            {
+                uint8_t* item = (uint8_t*)batch[i];
+                uint8_t* base = (uint8_t*)manager->requests;
+                size_t offset = (size_t)(item - base);
+                size_t index = offset / sizeof(oe_async_io_request_t);
+
+                /* Drop anything that is not one of the slots */
+                if (item < base || offset % sizeof(oe_async_io_request_t) ||
+                    index >= rings->num_requests)
+                {
+                    continue;
+                }
+
+                _perform(manager, index);
+
+                OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+
+                /* Every slot fits in the ring, so this only spins if the
+                 * enclave pushed a slot twice. */
+                while (!oe_switchless_ring_push(&rings->completion_ring, item))
+                {
+                    if (manager->is_stopping)
+                        break;
+                    OE_CPU_RELAX();
+                }
+            }
+
+            spins = 0;
+            continue;
+        }
+
+        if (spins++ < OE_ASYNC_IO_SPIN_COUNT)
+        {
+            OE_CPU_RELAX();
+            continue;
+        }
+
+        _idle();
+    }
+
+    return NULL;
+}
+
+static void _free_async_io_manager(oe_async_io_manager_t* manager)
+{
+    if (manager)
+    {
+        oe_memalign_free(manager->buffers);
+        oe_memalign_free(manager->requests);
+        oe_memalign_free(manager->rings);
+        free(manager);
+    }
+}
+
+/*
+**==============================================================================
+**
+** oe_start_async_io()
+**
+**     The workers are running before the enclave learns about the rings, so
+**     that every request that the enclave submits is served.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_start_async_io(
+    oe_enclave_t* enclave,
+    size_t num_host_workers,
+    size_t buffer_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_async_io_manager_t* manager = NULL;
+    size_t num_requests = OE_ASYNC_IO_MAX_REQUESTS;
+    uint64_t result_out = 0;
+
+    if (!enclave || enclave->async_io_manager)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (num_host_workers == 0)
+        num_host_workers = 1;
+
+    if (num_host_workers > OE_ASYNC_IO_MAX_HOST_WORKERS)
+        num_host_workers = OE_ASYNC_IO_MAX_HOST_WORKERS;
+
+    if (buffer_size == 0)
+        buffer_size = OE_ASYNC_IO_DEFAULT_BUFFER_SIZE;
+
+    if (buffer_size > OE_ASYNC_IO_MAX_BUFFER_SIZE)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    manager = calloc(1, sizeof(oe_async_io_manager_t));
+    if (manager == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    manager->rings =
+        oe_memalign(OE_ASYNC_IO_ALIGNMENT, sizeof(oe_async_io_rings_t));
+    manager->requests = oe_memalign(
+        OE_ASYNC_IO_ALIGNMENT, num_requests * sizeof(oe_async_io_request_t));
+    manager->buffers =
+        oe_memalign(OE_ASYNC_IO_ALIGNMENT, num_requests * buffer_size);
+
+    if (!manager->rings || !manager->requests || !manager->buffers)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    memset(manager->requests, 0, num_requests * sizeof(oe_async_io_request_t));
+    oe_switchless_ring_init(&manager->rings->submission_ring);
+    oe_switchless_ring_init(&manager->rings->completion_ring);
+    manager->rings->requests = manager->requests;
+    manager->rings->buffers = manager->buffers;
+    manager->rings->num_requests = num_requests;
+    manager->rings->buffer_size = buffer_size;
+
+    enclave->async_io_manager = manager;
+
+    for (size_t i = 0; i < num_host_workers; i++)
+    {
+        if (oe_thread_create(
+                &manager->workers[i], _async_io_worker, manager) != 0)
+            OE_RAISE(OE_THREAD_CREATE_ERROR);
+
+        manager->num_workers++;
+    }
+
+    manager->rings->num_workers = manager->num_workers;
+
+    // Inform the enclave about the rings through an ECALL
+    OE_CHECK(oe_ecall(
+        enclave,
+        OE_ECALL_INIT_ASYNC_IO,
+        (uint64_t)manager->rings,
+        &result_out));
+    OE_CHECK((oe_result_t)result_out);
+
+    result = OE_OK;
+
+done:
+    if (result != OE_OK && enclave)
+    {
+        if (enclave->async_io_manager == manager)
+            oe_stop_async_io(enclave);
+        else
+            _free_async_io_manager(manager);
+    }
+
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_stop_async_io()
+**
+**     Must be called only once the enclave can no longer submit requests.
+**     A worker waits for its descriptor with poll() rather than in the
+**     operation, so a request on a descriptor that never becomes ready is
+**     failed with ECANCELED instead of keeping the worker from being joined.
+**     Another reader or writer of the same descriptor can still take the
+**     data between poll() and the operation, which then blocks.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_stop_async_io(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (enclave != NULL && enclave->async_io_manager != NULL)
+    {
+        oe_async_io_manager_t* manager = enclave->async_io_manager;
+
+        manager->is_stopping = true;
+        for (size_t i = 0; i < manager->num_workers; i++)
+        {
+            if (oe_thread_join(manager->workers[i]) != 0)
+                OE_RAISE(OE_THREAD_JOIN_ERROR);
+        }
+
+        enclave->async_io_manager = NULL;
+        _free_async_io_manager(manager);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
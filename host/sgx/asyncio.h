@@ -0,0 +1,34 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_ASYNCIO_H
+#define _OE_HOST_ASYNCIO_H
+
+#include <openenclave/host.h>
+#include <openenclave/internal/asyncio.h>
+#include "../hostthread.h"
+
+/* The most host workers that serve the rings of one enclave */
+#define OE_ASYNC_IO_MAX_HOST_WORKERS 8
+
+typedef struct _oe_async_io_manager
+{
+    oe_async_io_rings_t* rings;
+    oe_async_io_request_t* requests;
+    uint8_t* buffers;
+    size_t num_workers;
+    oe_thread_t workers[OE_ASYNC_IO_MAX_HOST_WORKERS];
+    volatile bool is_stopping;
+} oe_async_io_manager_t;
+
+/* Start num_host_workers host threads that serve asynchronous I/O with
+ * requests of buffer_size bytes, and hand the rings over to the enclave */
+oe_result_t oe_start_async_io(
+    oe_enclave_t* enclave,
+    size_t num_host_workers,
+    size_t buffer_size);
+
+/* Stop the host threads and free the rings, if any */
+oe_result_t oe_stop_async_io(oe_enclave_t* enclave);
+
+#endif /* _OE_HOST_ASYNCIO_H */
@@ -14,6 +14,7 @@
 #include <unistd.h>
 #elif defined(_WIN32)
 #include <Windows.h>
+#include <intrin.h>
 #else
 #error "unsupported platform"
 #endif
@@ -21,6 +22,7 @@
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/bits/safemath.h>
 #include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/debugrt/host.h>
 #include <openenclave/internal/raise.h>
@@ -94,6 +96,31 @@ ThreadBinding* GetThreadBinding()
 #endif
 }
 
+static bool _is_binding_of(oe_enclave_t* enclave, ThreadBinding* binding)
+{
+    return binding >= enclave->bindings &&
+           binding < enclave->bindings + enclave->num_bindings;
+}
+
+/*
+**==============================================================================
+**
+** oe_clear_thread_binding()
+**
+**     Forget the binding cached in the thread-specific data of the calling
+**     thread if it belongs to the given enclave, which is being terminated.
+**     Other threads only compare their cached binding against the bindings of
+**     an enclave before they use it, so a stale pointer is never dereferenced.
+**
+**==============================================================================
+*/
+
+void oe_clear_thread_binding(oe_enclave_t* enclave)
+{
+    if (_is_binding_of(enclave, GetThreadBinding()))
+        _set_thread_binding(NULL);
+}
+
 /*
 **==============================================================================
 **
@@ -324,6 +351,14 @@ oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
     result = OE_OK;
 done:
 
+    // Report the failure to callers that poll args_ptr->result instead of
+    // waiting for the OCALL to return, e.g. switchless and async callers.
+    if (result != OE_OK && args_ptr)
+    {
+        OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+        args_ptr->result = result;
+    }
+
     return result;
 }
 
@@ -339,6 +374,9 @@ static const char* oe_ocall_str(oe_func_t ocall)
         "FREE",
         "SLEEP",
         "GET_TIME",
+        "GET_OCALL_BUFFER",
+        "WAKE_SWITCHLESS_WORKER",
+        "PARK_SWITCHLESS_WORKER",
     };
     // clang-format on
 
@@ -361,6 +399,12 @@ static const char* oe_ecall_str(oe_func_t ecall)
         "CALL_ENCLAVE_FUNCTION",
         "VIRTUAL_EXCEPTION_HANDLER",
         "INIT_CONTEXT_SWITCHLESS",
+        "CONTEXT_SWITCHLESS_WORKER",
+        "INIT_TIME_PAGE",
+        "INIT_ASYNC_IO",
+        "INIT_THREAD_POOL",
+        "THREAD_POOL_WORKER",
+        "STOP_THREAD_POOL",
     };
     // clang-format on
 
@@ -409,6 +453,11 @@ static oe_result_t _handle_ocall(
     switch ((oe_func_t)func)
     {
         case OE_OCALL_CALL_HOST_FUNCTION:
+            // Switchless OCALLs fall back to this path when no host worker is
+            // running. Wake up the parked workers that the enclave asked for,
+            // so that they can pick up the calls that follow.
+            if (enclave->switchless_manager)
+                oe_wake_switchless_host_workers(enclave->switchless_manager);
             OE_CHECK(oe_handle_call_host_function(arg_in, enclave));
             break;
 
@@ -436,6 +485,21 @@ static oe_result_t _handle_ocall(
             oe_handle_get_time(arg_in, arg_out);
             break;
 
+        case OE_OCALL_GET_OCALL_BUFFER:
+            HandleGetOcallBuffer(enclave, (uint64_t)tcs, arg_out);
+            break;
+
+        case OE_OCALL_WAKE_SWITCHLESS_WORKER:
+            if (enclave->switchless_manager)
+                oe_wake_switchless_host_workers(enclave->switchless_manager);
+            break;
+
+        case OE_OCALL_PARK_SWITCHLESS_WORKER:
+            if (enclave->switchless_manager)
+                oe_park_switchless_enclave_worker(
+                    enclave->switchless_manager, arg_in);
+            break;
+
         default:
         {
             /* No function found with the number */
@@ -545,6 +609,57 @@ int __oe_dispatch_ocall(
     return 1;
 }
 
+/*
+**==============================================================================
+**
+** _claim_binding()
+**
+**     Atomically take a binding out of enclave->free_bindings. The binding
+**     cached by the calling thread is preferred, so that a thread that makes
+**     ECALLs in a row keeps entering the same TCS. Returns NULL if all of the
+**     bindings are assigned.
+**
+**==============================================================================
+*/
+
+static size_t _lowest_set_bit(uint64_t x)
+{
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzll(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return index;
+#else
+#error "unsupported"
+#endif
+}
+
+static ThreadBinding* _claim_binding(
+    oe_enclave_t* enclave,
+    ThreadBinding* cached)
+{
+    for (;;)
+    {
+        uint64_t free_bindings = enclave->free_bindings;
+        uint64_t bit;
+
+        if (free_bindings == 0)
+            return NULL;
+
+        if (cached && (free_bindings & (1ULL << (cached - enclave->bindings))))
+            bit = (uint64_t)(cached - enclave->bindings);
+        else
+            bit = _lowest_set_bit(free_bindings);
+
+        if (oe_atomic_compare_and_swap(
+                (int64_t volatile*)&enclave->free_bindings,
+                (int64_t)free_bindings,
+                (int64_t)(free_bindings & ~(1ULL << bit))))
+            return &enclave->bindings[bit];
+    }
+}
+
 /*
 **==============================================================================
 **
@@ -555,8 +670,13 @@ int __oe_dispatch_ocall(
 **         - an enclave thread context
 **
 **     If such a binding already exists, the binding's count in incremented.
-**     Else, the calling host thread is bound to the first available enclave
-**     thread context.
+**     Else, the calling host thread is bound to an available enclave thread
+**     context, preferably the one it was last bound to.
+**
+**     The binding of the calling thread is found through its thread-specific
+**     data, which still points to the last binding after it is dissolved.
+**     Only the thread that owns a binding updates it, and bindings are handed
+**     out through the enclave->free_bindings bitmap, so no lock is taken.
 **
 **     Returns the address of the thread control structure (TCS) corresponding
 **     to the enclave thread context.
@@ -566,60 +686,55 @@ int __oe_dispatch_ocall(
 
 static void* _assign_tcs(oe_enclave_t* enclave)
 {
-    void* tcs = NULL;
-    size_t i;
     oe_thread_t thread = oe_thread_self();
+    ThreadBinding* binding = GetThreadBinding();
 
-    oe_mutex_lock(&enclave->lock);
+    /* Ignore the cached binding if it belongs to another enclave */
+    if (binding && !_is_binding_of(enclave, binding))
     {
-        /* First attempt to find a busy td_t owned by this thread */
-        for (i = 0; i < enclave->num_bindings; i++)
+        binding = NULL;
+
+        /* This thread may be nested in an ECALL to this enclave through
+         * another enclave, so look for a busy binding owned by it. */
+        for (size_t i = 0; i < enclave->num_bindings; i++)
         {
-            ThreadBinding* binding = &enclave->bindings[i];
+            ThreadBinding* b = &enclave->bindings[i];
 
-            if ((binding->flags & _OE_THREAD_BUSY) && binding->thread == thread)
+            if ((b->flags & _OE_THREAD_BUSY) && b->thread == thread)
             {
-                binding->count++;
-                tcs = (void*)binding->tcs;
-
-                /* Notify the debugger runtime */
-                if (enclave->debug && enclave->debug_enclave != NULL)
-                    oe_debug_push_thread_binding(
-                        enclave->debug_enclave, (sgx_tcs_t*)tcs);
+                binding = b;
                 break;
             }
         }
+    }
 
-        /* If binding not found above, look for an available ThreadBinding */
-        if (!tcs)
-        {
-            for (i = 0; i < enclave->num_bindings; i++)
-            {
-                ThreadBinding* binding = &enclave->bindings[i];
+    if (binding && (binding->flags & _OE_THREAD_BUSY) &&
+        binding->thread == thread)
+    {
+        /* Nested ECALL: reuse the binding of the outer ECALL */
+        binding->count++;
+        _set_thread_binding(binding);
+    }
+    else
+    {
+        if (!(binding = _claim_binding(enclave, binding)))
+            return NULL;
 
-                if (!(binding->flags & _OE_THREAD_BUSY))
-                {
-                    binding->flags |= _OE_THREAD_BUSY;
-                    binding->thread = thread;
-                    binding->count = 1;
-                    tcs = (void*)binding->tcs;
-
-                    /* Set into TSD so asynchronous exceptions can get it */
-                    _set_thread_binding(binding);
-                    assert(GetThreadBinding() == binding);
-
-                    /* Notify the debugger runtime */
-                    if (enclave->debug && enclave->debug_enclave != NULL)
-                        oe_debug_push_thread_binding(
-                            enclave->debug_enclave, (sgx_tcs_t*)tcs);
-                    break;
-                }
-            }
-        }
+        binding->flags |= _OE_THREAD_BUSY;
+        binding->thread = thread;
+        binding->count = 1;
+
+        /* Set into TSD so asynchronous exceptions can get it */
+        _set_thread_binding(binding);
+        assert(GetThreadBinding() == binding);
     }
-    oe_mutex_unlock(&enclave->lock);
 
-    return tcs;
+    /* Notify the debugger runtime */
+    if (enclave->debug && enclave->debug_enclave != NULL)
+        oe_debug_push_thread_binding(
+            enclave->debug_enclave, (sgx_tcs_t*)binding->tcs);
+
+    return (void*)binding->tcs;
 }
 
 /*
@@ -628,43 +743,60 @@ static void* _assign_tcs(oe_enclave_t* enclave)
 ** _release_tcs()
 **
 **     Decrement the ThreadBinding.count field of the binding associated with
-**     the given TCS. If the field becomes zero, the binding is dissolved.
+**     the given TCS. If the field becomes zero, the binding is dissolved and
+**     returned to enclave->free_bindings, but stays cached in the
+**     thread-specific data of the calling thread.
 **
 **==============================================================================
 */
 
 static void _release_tcs(oe_enclave_t* enclave, void* tcs)
 {
-    size_t i;
+    ThreadBinding* binding = GetThreadBinding();
 
-    oe_mutex_lock(&enclave->lock);
+    if (!_is_binding_of(enclave, binding) || (void*)binding->tcs != tcs)
     {
-        for (i = 0; i < enclave->num_bindings; i++)
-        {
-            ThreadBinding* binding = &enclave->bindings[i];
+        binding = NULL;
 
-            if ((binding->flags & _OE_THREAD_BUSY) &&
-                (void*)binding->tcs == tcs)
+        for (size_t i = 0; i < enclave->num_bindings; i++)
+        {
+            if ((void*)enclave->bindings[i].tcs == tcs)
             {
-                binding->count--;
+                binding = &enclave->bindings[i];
+                break;
+            }
+        }
+    }
 
-                /* Notify the debugger runtime */
-                if (enclave->debug && enclave->debug_enclave != NULL)
-                    oe_debug_pop_thread_binding();
+    if (!binding || !(binding->flags & _OE_THREAD_BUSY))
+        return;
 
-                if (binding->count == 0)
-                {
-                    binding->flags &= (~_OE_THREAD_BUSY);
-                    binding->thread = 0;
-                    memset(&binding->event, 0, sizeof(binding->event));
-                    _set_thread_binding(NULL);
-                    assert(GetThreadBinding() == NULL);
-                }
+    binding->count--;
+
+    /* Notify the debugger runtime */
+    if (enclave->debug && enclave->debug_enclave != NULL)
+        oe_debug_pop_thread_binding();
+
+    if (binding->count == 0)
+    {
+        uint64_t bit = 1ULL << (binding - enclave->bindings);
+
+        binding->flags &= (~_OE_THREAD_BUSY);
+        binding->thread = 0;
+        memset(&binding->event, 0, sizeof(binding->event));
+
+        /* Publish the binding to the other threads */
+        for (;;)
+        {
+            uint64_t free_bindings = enclave->free_bindings;
+
+            if (oe_atomic_compare_and_swap(
+                    (int64_t volatile*)&enclave->free_bindings,
+                    (int64_t)free_bindings,
+                    (int64_t)(free_bindings | bit)))
                 break;
-            }
         }
     }
-    oe_mutex_unlock(&enclave->lock);
 }
 
 /*
@@ -741,13 +873,53 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** _post_switchless_ecall()
+**
+**  Post the function call (wrapped in args) to a free enclave worker thread
+**  by writing to its context.
+**
+**==============================================================================
+*/
+
+static oe_result_t _post_switchless_ecall(
+    oe_switchless_call_manager_t* manager,
+    oe_call_enclave_function_args_t* args)
+{
+    // Cycle through the worker contexts until we find a free worker.
+    size_t tries = manager->num_enclave_workers;
+    while (tries--)
+    {
+        oe_enclave_worker_context_t* context =
+            &manager->enclave_worker_contexts[tries];
+
+        if (context->call_arg == NULL && !context->is_stopping)
+        {
+            if (oe_atomic_compare_and_swap_ptr(
+                    (void* volatile*)&context->call_arg, NULL, args))
+            {
+                // The worker publishes PARKED before it checks call_arg
+                // once more, so either it sees the call or this sees it
+                // parked.
+                oe_unpark_switchless_enclave_worker(context);
+                return OE_OK;
+            }
+        }
+    }
+
+    return OE_CONTEXT_SWITCHLESS_ECALL_MISSED;
+}
+
 /*
 **==============================================================================
 **
 ** oe_switchless_call_enclave_function_by_table_id()
 **
 ** Switchlessly call the enclave function specified by the given table-id and
-*function-id.
+** function-id. If no enclave worker is available, fall back to a regular
+** ECALL.
 **
 **==============================================================================
 */
@@ -764,6 +936,8 @@ static oe_result_t oe_switchless_call_enclave_function_by_table_id(
 {
     oe_result_t result = OE_UNEXPECTED;
     oe_call_enclave_function_args_t args;
+    oe_switchless_call_manager_t* manager = NULL;
+    oe_result_t post_result = OE_CONTEXT_SWITCHLESS_ECALL_MISSED;
 
     /* Reject invalid parameters */
     if (!enclave)
@@ -778,12 +952,41 @@ static oe_result_t oe_switchless_call_enclave_function_by_table_id(
         args.output_buffer = output_buffer;
         args.output_buffer_size = output_buffer_size;
         args.output_bytes_written = 0;
-        args.result = OE_UNEXPECTED;
+        // Means the call hasn't been processed.
+        args.result = __OE_RESULT_MAX;
     }
 
-    /* TODO: @EMumau Perform the Switchless ECALL */
+    manager = enclave->switchless_manager;
+    if (manager != NULL && manager->num_enclave_workers > 0)
     {
-        OE_RAISE(OE_UNSUPPORTED);
+        OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+        post_result = _post_switchless_ecall(manager, &args);
+    }
+
+    /* Fall back to a regular ECALL if enclave workers are unavailable */
+    if (post_result == OE_CONTEXT_SWITCHLESS_ECALL_MISSED)
+    {
+        return oe_call_enclave_function_by_table_id(
+            enclave,
+            table_id,
+            function_id,
+            input_buffer,
+            input_buffer_size,
+            output_buffer,
+            output_buffer_size,
+            output_bytes_written);
+    }
+    OE_CHECK(post_result);
+
+    /* Wait until args.result is set by the enclave worker. */
+    while (true)
+    {
+        OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+        if (__atomic_load_n(&args.result, __ATOMIC_SEQ_CST) != __OE_RESULT_MAX)
+            break;
+
+        /* Yield to CPU */
+        OE_CPU_RELAX();
     }
 
     /* Check the result */
@@ -50,11 +50,15 @@ static char* get_fullpath(const char* path)
 #include <openenclave/internal/utils.h>
 #include <string.h>
 #include "../memalign.h"
+#include "asyncio.h"
 #include "cpuid.h"
 #include "enclave.h"
 #include "exception.h"
+#include "imagecache.h"
 #include "sgx_u.h"
 #include "sgxload.h"
+#include "threadpool.h"
+#include "timepage.h"
 
 static oe_once_type _enclave_init_once;
 
@@ -176,6 +180,11 @@ static oe_result_t _add_control_pages(
             OE_RAISE_MSG(
                 OE_FAILURE, "OE_SGX_MAX_TCS (%d) hit\n", OE_SGX_MAX_TCS);
 
+        if (enclave->num_bindings == 1)
+            enclave->tcs_stride =
+                enclave_addr + *vaddr - enclave->bindings[0].tcs;
+
+        enclave->free_bindings |= 1ULL << enclave->num_bindings;
         enclave->bindings[enclave->num_bindings++].tcs = enclave_addr + *vaddr;
     }
 
@@ -255,7 +264,7 @@ done:
     return result;
 }
 
-static oe_result_t _calculate_enclave_size(
+oe_result_t oe_sgx_calculate_enclave_size(
     size_t image_size,
     const oe_sgx_enclave_properties_t* props,
     size_t* enclave_end, /* end may be less than size due to rounding */
@@ -415,6 +424,7 @@ static oe_result_t _configure_enclave(
     uint32_t config_count)
 {
     oe_result_t result = OE_UNEXPECTED;
+    const oe_enclave_config_thread_pool_t* thread_pool_config = NULL;
 
     for (uint32_t i = 0; i < config_count; i++)
     {
@@ -427,20 +437,53 @@ static oe_result_t _configure_enclave(
                     configs[i].u.context_switchless_config->max_host_workers;
                 size_t max_enclave_workers =
                     configs[i].u.context_switchless_config->max_enclave_workers;
-
-                // Switchless ecalls are not enabled yet. Make sure the max
-                // number of enclave workers is always 0.
-                if (max_enclave_workers != 0)
+                size_t host_worker_spin_count =
+                    configs[i]
+                        .u.context_switchless_config->host_worker_spin_count;
+
+                OE_CHECK(oe_start_switchless_manager(
+                    enclave,
+                    max_host_workers,
+                    max_enclave_workers,
+                    host_worker_spin_count));
+                break;
+            }
+            // Start updating the time page that the enclave reads the time
+            // from.
+            case OE_ENCLAVE_CONFIG_TIME_PAGE:
+            {
+                OE_CHECK(oe_start_time_page(
+                    enclave, configs[i].u.time_page_config->resolution_msec));
+                break;
+            }
+            // Start the host workers that serve asynchronous I/O.
+            case OE_ENCLAVE_CONFIG_ASYNC_IO:
+            {
+                OE_CHECK(oe_start_async_io(
+                    enclave,
+                    configs[i].u.async_io_config->num_host_workers,
+                    configs[i].u.async_io_config->buffer_size));
+                break;
+            }
+            // Lend host threads to the enclave for pthread_create(), once the
+            // other settings have reserved their TCSs.
+            case OE_ENCLAVE_CONFIG_THREAD_POOL:
+            {
+                if (thread_pool_config)
                     OE_RAISE(OE_INVALID_PARAMETER);
 
-                OE_CHECK(
-                    oe_start_switchless_manager(enclave, max_host_workers));
+                thread_pool_config = configs[i].u.thread_pool_config;
                 break;
             }
             default:
                 OE_RAISE(OE_INVALID_PARAMETER);
         }
     }
+
+    if (thread_pool_config)
+        OE_CHECK(
+            oe_start_thread_pool(enclave, thread_pool_config->num_threads));
+
     result = OE_OK;
 
 done:
@@ -550,6 +593,8 @@ oe_result_t oe_sgx_build_enclave(
     size_t enclave_size = 0;
     uint64_t enclave_addr = 0;
     oe_enclave_image_t oeimage;
+    oe_enclave_image_t* image = &oeimage;
+    oe_cached_enclave_image_t* cached = NULL;
     void* ecall_data = NULL;
     size_t image_size;
     uint64_t vaddr = 0;
@@ -574,23 +619,39 @@ oe_result_t oe_sgx_build_enclave(
     if (!context || !path || !enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    /* Load the elf object */
-    if (oe_load_enclave_image(path, &oeimage) != OE_OK)
-        OE_RAISE(OE_FAILURE);
-
-    // If the **properties** parameter is non-null, use those properties.
-    // Else use the properties stored in the .oeinfo section.
-    if (properties)
+    /* Enclaves created with the properties of the image share the patched
+     * image of the cache. Images with other properties are patched for
+     * the enclave being built. */
+    if (!properties && context->type == OE_SGX_LOAD_TYPE_CREATE)
     {
-        props = *properties;
+        if (oe_get_cached_enclave_image(path, &cached) != OE_OK)
+            OE_RAISE(OE_FAILURE);
 
-        /* Update image to the properties passed in */
-        memcpy(oeimage.image_base + oeimage.oeinfo_rva, &props, sizeof(props));
+        image = &cached->image;
+        props = cached->properties;
     }
     else
     {
-        /* Copy the properties from the image */
-        memcpy(&props, oeimage.image_base + oeimage.oeinfo_rva, sizeof(props));
+        /* Load the elf object */
+        if (oe_load_enclave_image(path, &oeimage) != OE_OK)
+            OE_RAISE(OE_FAILURE);
+
+        // If the **properties** parameter is non-null, use those properties.
+        // Else use the properties stored in the .oeinfo section.
+        if (properties)
+        {
+            props = *properties;
+
+            /* Update image to the properties passed in */
+            memcpy(
+                oeimage.image_base + oeimage.oeinfo_rva, &props, sizeof(props));
+        }
+        else
+        {
+            /* Copy the properties from the image */
+            memcpy(
+                &props, oeimage.image_base + oeimage.oeinfo_rva, sizeof(props));
+        }
     }
 
     /* Validate the enclave prop_override structure */
@@ -621,12 +682,21 @@ oe_result_t oe_sgx_build_enclave(
     // Set the XFRM field
     props.config.xfrm = context->attributes.xfrm;
 
-    /* Calculate the size of image */
-    OE_CHECK(oeimage.calculate_size(&oeimage, &image_size));
+    if (cached)
+    {
+        /* The cached image is already patched for this layout */
+        enclave_end = cached->enclave_end;
+        enclave_size = cached->enclave_size;
+    }
+    else
+    {
+        /* Calculate the size of image */
+        OE_CHECK(image->calculate_size(image, &image_size));
 
-    /* Calculate the size of this enclave in memory */
-    OE_CHECK(_calculate_enclave_size(
-        image_size, &props, &enclave_end, &enclave_size));
+        /* Calculate the size of this enclave in memory */
+        OE_CHECK(oe_sgx_calculate_enclave_size(
+            image_size, &props, &enclave_end, &enclave_size));
+    }
 
     /* Perform the ECREATE operation */
     OE_CHECK(oe_sgx_create_enclave(context, enclave_size, &enclave_addr));
@@ -634,17 +704,18 @@ oe_result_t oe_sgx_build_enclave(
     /* Save the enclave base address, size, and text address */
     enclave->addr = enclave_addr;
     enclave->size = enclave_size;
-    enclave->text = enclave_addr + oeimage.text_rva;
+    enclave->text = enclave_addr + image->text_rva;
 
     /* Patch image */
-    OE_CHECK(oeimage.patch(&oeimage, enclave_end));
+    if (!cached)
+        OE_CHECK(image->patch(image, enclave_end));
 
     /* Add image to enclave */
-    OE_CHECK(oeimage.add_pages(&oeimage, context, enclave, &vaddr));
+    OE_CHECK(image->add_pages(image, context, enclave, &vaddr));
 
     /* Add data pages */
     OE_CHECK(
-        _add_data_pages(context, enclave, &props, oeimage.entry_rva, &vaddr));
+        _add_data_pages(context, enclave, &props, image->entry_rva, &vaddr));
 
     /* Ask the platform to initialize the enclave and finalize the hash */
     OE_CHECK(oe_sgx_initialize_enclave(
@@ -667,7 +738,10 @@ done:
     if (ecall_data)
         free(ecall_data);
 
-    oe_unload_enclave_image(&oeimage);
+    if (cached)
+        oe_put_cached_enclave_image(cached);
+    else
+        oe_unload_enclave_image(&oeimage);
 
     return result;
 }
@@ -841,6 +915,12 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
     if (!enclave || enclave->magic != ENCLAVE_MAGIC)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    /* Release the TCSs held by switchless enclave workers */
+    OE_CHECK(oe_stop_switchless_enclave_workers(enclave));
+
+    /* Release the TCSs held by the workers of the thread pool */
+    OE_CHECK(oe_stop_thread_pool(enclave));
+
     /* Call the enclave destructor */
     OE_CHECK(oe_ecall(enclave, OE_ECALL_DESTRUCTOR, 0, NULL));
 
@@ -860,9 +940,18 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
     /* Shut down the switchless manager */
     OE_CHECK(oe_stop_switchless_manager(enclave));
 
+    /* Stop updating the time page */
+    OE_CHECK(oe_stop_time_page(enclave));
+
+    /* Stop serving asynchronous I/O */
+    OE_CHECK(oe_stop_async_io(enclave));
+
     /* Clear the magic number */
     enclave->magic = 0;
 
+    /* Do not let the calling thread keep a binding to the freed enclave */
+    oe_clear_thread_binding(enclave);
+
     oe_mutex_lock(&enclave->lock);
     {
         /* Unmap the enclave memory region.
@@ -880,6 +969,10 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
 
 #endif
 
+        /* Free the per-TCS OCALL buffers */
+        for (size_t i = 0; i < enclave->num_bindings; i++)
+            free(enclave->ocall_buffers[i]);
+
         /* Free the path name of the enclave image file */
         free(enclave->path);
     }
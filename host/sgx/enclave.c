@@ -5,30 +5,33 @@
 #include <assert.h>
 #include <openenclave/host.h>
 
-/* Get the event object from the enclave for the given TCS */
+/* Get the event object from the enclave for the given TCS. TCS pages are laid
+ * out at a fixed stride (see _add_control_pages()), so the binding is found by
+ * its offset from the first TCS without taking enclave->lock. */
 EnclaveEvent* GetEnclaveEvent(oe_enclave_t* enclave, uint64_t tcs)
 {
-    EnclaveEvent* event = NULL;
+    uint64_t offset;
+    uint64_t index = 0;
 
-    if (!enclave)
+    if (!enclave || enclave->num_bindings == 0)
         return NULL;
 
-    oe_mutex_lock(&enclave->lock);
+    if (tcs < enclave->bindings[0].tcs)
+        return NULL;
+
+    offset = tcs - enclave->bindings[0].tcs;
+
+    if (offset != 0)
     {
-        size_t i;
-
-        for (i = 0; i < enclave->num_bindings; i++)
-        {
-            ThreadBinding* binding = &enclave->bindings[i];
-
-            if (binding->tcs == tcs)
-            {
-                event = &binding->event;
-                break;
-            }
-        }
+        if (enclave->tcs_stride == 0 || offset % enclave->tcs_stride != 0)
+            return NULL;
+
+        index = offset / enclave->tcs_stride;
     }
-    oe_mutex_unlock(&enclave->lock);
 
-    return event;
+    if (index >= enclave->num_bindings ||
+        enclave->bindings[index].tcs != tcs)
+        return NULL;
+
+    return &enclave->bindings[index].event;
 }
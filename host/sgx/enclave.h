@@ -84,6 +84,9 @@ OE_STATIC_ASSERT(OE_OFFSETOF(ThreadBinding, tcs) == ThreadBinding_tcs);
 /* Get thread data from thread-specific data (TSD) */
 ThreadBinding* GetThreadBinding(void);
 
+/* Clear the TSD of the calling thread if it refers to the given enclave */
+void oe_clear_thread_binding(oe_enclave_t* enclave);
+
 /**
  *  This structure must be kept in sync with the defines in
  *  debugger/pythonExtension/gdb_sgx_plugin.py.
@@ -128,8 +131,30 @@ struct _oe_enclave
 
     /* Manager for switchless calls */
     oe_switchless_call_manager_t* switchless_manager;
+
+    /* Per-TCS host buffers for OCALL marshalling (see OE_OCALL_BUFFER_SIZE),
+     * indexed like bindings and allocated on first use */
+    void* ocall_buffers[OE_SGX_MAX_TCS];
+
+    /* Bitmap of the bindings that are not assigned to any thread, updated
+     * atomically by _assign_tcs() and _release_tcs() */
+    volatile uint64_t free_bindings;
+
+    /* Distance between the TCS pages of consecutive bindings */
+    uint64_t tcs_stride;
+
+    /* Updater of the time page that the enclave reads (see timepage.h) */
+    struct _oe_time_page_manager* time_page_manager;
+
+    /* Host workers of asynchronous I/O (see asyncio.h) */
+    struct _oe_async_io_manager* async_io_manager;
+
+    /* Host threads lent to the enclave for pthread_create (see threadpool.h) */
+    struct _oe_thread_pool_manager* thread_pool_manager;
 };
 
+OE_STATIC_ASSERT(OE_SGX_MAX_TCS <= 64);
+
 // Static asserts for consistency with
 // debugger/pythonExtension/gdb_sgx_plugin.py
 #if defined(__linux__)
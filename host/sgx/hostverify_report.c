@@ -5,12 +5,25 @@
 #include <openenclave/bits/result.h>
 #include <openenclave/host.h>
 #include <openenclave/host_verify.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/raise.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
 
 #include "../../common/sgx/quote.h"
+#include "../hostthread.h"
 #include "sgxquoteprovider.h"
 
-oe_result_t oe_verify_remote_report(
+// The most threads that verify a batch of reports
+#define OE_VERIFY_BATCH_MAX_THREADS 64
+
+/* Verify a remote report once the quote provider is initialized. */
+static oe_result_t _verify_remote_report(
     const uint8_t* report,
     size_t report_size,
     oe_report_t* parsed_report)
@@ -25,10 +38,6 @@ oe_result_t oe_verify_remote_report(
     if (report_size == 0 || report_size > OE_MAX_REPORT_SIZE)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    // The two host side attestation API's are oe_get_report and
-    // oe_verify_report. Initialize the quote provider in both these APIs.
-    OE_CHECK(oe_initialize_quote_provider());
-
     // Ensure that the report is parseable before using the header.
     OE_CHECK(oe_parse_report(report, report_size, &oe_report));
 
@@ -48,3 +57,256 @@ oe_result_t oe_verify_remote_report(
 done:
     return result;
 }
+
+oe_result_t oe_verify_remote_report(
+    const uint8_t* report,
+    size_t report_size,
+    oe_report_t* parsed_report)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    // The two host side attestation API's are oe_get_report and
+    // oe_verify_report. Initialize the quote provider in both these APIs.
+    OE_CHECK(oe_initialize_quote_provider());
+
+    OE_CHECK(_verify_remote_report(report, report_size, parsed_report));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** Batch verification:
+**
+**     The reports of a batch are verified in three passes, each spread over
+**     a pool of threads that take reports in turn:
+**
+**         1. Get the FMSPC of each report from its PCK certificate.
+**         2. Verify the first report of each FMSPC, which fetches and caches
+**            the revocation collateral of the FMSPC.
+**         3. Verify the other reports, which find the collateral cached.
+**
+**==============================================================================
+*/
+
+typedef struct _batch_report
+{
+    uint8_t fmspc[6];
+    bool is_first;
+} batch_report_t;
+
+typedef struct _batch batch_t;
+
+typedef void (*batch_function_t)(batch_t* batch, size_t index);
+
+struct _batch
+{
+    const uint8_t* const* reports;
+    const size_t* report_sizes;
+    oe_result_t* results;
+    oe_report_t* parsed_reports;
+    batch_report_t* batch_reports;
+
+    /* The reports of the current pass, and the next one to take */
+    const size_t* indices;
+    size_t num_indices;
+    volatile uint64_t next;
+    batch_function_t function;
+};
+
+/* Get the FMSPC of the platform that produced a remote report. */
+static oe_result_t _get_report_fmspc(
+    const uint8_t* report,
+    size_t report_size,
+    uint8_t fmspc[6])
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_report_t oe_report = {0};
+    oe_report_header_t* header = (oe_report_header_t*)report;
+
+    if (report == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (report_size == 0 || report_size > OE_MAX_REPORT_SIZE)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_parse_report(report, report_size, &oe_report));
+
+    if (header->report_type != OE_REPORT_TYPE_SGX_REMOTE)
+        OE_RAISE(OE_UNSUPPORTED);
+
+    OE_CHECK(oe_get_quote_fmspc(header->report, header->report_size, fmspc));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static void _get_fmspc(batch_t* batch, size_t index)
+{
+    batch->results[index] = _get_report_fmspc(
+        batch->reports[index],
+        batch->report_sizes[index],
+        batch->batch_reports[index].fmspc);
+}
+
+static void _verify(batch_t* batch, size_t index)
+{
+    batch->results[index] = _verify_remote_report(
+        batch->reports[index],
+        batch->report_sizes[index],
+        batch->parsed_reports ? &batch->parsed_reports[index] : NULL);
+}
+
+static void* _batch_thread(void* arg)
+{
+    batch_t* batch = (batch_t*)arg;
+
+    for (;;)
+    {
+        uint64_t i = oe_atomic_increment(&batch->next) - 1;
+
+        if (i >= batch->num_indices)
+            break;
+
+        batch->function(batch, batch->indices[i]);
+    }
+
+    return NULL;
+}
+
+static size_t _get_num_processors(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return n > 0 ? (size_t)n : 1;
+#endif
+}
+
+/* Apply the function to the given reports on a pool of threads, which the
+ * calling thread joins. */
+static void _run_pass(
+    batch_t* batch,
+    batch_function_t function,
+    const size_t* indices,
+    size_t num_indices)
+{
+    oe_thread_t threads[OE_VERIFY_BATCH_MAX_THREADS];
+    size_t num_threads = _get_num_processors();
+    size_t num_started = 0;
+
+    batch->function = function;
+    batch->indices = indices;
+    batch->num_indices = num_indices;
+    batch->next = 0;
+
+    if (num_threads > num_indices)
+        num_threads = num_indices;
+
+    if (num_threads > OE_VERIFY_BATCH_MAX_THREADS)
+        num_threads = OE_VERIFY_BATCH_MAX_THREADS;
+
+    // The calling thread is one of the threads. If a thread cannot be
+    // created, the others take its share.
+    for (size_t i = 1; i < num_threads; i++)
+    {
+        if (oe_thread_create(&threads[num_started], _batch_thread, batch) != 0)
+            break;
+
+        num_started++;
+    }
+
+    _batch_thread(batch);
+
+    for (size_t i = 0; i < num_started; i++)
+        oe_thread_join(threads[i]);
+}
+
+oe_result_t oe_verify_remote_reports(
+    const uint8_t* const* reports,
+    const size_t* report_sizes,
+    size_t count,
+    oe_result_t* results,
+    oe_report_t* parsed_reports)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    batch_t batch = {0};
+    size_t* indices = NULL;
+    size_t num_first = 0;
+    size_t num_other = 0;
+
+    if (!reports || !report_sizes || !results || count == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_initialize_quote_provider());
+
+    batch.reports = reports;
+    batch.report_sizes = report_sizes;
+    batch.results = results;
+    batch.parsed_reports = parsed_reports;
+
+    if (!(batch.batch_reports = calloc(count, sizeof(batch_report_t))) ||
+        !(indices = calloc(count, sizeof(size_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (size_t i = 0; i < count; i++)
+        indices[i] = i;
+
+    _run_pass(&batch, _get_fmspc, indices, count);
+
+    // Pick the first report of each FMSPC. The first reports go to the
+    // front of the indices, and the others to the back.
+    for (size_t i = 0; i < count; i++)
+    {
+        batch_report_t* batch_report = &batch.batch_reports[i];
+
+        if (results[i] != OE_OK)
+            continue;
+
+        batch_report->is_first = true;
+
+        for (size_t j = 0; j < num_first; j++)
+        {
+            if (memcmp(
+                    batch.batch_reports[indices[j]].fmspc,
+                    batch_report->fmspc,
+                    sizeof(batch_report->fmspc)) == 0)
+            {
+                batch_report->is_first = false;
+                break;
+            }
+        }
+
+        if (batch_report->is_first)
+            indices[num_first++] = i;
+        else
+            indices[count - ++num_other] = i;
+    }
+
+    _run_pass(&batch, _verify, indices, num_first);
+    _run_pass(&batch, _verify, indices + count - num_other, num_other);
+
+    result = OE_OK;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (results[i] != OE_OK)
+            result = OE_VERIFY_FAILED;
+    }
+
+done:
+    free(batch.batch_reports);
+    free(indices);
+    return result;
+}
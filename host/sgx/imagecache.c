@@ -0,0 +1,329 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "imagecache.h"
+#include <openenclave/host.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/sgxcreate.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "../hostthread.h"
+#include "../strings.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+/*
+**==============================================================================
+**
+** Enclave image cache:
+**
+**     Building an enclave reads the whole image file, parses its headers,
+**     loads its segments and relocations, and patches the image with the
+**     layout of the enclave. All of that only depends on the file and on the
+**     properties it was signed with, so the cache keeps the patched image of
+**     recently used files, and builds of the same file only add its pages.
+**
+**     An image is keyed by its path and by the device, inode, size and
+**     modification time of the file, so that a rebuilt file is loaded again.
+**     Cached images are read-only, as concurrent builds share them.
+**
+**==============================================================================
+*/
+
+static oe_mutex _lock = OE_H_MUTEX_INITIALIZER;
+static oe_cached_enclave_image_t* _head;
+static size_t _count;
+
+typedef struct _file_key
+{
+    uint64_t device;
+    uint64_t inode;
+    uint64_t file_size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+} file_key_t;
+
+static oe_result_t _get_file_key(const char* path, file_key_t* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    struct stat st;
+
+    if (stat(path, &st) != 0)
+        OE_RAISE_NO_TRACE(OE_NOT_FOUND);
+
+    memset(key, 0, sizeof(*key));
+    key->device = (uint64_t)st.st_dev;
+    key->inode = (uint64_t)st.st_ino;
+    key->file_size = (uint64_t)st.st_size;
+    key->mtime_sec = (int64_t)st.st_mtime;
+#if defined(__linux__)
+    key->mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+#endif
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static bool _matches(
+    const oe_cached_enclave_image_t* image,
+    const char* path,
+    const file_key_t* key)
+{
+    return strcmp(image->path, path) == 0 && image->device == key->device &&
+           image->inode == key->inode && image->file_size == key->file_size &&
+           image->mtime_sec == key->mtime_sec &&
+           image->mtime_nsec == key->mtime_nsec;
+}
+
+/* Make the pages of the image read-only, or writable again before the image
+ * is freed. */
+static void _protect_image(oe_cached_enclave_image_t* image, bool read_only)
+{
+#if defined(__linux__)
+    mprotect(
+        image->image.image_base,
+        image->image.image_size,
+        read_only ? PROT_READ : PROT_READ | PROT_WRITE);
+#else
+    OE_UNUSED(image);
+    OE_UNUSED(read_only);
+#endif
+}
+
+static void _free_image(oe_cached_enclave_image_t* image)
+{
+    if (image->image.image_base)
+    {
+        _protect_image(image, false);
+        oe_unload_enclave_image(&image->image);
+    }
+
+    free(image->path);
+    free(image);
+}
+
+/* Load and patch the image, without holding the lock. */
+static oe_result_t _load_image(
+    const char* path,
+    const file_key_t* key,
+    oe_cached_enclave_image_t** image_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_cached_enclave_image_t* image = NULL;
+    oe_enclave_image_t* oeimage;
+    size_t image_size;
+
+    if (!(image = calloc(1, sizeof(oe_cached_enclave_image_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (!(image->path = oe_strdup(path)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    image->device = key->device;
+    image->inode = key->inode;
+    image->file_size = key->file_size;
+    image->mtime_sec = key->mtime_sec;
+    image->mtime_nsec = key->mtime_nsec;
+
+    oeimage = &image->image;
+    OE_CHECK(oe_load_enclave_image(path, oeimage));
+
+    memcpy(
+        &image->properties,
+        oeimage->image_base + oeimage->oeinfo_rva,
+        sizeof(image->properties));
+
+    OE_CHECK(oe_sgx_validate_enclave_properties(&image->properties, NULL));
+    OE_CHECK(oeimage->calculate_size(oeimage, &image_size));
+    OE_CHECK(oe_sgx_calculate_enclave_size(
+        image_size,
+        &image->properties,
+        &image->enclave_end,
+        &image->enclave_size));
+    OE_CHECK(oeimage->patch(oeimage, image->enclave_end));
+
+    _protect_image(image, true);
+
+    *image_out = image;
+    image = NULL;
+    result = OE_OK;
+
+done:
+    if (image)
+        _free_image(image);
+
+    return result;
+}
+
+/* Drop the reference of the cache to the image. The caller holds the lock
+ * and has unlinked the image. */
+static void _evict(oe_cached_enclave_image_t* image)
+{
+    _count--;
+
+    if (--image->refs == 0)
+        _free_image(image);
+}
+
+/* Evict the least recently used images that exceed the size of the cache.
+ * The caller holds the lock. */
+static void _trim(void)
+{
+    oe_cached_enclave_image_t** link = &_head;
+
+    for (size_t i = 0; *link; i++)
+    {
+        oe_cached_enclave_image_t* image = *link;
+
+        if (i < OE_ENCLAVE_IMAGE_CACHE_SIZE)
+        {
+            link = &image->next;
+            continue;
+        }
+
+        *link = image->next;
+        _evict(image);
+    }
+}
+
+oe_result_t oe_get_cached_enclave_image(
+    const char* path,
+    oe_cached_enclave_image_t** image_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_cached_enclave_image_t* image = NULL;
+    oe_cached_enclave_image_t* loaded = NULL;
+    file_key_t key;
+    bool locked = false;
+
+    if (image_out)
+        *image_out = NULL;
+
+    if (!path || !image_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_get_file_key(path, &key));
+
+    for (;;)
+    {
+        oe_cached_enclave_image_t** link;
+
+        oe_mutex_lock(&_lock);
+        locked = true;
+
+        /* Look for the image, evicting stale images of the same path */
+        for (link = &_head; *link;)
+        {
+            oe_cached_enclave_image_t* p = *link;
+
+            if (_matches(p, path, &key))
+            {
+                image = p;
+                *link = p->next;
+                break;
+            }
+
+            if (strcmp(p->path, path) == 0)
+            {
+                *link = p->next;
+                _evict(p);
+                continue;
+            }
+
+            link = &p->next;
+        }
+
+        /* Another thread may have cached the same file meanwhile */
+        if (!image && loaded)
+        {
+            image = loaded;
+            loaded = NULL;
+            image->refs = 1;
+            _count++;
+        }
+
+        if (image)
+            break;
+
+        oe_mutex_unlock(&_lock);
+        locked = false;
+
+        OE_CHECK(_load_image(path, &key, &loaded));
+    }
+
+    /* Move the image to the front */
+    image->next = _head;
+    _head = image;
+    image->refs++;
+    _trim();
+
+    *image_out = image;
+    result = OE_OK;
+
+done:
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    if (loaded)
+        _free_image(loaded);
+
+    return result;
+}
+
+void oe_put_cached_enclave_image(oe_cached_enclave_image_t* image)
+{
+    if (!image)
+        return;
+
+    oe_mutex_lock(&_lock);
+
+    if (--image->refs == 0)
+        _free_image(image);
+
+    oe_mutex_unlock(&_lock);
+}
+
+oe_result_t oe_preload_enclave_image(const char* path)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_cached_enclave_image_t* image = NULL;
+
+    OE_CHECK(oe_get_cached_enclave_image(path, &image));
+    oe_put_cached_enclave_image(image);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_evict_enclave_image(const char* path)
+{
+    oe_cached_enclave_image_t** link;
+
+    oe_mutex_lock(&_lock);
+
+    for (link = &_head; *link;)
+    {
+        oe_cached_enclave_image_t* image = *link;
+
+        if (path && strcmp(image->path, path) != 0)
+        {
+            link = &image->next;
+            continue;
+        }
+
+        *link = image->next;
+        _evict(image);
+    }
+
+    oe_mutex_unlock(&_lock);
+
+    return OE_OK;
+}
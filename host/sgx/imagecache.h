@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_IMAGECACHE_H
+#define _OE_HOST_IMAGECACHE_H
+
+#include <openenclave/bits/properties.h>
+#include <openenclave/internal/load.h>
+
+OE_EXTERNC_BEGIN
+
+/* The number of images that the cache holds before it evicts the least
+ * recently used one */
+#define OE_ENCLAVE_IMAGE_CACHE_SIZE 8
+
+typedef struct _oe_cached_enclave_image oe_cached_enclave_image_t;
+
+struct _oe_cached_enclave_image
+{
+    /* Link in the cache, most recently used first */
+    oe_cached_enclave_image_t* next;
+
+    /* The key: the path, and the identity and version of the file */
+    char* path;
+    uint64_t device;
+    uint64_t inode;
+    uint64_t file_size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+
+    /* The image, already patched, which must not be written to */
+    oe_enclave_image_t image;
+
+    /* The properties of the image as signed, before it was patched */
+    oe_sgx_enclave_properties_t properties;
+
+    /* The layout that the image was patched for */
+    size_t enclave_end;
+    size_t enclave_size;
+
+    /* The number of enclaves being built from the image, plus one while the
+     * image is in the cache */
+    size_t refs;
+};
+
+/* Return the cached image of the enclave file at path, loading, patching and
+ * caching it if the cache has no current image of the file. The caller builds
+ * enclaves from the image, and then releases it with
+ * oe_put_cached_enclave_image(). */
+oe_result_t oe_get_cached_enclave_image(
+    const char* path,
+    oe_cached_enclave_image_t** image);
+
+void oe_put_cached_enclave_image(oe_cached_enclave_image_t* image);
+
+/* Defined in create.c */
+oe_result_t oe_sgx_calculate_enclave_size(
+    size_t image_size,
+    const oe_sgx_enclave_properties_t* props,
+    size_t* enclave_end,
+    size_t* enclave_size);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_IMAGECACHE_H */
@@ -86,6 +86,31 @@ void HandleThreadWake(oe_enclave_t* enclave, uint64_t arg_in)
 #endif
 }
 
+void HandleGetOcallBuffer(
+    oe_enclave_t* enclave,
+    uint64_t tcs,
+    uint64_t* arg_out)
+{
+    if (!arg_out)
+        return;
+
+    *arg_out = 0;
+
+    for (size_t i = 0; i < enclave->num_bindings; i++)
+    {
+        if (enclave->bindings[i].tcs == tcs)
+        {
+            // A TCS performs one OCALL at a time, so the buffer for a given
+            // TCS is never allocated concurrently.
+            if (!enclave->ocall_buffers[i])
+                enclave->ocall_buffers[i] = calloc(1, OE_OCALL_BUFFER_SIZE);
+
+            *arg_out = (uint64_t)enclave->ocall_buffers[i];
+            break;
+        }
+    }
+}
+
 void oe_thread_wake_wait_ocall(
     oe_enclave_t* enclave,
     uint64_t waiter_tcs,
@@ -8,5 +8,9 @@
 
 void HandleThreadWait(oe_enclave_t* enclave, uint64_t arg);
 void HandleThreadWake(oe_enclave_t* enclave, uint64_t arg);
+void HandleGetOcallBuffer(
+    oe_enclave_t* enclave,
+    uint64_t tcs,
+    uint64_t* arg_out);
 
 #endif /* _OE_HOST_SGX_OCALLS_H */
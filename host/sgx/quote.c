@@ -9,6 +9,7 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sgxtypes.h>
 #include <openenclave/internal/utils.h>
+#include "../hostthread.h"
 
 #if defined(OE_USE_LIBSGX)
 #include "sgxquote.h"
@@ -164,6 +165,29 @@ done:
     return result;
 }
 
+/* The quote size only changes with the QE and its certification data, so it
+ * is kept until a quote fails to be generated. */
+static oe_mutex _quote_size_lock = OE_H_MUTEX_INITIALIZER;
+static size_t _quote_size;
+
+static void _forget_quote_size(void)
+{
+    oe_mutex_lock(&_quote_size_lock);
+    _quote_size = 0;
+    oe_mutex_unlock(&_quote_size_lock);
+}
+
+size_t sgx_get_cached_quote_size(void)
+{
+    size_t quote_size;
+
+    oe_mutex_lock(&_quote_size_lock);
+    quote_size = _quote_size;
+    oe_mutex_unlock(&_quote_size_lock);
+
+    return quote_size;
+}
+
 oe_result_t sgx_get_quote_size(size_t* quote_size)
 {
     oe_result_t result = OE_UNEXPECTED;
@@ -174,12 +198,23 @@ oe_result_t sgx_get_quote_size(size_t* quote_size)
     if (!quote_size)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    *quote_size = sgx_get_cached_quote_size();
+
+    if (*quote_size == 0)
+    {
 #if defined(OE_USE_LIBSGX)
-    result = oe_sgx_qe_get_quote_size(quote_size);
+        OE_CHECK(oe_sgx_qe_get_quote_size(quote_size));
 #else
-    result = _sgx_get_quote_size_from_aesm(NULL, quote_size);
+        OE_CHECK(_sgx_get_quote_size_from_aesm(NULL, quote_size));
 #endif
 
+        oe_mutex_lock(&_quote_size_lock);
+        _quote_size = *quote_size;
+        oe_mutex_unlock(&_quote_size_lock);
+    }
+
+    result = OE_OK;
+
 done:
     return result;
 }
@@ -230,6 +265,10 @@ oe_result_t sgx_get_quote(
         *quote_size);
 #endif
 
+    // The QE may have changed, so ask it for the size of the next quote.
+    if (result != OE_OK)
+        _forget_quote_size();
+
 done:
 
     return result;
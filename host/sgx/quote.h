@@ -18,6 +18,10 @@ OE_EXTERNC_BEGIN
 
 oe_result_t sgx_get_quote_size(size_t* quote_size);
 
+/* Return the quote size kept from the last call to sgx_get_quote_size(), or
+ * zero if it is not known. */
+size_t sgx_get_cached_quote_size(void);
+
 /*
 **==============================================================================
 **
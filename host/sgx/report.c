@@ -220,26 +220,21 @@ oe_result_t oe_get_report_v2(
     *report_buffer = NULL;
     *report_buffer_size = 0;
 
-    result = _oe_get_report_internal(
-        enclave,
-        flags,
-        opt_params,
-        opt_params_size,
-        NULL,
-        &tmp_report_buffer_size);
-    if (result != OE_BUFFER_TOO_SMALL)
+    // Guess the size of the report, so that it is usually made in one pass.
+    if (flags & OE_REPORT_FLAGS_REMOTE_ATTESTATION)
+        tmp_report_buffer_size = sgx_get_cached_quote_size();
+    else
+        tmp_report_buffer_size = sizeof(sgx_report_t);
+
+    if (tmp_report_buffer_size != 0)
     {
-        if (result == OE_OK)
+        tmp_report_buffer_size += sizeof(oe_report_header_t);
+
+        tmp_report_buffer = calloc(1, tmp_report_buffer_size);
+        if (tmp_report_buffer == NULL)
         {
-            result = OE_UNEXPECTED;
+            return OE_OUT_OF_MEMORY;
         }
-        return result;
-    }
-
-    tmp_report_buffer = calloc(1, tmp_report_buffer_size);
-    if (tmp_report_buffer == NULL)
-    {
-        return OE_OUT_OF_MEMORY;
     }
 
     result = _oe_get_report_internal(
@@ -249,6 +244,24 @@ oe_result_t oe_get_report_v2(
         opt_params_size,
         tmp_report_buffer,
         &tmp_report_buffer_size);
+    if (result == OE_BUFFER_TOO_SMALL)
+    {
+        free(tmp_report_buffer);
+
+        tmp_report_buffer = calloc(1, tmp_report_buffer_size);
+        if (tmp_report_buffer == NULL)
+        {
+            return OE_OUT_OF_MEMORY;
+        }
+
+        result = _oe_get_report_internal(
+            enclave,
+            flags,
+            opt_params,
+            opt_params_size,
+            tmp_report_buffer,
+            &tmp_report_buffer_size);
+    }
     if (result != OE_OK)
     {
         free(tmp_report_buffer);
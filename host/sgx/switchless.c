@@ -1,42 +1,240 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <string.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#endif
+
 #include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/switchless.h>
+#include <openenclave/internal/utils.h>
 #include "../calls.h"
 #include "../hostthread.h"
+#include "../memalign.h"
 #include "../ocalls.h"
 #include "enclave.h"
 
 /*
-** The thread function that handles switchless ocalls
+** Block the calling host worker until its state is no longer PARKED.
+**
+*/
+static void _park_host_worker(oe_host_worker_context_t* context)
+{
+#if defined(__linux__)
+
+    syscall(
+        __NR_futex,
+        &context->state,
+        FUTEX_WAIT_PRIVATE,
+        OE_HOST_WORKER_PARKED,
+        NULL,
+        NULL,
+        0);
+
+#elif defined(_WIN32)
+
+    uint32_t parked = OE_HOST_WORKER_PARKED;
+    WaitOnAddress(
+        (volatile void*)&context->state, &parked, sizeof(parked), INFINITE);
+
+#endif
+}
+
+static void _unpark_host_worker(oe_host_worker_context_t* context)
+{
+#if defined(__linux__)
+
+    syscall(
+        __NR_futex, &context->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+
+#elif defined(_WIN32)
+
+    WakeByAddressSingle((void*)&context->state);
+
+#endif
+}
+
+/*
+** Block the calling thread until the state of the enclave worker is no longer
+** PARKED.
+**
+*/
+static void _park_enclave_worker(oe_enclave_worker_context_t* context)
+{
+#if defined(__linux__)
+
+    syscall(
+        __NR_futex,
+        &context->state,
+        FUTEX_WAIT_PRIVATE,
+        OE_ENCLAVE_WORKER_PARKED,
+        NULL,
+        NULL,
+        0);
+
+#elif defined(_WIN32)
+
+    uint32_t parked = OE_ENCLAVE_WORKER_PARKED;
+    WaitOnAddress(
+        (volatile void*)&context->state, &parked, sizeof(parked), INFINITE);
+
+#endif
+}
+
+/*
+** Handle the OCALL of an enclave worker that ran out of its spin budget: block
+** until the host posts an ECALL to the worker or stops it. The argument comes
+** from the enclave, so it must be the context of one of the workers.
+**
+*/
+void oe_park_switchless_enclave_worker(
+    oe_switchless_call_manager_t* manager,
+    uint64_t arg)
+{
+    oe_enclave_worker_context_t* context = NULL;
+
+    for (size_t i = 0; i < manager->num_enclave_workers; i++)
+    {
+        if ((uint64_t)&manager->enclave_worker_contexts[i] == arg)
+            context = &manager->enclave_worker_contexts[i];
+    }
+
+    if (!context)
+        return;
+
+    while (context->state == OE_ENCLAVE_WORKER_PARKED &&
+           !context->is_stopping)
+        _park_enclave_worker(context);
+}
+
+/*
+** Move a parked enclave worker back to RUNNING and wake it up.
+**
+*/
+void oe_unpark_switchless_enclave_worker(oe_enclave_worker_context_t* context)
+{
+    if (!oe_atomic_compare_and_swap_32(
+            &context->state,
+            OE_ENCLAVE_WORKER_PARKED,
+            OE_ENCLAVE_WORKER_RUNNING))
+        return;
+
+#if defined(__linux__)
+
+    syscall(
+        __NR_futex, &context->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+
+#elif defined(_WIN32)
+
+    WakeByAddressSingle((void*)&context->state);
+
+#endif
+}
+
+/*
+** The thread function that handles switchless ocalls. The worker drains the
+** ring of the switchless manager in batches. An idle worker polls for work up
+** to its spin budget, and then parks itself until the enclave asks for it to
+** be woken up.
 **
 */
 static void* _switchless_ocall_worker(void* arg)
 {
     oe_host_worker_context_t* context = (oe_host_worker_context_t*)arg;
+    void* batch[OE_SWITCHLESS_HOST_WORKER_BATCH_SIZE];
+    uint64_t spins = 0;
 
     while (!context->is_stopping)
     {
-        volatile oe_call_host_function_args_t* local_call_arg = NULL;
-        if ((local_call_arg = context->call_arg) != NULL)
+        size_t count = oe_switchless_ring_pop(
+            context->ring, batch, OE_COUNTOF(batch));
+
+        if (count > 0)
+        {
+            for (size_t i = 0; i < count; i++)
+                oe_handle_call_host_function(
+                    (uint64_t)batch[i], context->enclave);
+
+            context->call_count += count;
+            spins = 0;
+            continue;
+        }
+
+        if (spins++ < context->spin_count)
         {
-            context->call_arg = NULL;
-            oe_handle_call_host_function(
-                (uint64_t)local_call_arg, context->enclave);
+            OE_CPU_RELAX();
+            continue;
         }
+
+        spins = 0;
+
+        // Count the worker as parked before publishing the PARKED state, so
+        // that the host never skips waking a worker the enclave flagged.
+        oe_atomic_increment(context->num_parked);
+
+        // Publish the PARKED state before checking for work once more. The
+        // enclave checks the states after posting a call, so either this
+        // check sees the call or the enclave sees the worker parked.
+        oe_atomic_compare_and_swap_32(
+            &context->state, OE_HOST_WORKER_RUNNING, OE_HOST_WORKER_PARKED);
+
+        if (oe_switchless_ring_is_empty(context->ring) &&
+            !context->is_stopping)
+        {
+            context->park_count++;
+
+            while (context->state == OE_HOST_WORKER_PARKED &&
+                   !context->is_stopping)
+                _park_host_worker(context);
+
+            context->wake_count++;
+        }
+
+        context->state = OE_HOST_WORKER_RUNNING;
+        oe_atomic_decrement(context->num_parked);
     }
     return NULL;
 }
 
+/*
+** The thread function that lends a host thread to the enclave for switchless
+** ecalls. The ECALL returns only once the worker has been asked to stop.
+**
+*/
+static void* _switchless_ecall_worker(void* arg)
+{
+    oe_enclave_worker_context_t* context = (oe_enclave_worker_context_t*)arg;
+    uint64_t result_out = 0;
+
+    oe_ecall(
+        context->enclave,
+        OE_ECALL_CONTEXT_SWITCHLESS_WORKER,
+        (uint64_t)context,
+        &result_out);
+
+    return NULL;
+}
+
 static oe_result_t oe_stop_worker_threads(oe_switchless_call_manager_t* manager)
 {
     oe_result_t result = OE_UNEXPECTED;
     for (size_t i = 0; i < manager->num_host_workers; i++)
     {
-        manager->host_worker_contexts[i].is_stopping = true;
+        oe_host_worker_context_t* context = &manager->host_worker_contexts[i];
+
+        context->is_stopping = true;
+        if (oe_atomic_compare_and_swap_32(
+                &context->state, OE_HOST_WORKER_PARKED, OE_HOST_WORKER_WAKING))
+            _unpark_host_worker(context);
     }
 
     for (size_t i = 0; i < manager->num_host_workers; i++)
@@ -44,6 +242,31 @@ static oe_result_t oe_stop_worker_threads(oe_switchless_call_manager_t* manager)
         if (manager->host_worker_threads[i] != (oe_thread_t)NULL)
             if (oe_thread_join(manager->host_worker_threads[i]))
                 OE_RAISE(OE_THREAD_JOIN_ERROR);
+        manager->host_worker_threads[i] = (oe_thread_t)NULL;
+    }
+
+    result = OE_OK;
+done:
+    return result;
+}
+
+static oe_result_t oe_stop_enclave_worker_threads(
+    oe_switchless_call_manager_t* manager)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    for (size_t i = 0; i < manager->num_enclave_workers; i++)
+    {
+        manager->enclave_worker_contexts[i].is_stopping = true;
+        oe_unpark_switchless_enclave_worker(
+            &manager->enclave_worker_contexts[i]);
+    }
+
+    for (size_t i = 0; i < manager->num_enclave_workers; i++)
+    {
+        if (manager->enclave_worker_threads[i] != (oe_thread_t)NULL)
+            if (oe_thread_join(manager->enclave_worker_threads[i]))
+                OE_RAISE(OE_THREAD_JOIN_ERROR);
+        manager->enclave_worker_threads[i] = (oe_thread_t)NULL;
     }
 
     result = OE_OK;
@@ -53,13 +276,18 @@ done:
 
 oe_result_t oe_start_switchless_manager(
     oe_enclave_t* enclave,
-    size_t num_host_workers)
+    size_t num_host_workers,
+    size_t num_enclave_workers,
+    size_t host_worker_spin_count)
 {
     oe_result_t result = OE_UNEXPECTED;
     uint64_t result_out = 0;
     oe_switchless_call_manager_t* manager = NULL;
+    oe_switchless_ring* ring = NULL;
     oe_host_worker_context_t* contexts = NULL;
     oe_thread_t* threads = NULL;
+    oe_enclave_worker_context_t* enclave_contexts = NULL;
+    oe_thread_t* enclave_threads = NULL;
 
     if (num_host_workers < 1 || enclave == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
@@ -74,11 +302,28 @@ oe_result_t oe_start_switchless_manager(
     if (num_host_workers > enclave->num_bindings)
         num_host_workers = (uint32_t)enclave->num_bindings;
 
+    if (host_worker_spin_count == 0)
+        host_worker_spin_count = OE_SWITCHLESS_DEFAULT_HOST_WORKER_SPIN_COUNT;
+
+    // Each enclave worker permanently occupies a thread binding. Leave at
+    // least one binding for regular ecalls, which switchless ecalls fall
+    // back to when all the enclave workers are busy.
+    if (num_enclave_workers >= enclave->num_bindings)
+        num_enclave_workers = enclave->num_bindings - 1;
+
     // Allocate memory for the manager and its arrays
     manager = calloc(1, sizeof(oe_switchless_call_manager_t));
     if (manager == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
+    // The ring is shared by the enclave and the host workers, so keep it on
+    // its own cache lines.
+    ring = oe_memalign(OE_SWITCHLESS_RING_CACHE_LINE_SIZE, sizeof(*ring));
+    if (ring == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    oe_switchless_ring_init(ring);
+
     contexts = calloc(num_host_workers, sizeof(oe_host_worker_context_t));
     if (contexts == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
@@ -87,14 +332,34 @@ oe_result_t oe_start_switchless_manager(
     if (threads == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
+    if (num_enclave_workers > 0)
+    {
+        enclave_contexts =
+            calloc(num_enclave_workers, sizeof(oe_enclave_worker_context_t));
+        if (enclave_contexts == NULL)
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        enclave_threads = calloc(num_enclave_workers, sizeof(oe_thread_t));
+        if (enclave_threads == NULL)
+            OE_RAISE(OE_OUT_OF_MEMORY);
+    }
+
+    manager->ring = ring;
     manager->num_host_workers = num_host_workers;
     manager->host_worker_contexts = contexts;
     manager->host_worker_threads = threads;
+    manager->num_enclave_workers = num_enclave_workers;
+    manager->enclave_worker_contexts = enclave_contexts;
+    manager->enclave_worker_threads = enclave_threads;
 
     // Start the worker threads, and assign each one a private context.
     for (size_t i = 0; i < num_host_workers; i++)
     {
+        manager->host_worker_contexts[i].ring = ring;
         manager->host_worker_contexts[i].enclave = enclave;
+        manager->host_worker_contexts[i].num_parked =
+            &manager->num_parked_host_workers;
+        manager->host_worker_contexts[i].spin_count = host_worker_spin_count;
         if (oe_thread_create(
                 &manager->host_worker_threads[i],
                 _switchless_ocall_worker,
@@ -116,8 +381,105 @@ oe_result_t oe_start_switchless_manager(
         &result_out));
     OE_CHECK((oe_result_t)result_out);
 
+    // Start the enclave workers last, since each of them enters the enclave
+    // and stays there until the manager is stopped.
+    for (size_t i = 0; i < num_enclave_workers; i++)
+    {
+        manager->enclave_worker_contexts[i].enclave = enclave;
+        if (oe_thread_create(
+                &manager->enclave_worker_threads[i],
+                _switchless_ecall_worker,
+                &manager->enclave_worker_contexts[i]) != 0)
+        {
+            oe_stop_enclave_worker_threads(manager);
+            OE_RAISE(OE_THREAD_CREATE_ERROR);
+        }
+    }
+
     result = OE_OK;
 
+done:
+    if (result != OE_OK && enclave && enclave->switchless_manager != manager)
+    {
+        free(enclave_threads);
+        free(enclave_contexts);
+        free(threads);
+        free(contexts);
+        oe_memalign_free(ring);
+        free(manager);
+    }
+
+    return result;
+}
+
+/*
+** Wake up the host workers that the enclave asked to be woken up. This is
+** called on the regular OCALL path, which switchless OCALLs fall back to when
+** no host worker is running. Unless a worker is parked, which is rare while
+** switchless OCALLs are busy, this costs a single load.
+**
+*/
+void oe_wake_switchless_host_workers(oe_switchless_call_manager_t* manager)
+{
+    if (manager->num_parked_host_workers == 0)
+        return;
+
+    for (size_t i = 0; i < manager->num_host_workers; i++)
+    {
+        oe_host_worker_context_t* context = &manager->host_worker_contexts[i];
+
+        if (context->state == OE_HOST_WORKER_WAKING)
+            _unpark_host_worker(context);
+    }
+}
+
+oe_result_t oe_get_switchless_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_statistics_t* statistics)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_switchless_call_manager_t* manager = NULL;
+
+    if (enclave == NULL || statistics == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if ((manager = enclave->switchless_manager) == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    memset(statistics, 0, sizeof(*statistics));
+
+    for (size_t i = 0; i < manager->num_host_workers; i++)
+    {
+        statistics->host_worker_parks +=
+            manager->host_worker_contexts[i].park_count;
+        statistics->host_worker_wakes +=
+            manager->host_worker_contexts[i].wake_count;
+        statistics->host_worker_calls +=
+            manager->host_worker_contexts[i].call_count;
+    }
+
+    for (size_t i = 0; i < manager->num_enclave_workers; i++)
+    {
+        statistics->enclave_worker_parks +=
+            manager->enclave_worker_contexts[i].park_count;
+        statistics->enclave_worker_calls +=
+            manager->enclave_worker_contexts[i].call_count;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_stop_switchless_enclave_workers(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    if (enclave != NULL && enclave->switchless_manager != NULL)
+    {
+        OE_CHECK(oe_stop_enclave_worker_threads(enclave->switchless_manager));
+    }
+    result = OE_OK;
 done:
     return result;
 }
@@ -127,7 +489,18 @@ oe_result_t oe_stop_switchless_manager(oe_enclave_t* enclave)
     oe_result_t result = OE_UNEXPECTED;
     if (enclave != NULL && enclave->switchless_manager != NULL)
     {
-        OE_CHECK(oe_stop_worker_threads(enclave->switchless_manager));
+        oe_switchless_call_manager_t* manager = enclave->switchless_manager;
+
+        OE_CHECK(oe_stop_enclave_worker_threads(manager));
+        OE_CHECK(oe_stop_worker_threads(manager));
+
+        enclave->switchless_manager = NULL;
+        free(manager->enclave_worker_threads);
+        free(manager->enclave_worker_contexts);
+        free(manager->host_worker_threads);
+        free(manager->host_worker_contexts);
+        oe_memalign_free(manager->ring);
+        free(manager);
     }
     result = OE_OK;
 done:
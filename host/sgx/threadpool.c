@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "threadpool.h"
+#include <openenclave/bits/safemath.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/switchless.h>
+#include <stdlib.h>
+#include "../calls.h"
+#include "enclave.h"
+
+/*
+** The thread function of a worker. The ECALL returns only once the pool has
+** been stopped.
+**
+*/
+static void* _thread_pool_worker(void* arg)
+{
+    oe_thread_pool_manager_t* manager = (oe_thread_pool_manager_t*)arg;
+    uint64_t result_out = 0;
+
+    oe_ecall(
+        manager->enclave, OE_ECALL_THREAD_POOL_WORKER, 0, &result_out);
+
+    return NULL;
+}
+
+oe_result_t oe_start_thread_pool(oe_enclave_t* enclave, size_t num_threads)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_thread_pool_manager_t* manager = NULL;
+    uint64_t result_out = 0;
+    size_t num_reserved = 1;
+    size_t num_available;
+
+    if (!enclave || enclave->thread_pool_manager)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Each worker permanently occupies a thread binding. Leave at least one
+    // binding for regular ecalls, including the one that stops the pool,
+    // besides the bindings of the switchless enclave workers.
+    if (enclave->switchless_manager)
+        OE_CHECK(oe_safe_add_sizet(
+            num_reserved,
+            enclave->switchless_manager->num_enclave_workers,
+            &num_reserved));
+
+    if (num_reserved >= enclave->num_bindings)
+        OE_RAISE(OE_OUT_OF_THREADS);
+
+    num_available = enclave->num_bindings - num_reserved;
+
+    if (num_threads == 0 || num_threads > num_available)
+        num_threads = num_available;
+
+    manager = calloc(1, sizeof(oe_thread_pool_manager_t));
+    if (manager == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    manager->enclave = enclave;
+
+    // Tell the enclave how many workers to expect before any of them enters,
+    // so that the enclave can create threads as soon as it is created.
+    OE_CHECK(oe_ecall(
+        enclave, OE_ECALL_INIT_THREAD_POOL, num_threads, &result_out));
+    OE_CHECK((oe_result_t)result_out);
+
+    enclave->thread_pool_manager = manager;
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        if (oe_thread_create(
+                &manager->workers[i], _thread_pool_worker, manager) != 0)
+            OE_RAISE(OE_THREAD_CREATE_ERROR);
+
+        manager->num_workers++;
+    }
+
+    result = OE_OK;
+
+done:
+    if (result != OE_OK && enclave)
+    {
+        if (enclave->thread_pool_manager == manager)
+            oe_stop_thread_pool(enclave);
+        else
+            free(manager);
+    }
+
+    return result;
+}
+
+oe_result_t oe_stop_thread_pool(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (enclave != NULL && enclave->thread_pool_manager != NULL)
+    {
+        oe_thread_pool_manager_t* manager = enclave->thread_pool_manager;
+        uint64_t result_out = 0;
+
+        OE_CHECK(oe_ecall(
+            enclave, OE_ECALL_STOP_THREAD_POOL, 0, &result_out));
+        OE_CHECK((oe_result_t)result_out);
+
+        for (size_t i = 0; i < manager->num_workers; i++)
+        {
+            if (oe_thread_join(manager->workers[i]))
+                OE_RAISE(OE_THREAD_JOIN_ERROR);
+        }
+
+        enclave->thread_pool_manager = NULL;
+        free(manager);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
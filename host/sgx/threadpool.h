@@ -0,0 +1,27 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_THREADPOOL_H
+#define _OE_HOST_THREADPOOL_H
+
+#include <openenclave/bits/properties.h>
+#include <openenclave/host.h>
+#include "../hostthread.h"
+
+typedef struct _oe_thread_pool_manager
+{
+    oe_enclave_t* enclave;
+    size_t num_workers;
+    oe_thread_t workers[OE_SGX_MAX_TCS];
+} oe_thread_pool_manager_t;
+
+/* Lend num_threads host threads to the enclave, each of which enters the
+ * enclave and runs the threads that the enclave creates until the pool is
+ * stopped. A value of 0 lends every TCS but one. */
+oe_result_t oe_start_thread_pool(oe_enclave_t* enclave, size_t num_threads);
+
+/* Ask the workers to leave the enclave once their current thread returns,
+ * and join them */
+oe_result_t oe_stop_thread_pool(oe_enclave_t* enclave);
+
+#endif /* _OE_HOST_THREADPOOL_H */
@@ -0,0 +1,143 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "timepage.h"
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+#include <stdlib.h>
+#include "../memalign.h"
+#include "../ocalls.h"
+#include "enclave.h"
+
+/* The page is shared with the enclave, so keep it apart from host data */
+#define OE_TIME_PAGE_ALIGNMENT OE_PAGE_SIZE
+
+static void _update_time_page(oe_time_page_t* page)
+{
+    uint64_t time = 0;
+
+    oe_handle_get_time(0, &time);
+
+    /* Leave the previous time in place if the clock could not be read */
+    if (time != 0)
+    {
+        OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+        page->time_msec = time;
+    }
+}
+
+static void* _time_page_thread(void* arg)
+{
+    oe_time_page_manager_t* manager = (oe_time_page_manager_t*)arg;
+
+    while (!manager->is_stopping)
+    {
+        oe_handle_sleep(manager->page->resolution_msec);
+        _update_time_page(manager->page);
+    }
+
+    return NULL;
+}
+
+static void _free_time_page_manager(oe_time_page_manager_t* manager)
+{
+    if (manager)
+    {
+        oe_memalign_free(manager->page);
+        free(manager);
+    }
+}
+
+/*
+**==============================================================================
+**
+** oe_start_time_page()
+**
+**     The page is filled in before the enclave learns about it, so that the
+**     enclave never has to fall back to an OCALL once the page is set up.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_start_time_page(oe_enclave_t* enclave, uint64_t resolution_msec)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_time_page_manager_t* manager = NULL;
+    uint64_t result_out = 0;
+
+    if (!enclave || enclave->time_page_manager)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    manager = calloc(1, sizeof(oe_time_page_manager_t));
+    if (manager == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    manager->page =
+        oe_memalign(OE_TIME_PAGE_ALIGNMENT, sizeof(oe_time_page_t));
+    if (manager->page == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    manager->page->time_msec = 0;
+    manager->page->resolution_msec = resolution_msec ? resolution_msec : 1;
+    _update_time_page(manager->page);
+
+    if (oe_thread_create(&manager->thread, _time_page_thread, manager) != 0)
+        OE_RAISE(OE_THREAD_CREATE_ERROR);
+
+    enclave->time_page_manager = manager;
+
+    // Inform the enclave about the time page through an ECALL
+    OE_CHECK(oe_ecall(
+        enclave,
+        OE_ECALL_INIT_TIME_PAGE,
+        (uint64_t)manager->page,
+        &result_out));
+    OE_CHECK((oe_result_t)result_out);
+
+    result = OE_OK;
+
+done:
+    if (result != OE_OK && enclave)
+    {
+        if (enclave->time_page_manager == manager)
+            oe_stop_time_page(enclave);
+        else
+            _free_time_page_manager(manager);
+    }
+
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_stop_time_page()
+**
+**     Must be called only once the enclave can no longer read the page.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_stop_time_page(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (enclave != NULL && enclave->time_page_manager != NULL)
+    {
+        oe_time_page_manager_t* manager = enclave->time_page_manager;
+
+        manager->is_stopping = true;
+        if (oe_thread_join(manager->thread) != 0)
+            OE_RAISE(OE_THREAD_JOIN_ERROR);
+
+        enclave->time_page_manager = NULL;
+        _free_time_page_manager(manager);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_TIMEPAGE_H
+#define _OE_HOST_TIMEPAGE_H
+
+#include <openenclave/host.h>
+#include <openenclave/internal/time.h>
+#include "../hostthread.h"
+
+typedef struct _oe_time_page_manager
+{
+    oe_time_page_t* page;
+    oe_thread_t thread;
+    volatile bool is_stopping;
+} oe_time_page_manager_t;
+
+/* Start the host thread that updates the time page of the enclave every
+ * resolution_msec milliseconds, and hand the page over to the enclave */
+oe_result_t oe_start_time_page(oe_enclave_t* enclave, uint64_t resolution_msec);
+
+/* Stop the host thread and free the time page, if any */
+oe_result_t oe_stop_time_page(oe_enclave_t* enclave);
+
+#endif /* _OE_HOST_TIMEPAGE_H */
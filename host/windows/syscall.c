@@ -208,6 +208,59 @@ oe_off_t oe_syscall_lseek_ocall(oe_host_fd_t fd, oe_off_t offset, int whence)
     PANIC;
 }
 
+ssize_t oe_syscall_pread_ocall(
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    PANIC;
+}
+
+ssize_t oe_syscall_pwrite_ocall(
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    PANIC;
+}
+
+ssize_t oe_syscall_preadv_ocall(
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size,
+    oe_off_t offset)
+{
+    PANIC;
+}
+
+ssize_t oe_syscall_pwritev_ocall(
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size,
+    oe_off_t offset)
+{
+    PANIC;
+}
+
+int oe_syscall_fsync_ocall(oe_host_fd_t fd)
+{
+    PANIC;
+}
+
+int oe_syscall_fdatasync_ocall(oe_host_fd_t fd)
+{
+    PANIC;
+}
+
+int oe_syscall_ftruncate_ocall(oe_host_fd_t fd, oe_off_t length)
+{
+    PANIC;
+}
+
 int oe_syscall_close_ocall(oe_host_fd_t fd)
 {
     return _close(fd);
@@ -249,7 +302,10 @@ uint64_t oe_syscall_opendir_ocall(const char* pathname)
     PANIC;
 }
 
-int oe_syscall_readdir_ocall(uint64_t dirp, struct oe_dirent* entry)
+ssize_t oe_syscall_readdir_ocall(
+    uint64_t dirp,
+    struct oe_dirent* entries,
+    size_t count)
 {
     PANIC;
 }
@@ -269,6 +325,11 @@ int oe_syscall_stat_ocall(const char* pathname, struct oe_stat* buf)
     PANIC;
 }
 
+int oe_syscall_fstat_ocall(oe_host_fd_t fd, struct oe_stat* buf)
+{
+    PANIC;
+}
+
 int oe_syscall_access_ocall(const char* pathname, int mode)
 {
     PANIC;
@@ -713,6 +774,18 @@ int oe_syscall_getgroups_ocall(size_t size, unsigned int* list)
     PANIC;
 }
 
+int oe_syscall_batch_ocall(
+    const struct oe_syscall_batch_sqe* sqes,
+    struct oe_syscall_batch_cqe* cqes,
+    size_t count,
+    const void* in_data,
+    size_t in_size,
+    void* out_data,
+    size_t out_size)
+{
+    PANIC;
+}
+
 /*
 **==============================================================================
 **
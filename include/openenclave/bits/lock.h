@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+/**
+ * @file lock.h
+ *
+ * This file defines functions that tune and observe the contention handling
+ * of the enclave synchronization primitives.
+ *
+ */
+#ifndef _OE_BITS_LOCK_H
+#define _OE_BITS_LOCK_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/**
+ * The default number of times a thread polls a contended mutex, readers-writer
+ * lock or condition variable before it asks the host to park it.
+ */
+#define OE_LOCK_DEFAULT_SPIN_COUNT 128
+
+/**
+ * Set the number of times a thread polls a contended mutex, readers-writer
+ * lock or condition variable before it asks the host to park it.
+ *
+ * Spinning avoids the cost of exiting and re-entering the enclave for short
+ * critical sections, at the expense of CPU time. A count of 0 disables
+ * spinning.
+ *
+ * @param spin_count The number of polls, OE_LOCK_DEFAULT_SPIN_COUNT by default.
+ */
+void oe_set_lock_spin_count(uint32_t spin_count);
+
+/**
+ * Contention counters of the enclave synchronization primitives.
+ */
+typedef struct _oe_lock_statistics
+{
+    /** Contended mutex locks that were acquired while spinning. */
+    uint64_t mutex_spins;
+    /** Times a thread was parked on a mutex. */
+    uint64_t mutex_parks;
+    /** Contended r/w locks that were acquired while spinning. */
+    uint64_t rwlock_spins;
+    /** Times a thread was parked on a r/w lock. */
+    uint64_t rwlock_parks;
+    /** Condition waits that were signaled while spinning. */
+    uint64_t cond_spins;
+    /** Times a thread was parked on a condition variable. */
+    uint64_t cond_parks;
+} oe_lock_statistics_t;
+
+/**
+ * Get the contention counters of the enclave synchronization primitives.
+ *
+ * The counters are enclave-wide and accumulate from the creation of the
+ * enclave.
+ *
+ * @param statistics Receives the counters.
+ *
+ * @return OE_OK the operation was successful
+ * @return OE_INVALID_PARAMETER one or more parameters is invalid
+ */
+oe_result_t oe_get_lock_statistics(oe_lock_statistics_t* statistics);
+
+OE_EXTERNC_END
+
+#endif /* _OE_BITS_LOCK_H */
@@ -0,0 +1,105 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+/**
+ * @file parallel.h
+ *
+ * This file defines functions that spread a loop across the enclave thread
+ * pool.
+ *
+ */
+#ifndef _OE_BITS_PARALLEL_H
+#define _OE_BITS_PARALLEL_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Body of a loop run by oe_parallel_for().
+ *
+ * @param begin The first index of the subrange to run.
+ * @param end One past the last index of the subrange to run.
+ * @param arg The argument passed to oe_parallel_for().
+ */
+typedef void (*oe_parallel_for_function_t)(size_t begin, size_t end, void* arg);
+
+/**
+ * Run a loop over a range of indices on the enclave thread pool.
+ *
+ * This function splits the range [begin, end) into subranges and calls
+ * **function** once for each of them, on the calling thread and on the idle
+ * workers of the enclave thread pool. Each index is passed to exactly one
+ * call. The subranges are not run in any particular order, and calls may run
+ * concurrently.
+ *
+ * Each participating thread keeps a deque of subranges. A thread halves the
+ * subrange it takes until no more than **grain** indices are left, pushing
+ * the other halves to its deque, and a thread whose deque is empty steals the
+ * largest subrange from the deque of another thread.
+ *
+ * Without a thread pool, or when every worker is busy, the calling thread runs
+ * the whole loop by itself. The function returns when all calls have
+ * returned. It may be called from inside **function**.
+ *
+ * @param begin The first index of the range.
+ * @param end One past the last index of the range.
+ * @param grain The largest number of indices to pass to a single call, or 0
+ *        to let the function choose.
+ * @param function The body of the loop.
+ * @param arg The argument to pass to each call of **function**.
+ *
+ * @retval OE_OK All indices were run.
+ * @retval OE_INVALID_PARAMETER **function** is null or **end** is less than
+ *         **begin**.
+ * @retval OE_OUT_OF_MEMORY The deques could not be allocated.
+ */
+oe_result_t oe_parallel_for(
+    size_t begin,
+    size_t end,
+    size_t grain,
+    oe_parallel_for_function_t function,
+    void* arg);
+
+OE_EXTERNC_END
+
+#ifdef __cplusplus
+
+namespace oe
+{
+/**
+ * Run a loop over a range of indices on the enclave thread pool.
+ *
+ * This is a wrapper of oe_parallel_for() that accepts any callable object,
+ * such as a lambda, that takes the subrange as two size_t arguments. The
+ * callable object must not throw.
+ */
+template <typename Function>
+oe_result_t parallel_for(
+    size_t begin,
+    size_t end,
+    size_t grain,
+    const Function& function)
+{
+    struct trampoline
+    {
+        static void call(size_t first, size_t last, void* arg)
+        {
+            (*static_cast<const Function*>(arg))(first, last);
+        }
+    };
+
+    return oe_parallel_for(
+        begin,
+        end,
+        grain,
+        trampoline::call,
+        const_cast<void*>(static_cast<const void*>(&function)));
+}
+} // namespace oe
+
+#endif /* __cplusplus */
+
+#endif /* _OE_BITS_PARALLEL_H */
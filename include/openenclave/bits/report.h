@@ -136,6 +136,48 @@ typedef struct _oe_report
 } oe_report_t;
 /**< typedef struct _oe_report oe_report_t*/
 
+/**
+ * Statistics of the cache of the collateral used to verify remote reports:
+ * the certificate revocation lists, their issuer chains and the TCB info of
+ * the platforms whose reports were verified, the PCK certificate chains of
+ * the reports, and the identity of the quoting enclave.
+ */
+typedef struct _oe_collateral_cache_statistics
+{
+    /** The number of verifications that used cached collateral. */
+    uint64_t hits;
+
+    /** The number of verifications that fetched the collateral. */
+    uint64_t misses;
+
+    /** The number of entries dropped because their collateral expired. */
+    uint64_t expired;
+
+    /** The number of entries dropped to make room for newer ones. */
+    uint64_t evicted;
+
+    /** The number of platforms whose collateral is in the cache. */
+    uint64_t entries;
+
+    /** The number of verifications that used a cached PCK certificate chain.
+     */
+    uint64_t pck_chain_hits;
+
+    /** The number of verifications that parsed the PCK certificate chain. */
+    uint64_t pck_chain_misses;
+
+    /** The number of PCK certificate chains in the cache. */
+    uint64_t pck_chain_entries;
+
+    /** The number of verifications that used the cached QE identity. */
+    uint64_t qe_identity_hits;
+
+    /** The number of verifications that fetched the QE identity. */
+    uint64_t qe_identity_misses;
+} oe_collateral_cache_statistics_t;
+/**< typedef struct _oe_collateral_cache_statistics
+ * oe_collateral_cache_statistics_t*/
+
 OE_EXTERNC_END
 
 #endif /* _OE_BITS_REPORT_H */
@@ -329,6 +329,11 @@ typedef enum _oe_result
      */
     OE_THREAD_JOIN_ERROR,
 
+    /**
+     * Failed to post a switchless call to enclave workers
+     */
+    OE_CONTEXT_SWITCHLESS_ECALL_MISSED,
+
     __OE_RESULT_MAX = OE_ENUM_MAX,
 } oe_result_t;
 /**< typedef enum _oe_result oe_result_t*/
@@ -139,6 +139,13 @@ typedef enum _oe_enclave_type
  */
 typedef struct _oe_enclave oe_enclave_t;
 
+/**
+ * This is an opaque handle to an asynchronous OCALL, returned by the
+ * oeedger8r-generated wrapper of an untrusted function marked **async**.
+ * A value of 0 never refers to an OCALL.
+ */
+typedef uint64_t oe_async_ocall_t;
+
 /**
  * This enumeration type defines the policy used to derive a seal key.
  * This definition is shared by the enclave and the host.
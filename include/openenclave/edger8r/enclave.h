@@ -127,6 +127,9 @@ void* oe_allocate_ocall_buffer(size_t size);
 /**
  * Free the buffer allocated for ocalls.
  *
+ * Buffers allocated on the same thread must be freed in the reverse order of
+ * their allocation.
+ *
  * @param buffer The buffer allocated via oe_allocate_ocall_buffer.
  */
 void oe_free_ocall_buffer(void* buffer);
@@ -150,6 +153,56 @@ void* oe_allocate_switchless_ocall_buffer(size_t size);
  */
 void oe_free_switchless_ocall_buffer(void* buffer);
 
+/**
+ * Perform a high-level enclave function call (OCALL) without waiting for it.
+ *
+ * Post the call to the switchless host worker threads and return as soon as
+ * it has been posted. If no host worker can take the call, it is made as a
+ * regular OCALL instead. The buffers must be allocated with
+ * oe_allocate_async_ocall_buffer(), and are owned by the OCALL afterwards,
+ * even if this function fails.
+ *
+ * @param function_id The id of the host function that will be called.
+ * @param input_buffer Buffer containing inputs data.
+ * @param input_buffer_size Size of the input data buffer.
+ * @param output_buffer Buffer where the outputs of the host function are
+ * written to.
+ * @param output_buffer_size Size of the output buffer.
+ * @param handle Receives the handle to wait on the OCALL with. If NULL, the
+ * OCALL cannot be waited on and is released when it completes.
+ *
+ * @return OE_OK the call was posted.
+ * @return OE_INVALID_PARAMETER a parameter is invalid.
+ * @return OE_FAILURE the call could not be posted.
+ */
+oe_result_t oe_async_call_host_function(
+    size_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    oe_async_ocall_t* handle);
+
+/**
+ * Allocate a buffer of given size for doing an asynchronous ocall.
+ *
+ * The buffer is allocated in host memory, and should be treated as
+ * untrusted.
+ *
+ * @param size The size in bytes of the buffer.
+ * @returns pointer to the allocated buffer.
+ * @return NULL if allocation failed or too many asynchronous ocalls are in
+ * flight.
+ */
+void* oe_allocate_async_ocall_buffer(size_t size);
+
+/**
+ * Free a buffer allocated for an asynchronous ocall that was not made.
+ *
+ * @param buffer The buffer allocated via oe_allocate_async_ocall_buffer.
+ */
+void oe_free_async_ocall_buffer(void* buffer);
+
 /**
  * For hand-written enclaves, that use the older calling mechanism, define empty
  * ecall tables.
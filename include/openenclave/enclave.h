@@ -17,7 +17,9 @@
 #include "bits/defs.h"
 #include "bits/exception.h"
 #include "bits/fs.h"
+#include "bits/lock.h"
 #include "bits/module.h"
+#include "bits/parallel.h"
 #include "bits/properties.h"
 #include "bits/report.h"
 #include "bits/result.h"
@@ -199,6 +201,183 @@ void oe_host_free(void* ptr);
  */
 char* oe_host_strndup(const char* str, size_t n);
 
+/**
+ * Check whether an asynchronous OCALL has completed.
+ *
+ * Asynchronous OCALLs are made through the wrappers that oeedger8r generates
+ * for **transition_using_threads** untrusted functions with the **async**
+ * attribute. This function does not wait for the OCALL and does not release
+ * the handle, which must still be passed to oe_wait_async_ocall().
+ *
+ * @param handle The handle returned by the asynchronous OCALL wrapper.
+ * @param completed Set to true if the host has finished the OCALL.
+ *
+ * @returns OE_OK if the completion status was retrieved.
+ * @returns OE_INVALID_PARAMETER if the handle is invalid, already released,
+ * or a thread is waiting for it.
+ */
+oe_result_t oe_poll_async_ocall(oe_async_ocall_t handle, bool* completed);
+
+/**
+ * Wait for an asynchronous OCALL to complete and release its handle.
+ *
+ * The calling thread spins until the host has finished the OCALL. Every
+ * handle returned by an asynchronous OCALL wrapper must be released by this
+ * function exactly once.
+ *
+ * @param handle The handle returned by the asynchronous OCALL wrapper.
+ *
+ * @returns OE_OK if the host function was called successfully.
+ * @returns OE_INVALID_PARAMETER if the handle is invalid, already released,
+ * or another thread is waiting for it.
+ * @returns The error that the host reported for the OCALL otherwise.
+ */
+oe_result_t oe_wait_async_ocall(oe_async_ocall_t handle);
+
+/**
+ * The number of buckets in the free chunk histogram of oe_heap_stats_t.
+ */
+#define OE_HEAP_STATS_HISTOGRAM_SIZE 16
+
+/**
+ * Statistics of the enclave heap, as obtained by oe_get_heap_stats().
+ */
+typedef struct _oe_heap_stats
+{
+    /** The size of the heap, as set by the NumHeapPages enclave setting. */
+    uint64_t heap_size;
+
+    /** The number of heap bytes that have been handed out by sbrk. The rest
+     * of the heap has never been used. */
+    uint64_t sbrk_extent;
+
+    /** The number of heap bytes that the allocator currently holds. */
+    uint64_t system_bytes;
+
+    /** The high-water mark of **system_bytes**, which is the smallest heap
+     * that the enclave could have run with so far. */
+    uint64_t peak_system_bytes;
+
+    /** The number of bytes in allocated blocks, including the overhead of the
+     * allocator. */
+    uint64_t in_use_bytes;
+
+    /** The number of bytes in free chunks that the allocator holds. */
+    uint64_t free_bytes;
+
+    /** The number of free chunks that the allocator holds. */
+    uint64_t free_chunks;
+
+    /** The size of the largest free chunk. An allocation that is larger than
+     * this needs more memory from sbrk, even if **free_bytes** is larger. */
+    uint64_t largest_free_chunk;
+
+    /** The number of free chunks by size. Bucket i counts the chunks of at
+     * least 2^(i+4) and less than 2^(i+5) bytes, except that the last bucket
+     * counts all larger chunks as well. */
+    uint64_t free_chunk_histogram[OE_HEAP_STATS_HISTOGRAM_SIZE];
+} oe_heap_stats_t;
+
+/**
+ * Obtain statistics of the enclave heap.
+ *
+ * This function walks the chunks of the enclave heap while holding the lock
+ * of the allocator, so its cost grows with the number of chunks and it is
+ * not meant to be called on a hot path. The free chunks include the top
+ * chunk, from which the allocator carves chunks that no free chunk fits.
+ *
+ * @param stats The statistics of the heap.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if **stats** is null.
+ */
+oe_result_t oe_get_heap_stats(oe_heap_stats_t* stats);
+
+/**
+ * The largest number of return addresses recorded per allocation site.
+ */
+#define OE_ALLOCATION_PROFILE_MAX_FRAMES 16
+
+/**
+ * A call stack from which sampled allocations were made, as obtained by
+ * oe_get_allocation_profile().
+ */
+typedef struct _oe_allocation_site
+{
+    /** The number of sampled allocations made from this call stack. */
+    uint64_t samples;
+
+    /** The total size of the sampled allocations. */
+    uint64_t bytes;
+
+    /** The number of return addresses in **frames**. */
+    uint64_t num_frames;
+
+    /** The return addresses of the call stack, innermost first. */
+    void* frames[OE_ALLOCATION_PROFILE_MAX_FRAMES];
+} oe_allocation_site_t;
+
+/**
+ * Start the sampling allocation profiler.
+ *
+ * The profiler records the call stack of every **sample_interval**-th
+ * allocation made through malloc(), calloc(), realloc(), memalign() or
+ * posix_memalign(), and counts the samples and bytes of each distinct call
+ * stack. Starting the profiler while it runs discards the samples taken so
+ * far.
+ *
+ * The profiler is only available in enclaves linked against an oecore built
+ * with the USE_ALLOCATION_PROFILER option. When the profiler is stopped, it
+ * costs each allocation a single test of a global variable.
+ *
+ * @param sample_interval The number of allocations per sample.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if **sample_interval** is zero.
+ * @returns OE_OUT_OF_MEMORY if there is no memory for the profile.
+ * @returns OE_UNSUPPORTED if the profiler is not available.
+ */
+oe_result_t oe_start_allocation_profiler(uint32_t sample_interval);
+
+/**
+ * Stop the sampling allocation profiler and discard its samples.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_UNSUPPORTED if the profiler is not available.
+ */
+oe_result_t oe_stop_allocation_profiler(void);
+
+/**
+ * Obtain the allocation sites recorded by the profiler.
+ *
+ * The sites are sorted by the number of sampled bytes, largest first.
+ *
+ * @param sites The buffer for the sites, or null to query their number.
+ * @param num_sites On input, the number of sites that fit in **sites**. On
+ * return, the number of sites recorded by the profiler.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_BUFFER_TOO_SMALL if not all the sites fit in **sites**.
+ * @returns OE_INVALID_PARAMETER if **num_sites** is null.
+ * @returns OE_NOT_FOUND if the profiler is not running.
+ * @returns OE_UNSUPPORTED if the profiler is not available.
+ */
+oe_result_t oe_get_allocation_profile(
+    oe_allocation_site_t* sites,
+    size_t* num_sites);
+
+/**
+ * Print the allocation sites recorded by the profiler on the host.
+ *
+ * The sites are printed with the host's standard output, largest first,
+ * with their return addresses resolved to function names.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_NOT_FOUND if the profiler is not running.
+ * @returns OE_UNSUPPORTED if the profiler is not available.
+ */
+oe_result_t oe_dump_allocation_profile(void);
+
 /**
  * Abort execution of the enclave.
  *
@@ -385,6 +564,31 @@ oe_result_t oe_verify_report(
     size_t report_size,
     oe_report_t* parsed_report);
 
+/**
+ * Get the statistics of the cache of the collateral used to verify remote
+ * reports.
+ *
+ * Remote report verification keeps the parsed and verified revocation lists
+ * and TCB info of each platform until the earliest of their next update
+ * dates, so that verifying further reports from the same platform does not
+ * fetch and verify them again.
+ *
+ * @param statistics The structure to fill in with the statistics.
+ *
+ * @retval OE_OK The statistics were returned.
+ * @retval OE_INVALID_PARAMETER **statistics** is null.
+ */
+oe_result_t oe_get_collateral_cache_statistics(
+    oe_collateral_cache_statistics_t* statistics);
+
+/**
+ * Drop all the cached collateral used to verify remote reports, so that the
+ * next verifications fetch it again. The statistics are kept.
+ *
+ * @retval OE_OK The cache was flushed.
+ */
+oe_result_t oe_flush_collateral_cache(void);
+
 #if (OE_API_VERSION < 2)
 #error "Only OE_API_VERSION of 2 is supported"
 #else
@@ -607,7 +811,9 @@ oe_result_t oe_random(void* data, size_t size);
  * oe_generate_attestation_certificate.
  *
  * This function generates a self-signed x.509 certificate with an embedded
- * quote from the underlying enclave.
+ * quote from the underlying enclave. A certificate already generated for the
+ * same arguments is returned again while it is younger than the time to live
+ * set by oe_set_attestation_certificate_ttl().
  *
  * @param[in] subject_name a string contains an X.509 distinguished
  * name (DN) for customizing the generated certificate. This name is also used
@@ -640,6 +846,36 @@ oe_result_t oe_generate_attestation_certificate(
  */
 void oe_free_attestation_certificate(uint8_t* cert);
 
+/**
+ * Set how long oe_generate_attestation_certificate() reuses a certificate.
+ *
+ * The certificate generated for a key pair and subject name is returned
+ * again by further calls with the same arguments until its time to live has
+ * passed. Once half of it has passed, a new certificate is generated in the
+ * background on the enclave thread pool, if the enclave has one. The default
+ * time to live is zero, so certificates are not reused unless this is called.
+ *
+ * The age of a certificate is measured with the time from the host, which is
+ * not trusted. A host that controls the time can make the enclave reuse a
+ * certificate, and the report in it, for longer than the time to live.
+ *
+ * @param[in] ttl_seconds The time to live in seconds. Zero disables the
+ * reuse of certificates and drops the ones already kept.
+ *
+ * @retval OE_OK The time to live was set.
+ * @retval OE_INTEGER_OVERFLOW **ttl_seconds** is too large.
+ */
+oe_result_t oe_set_attestation_certificate_ttl(uint64_t ttl_seconds);
+
+/**
+ * Drop the certificates kept by oe_generate_attestation_certificate(), so
+ * that the next call for each key pair generates a new one, with a new
+ * report. Certificates already returned remain valid.
+ *
+ * @retval OE_OK The certificates were dropped.
+ */
+oe_result_t oe_rotate_attestation_certificates(void);
+
 /**
  * identity validation callback type
  * @param[in] identity a pointer to an enclave's identity information
@@ -77,6 +77,9 @@ typedef void (*oe_ocall_func_t)(
 typedef enum _oe_enclave_config_type
 {
     OE_ENCLAVE_CONFIG_CONTEXT_SWITCHLESS = 0xdc73a628,
+    OE_ENCLAVE_CONFIG_TIME_PAGE = 0x5e0d7f31,
+    OE_ENCLAVE_CONFIG_ASYNC_IO = 0x3a9c51e7,
+    OE_ENCLAVE_CONFIG_THREAD_POOL = 0x6f2b83d4,
 } oe_enclave_config_type_t;
 
 /**
@@ -91,12 +94,115 @@ typedef struct _oe_enclave_config_context_switchless
      */
     size_t max_host_workers;
     /**
-     * Context-switchless ecalls are not enabled yet. The max number of enclave
-     * workers should be 0.
+     * The max number of worker threads for context-switchless ecalls. Each
+     * enclave worker occupies one TCS for the lifetime of the enclave, so the
+     * actual number is capped to leave at least one TCS for regular ecalls.
+     * Switchless ecalls fall back to regular ecalls when all enclave workers
+     * are busy, or when this is 0.
      */
     size_t max_enclave_workers;
+    /**
+     * The number of times an idle host worker polls for work before it parks
+     * itself and stops consuming CPU. A parked worker is woken up by the next
+     * switchless ocall that finds no running worker, which falls back to a
+     * regular ocall in the meantime. A value of 0 selects a default budget.
+     */
+    size_t host_worker_spin_count;
 } oe_enclave_config_context_switchless_t;
 
+/**
+ * The configuration for the time page, which a host thread keeps up to date
+ * with the current time so that the enclave can read the time without an
+ * ocall. Without this configuration, every read of the time is an ocall.
+ */
+typedef struct _oe_enclave_config_time_page
+{
+    /**
+     * The number of milliseconds between updates of the time page, which is
+     * how stale the time read by the enclave can be. A value of 0 selects
+     * a resolution of 1 millisecond.
+     */
+    uint64_t resolution_msec;
+} oe_enclave_config_time_page_t;
+
+/**
+ * The configuration for asynchronous host I/O. The enclave submits reads,
+ * writes, receives and sends on host descriptors to rings in shared memory,
+ * which host worker threads serve, so that the enclave can overlap I/O with
+ * its own work and never leave the enclave to perform it.
+ *
+ * A worker waits for a descriptor to become ready before it performs the
+ * operation, so that terminating the enclave is not held up by an operation
+ * on a descriptor without data. Such operations fail with ECANCELED. An
+ * operation on a descriptor that another thread also reads or writes can
+ * still block after the wait, and then holds up the termination until it
+ * completes.
+ */
+typedef struct _oe_enclave_config_async_io
+{
+    /**
+     * The number of host worker threads that perform the operations. Each
+     * worker polls the rings while it is busy, and sleeps briefly between
+     * polls while it is idle. A value of 0 selects a single worker.
+     */
+    size_t num_host_workers;
+    /**
+     * The size of the buffer of each request, which is the largest transfer
+     * that a single operation performs. A value of 0 selects a default size.
+     */
+    size_t buffer_size;
+} oe_enclave_config_async_io_t;
+
+/**
+ * The configuration for the enclave thread pool, which backs pthread_create()
+ * in the enclave. The host lends a fixed number of its threads to the
+ * enclave when the enclave is created. Each of them enters the enclave once
+ * and runs the threads that the enclave creates, so that creating a thread
+ * does not create a host thread or enter the enclave. pthread_create() fails
+ * with EAGAIN when every worker already runs a thread.
+ */
+typedef struct _oe_enclave_config_thread_pool
+{
+    /**
+     * The number of host threads to lend to the enclave. Each of them
+     * occupies a TCS until the enclave is terminated, so the number is capped
+     * to leave at least one TCS for regular ecalls. A value of 0 lends every
+     * TCS that is left.
+     */
+    size_t num_threads;
+} oe_enclave_config_thread_pool_t;
+
+/**
+ * Statistics about the worker threads of context-switchless calls.
+ */
+typedef struct _oe_switchless_statistics
+{
+    /**
+     * The number of times host workers parked themselves after running out
+     * of their spin budget.
+     */
+    uint64_t host_worker_parks;
+    /**
+     * The number of times parked host workers were woken up.
+     */
+    uint64_t host_worker_wakes;
+    /**
+     * The number of context-switchless ocalls handled by host workers. The
+     * ocalls that fell back to regular ocalls are not included.
+     */
+    uint64_t host_worker_calls;
+    /**
+     * The number of times enclave workers parked themselves after running
+     * out of their spin budget.
+     */
+    uint64_t enclave_worker_parks;
+    /**
+     * The number of context-switchless ecalls handled by enclave workers.
+     * The ecalls that fell back to regular ecalls are not included.
+     */
+    uint64_t enclave_worker_calls;
+} oe_switchless_statistics_t;
+
 /**
  * The uniform structure type containing a specific type of enclave
  * configuration.
@@ -113,6 +219,9 @@ typedef struct _oe_enclave_config
      */
     union {
         const oe_enclave_config_context_switchless_t* context_switchless_config;
+        const oe_enclave_config_time_page_t* time_page_config;
+        const oe_enclave_config_async_io_t* async_io_config;
+        const oe_enclave_config_thread_pool_t* thread_pool_config;
         /* Add new configuration types here. */
     } u;
 } oe_enclave_config_t;
@@ -182,6 +291,251 @@ oe_result_t oe_create_enclave(
  */
 oe_result_t oe_terminate_enclave(oe_enclave_t* enclave);
 
+/**
+ * Load an enclave image file into the image cache.
+ *
+ * **oe_create_enclave()** keeps the parsed and patched images of the most
+ * recently used enclave image files in a cache, so that enclaves created
+ * from the same file only have their pages added. This function loads the
+ * image ahead of the first **oe_create_enclave()** call. A cached image is
+ * loaded again if its file changes.
+ *
+ * @param path The path of an enclave image file.
+ *
+ * @retval OE_OK The image is in the cache.
+ * @retval OE_INVALID_PARAMETER The path is null.
+ * @retval OE_NOT_FOUND The file does not exist.
+ * @returns Another error if the image could not be loaded.
+ *
+ */
+oe_result_t oe_preload_enclave_image(const char* path);
+
+/**
+ * Remove an enclave image file from the image cache.
+ *
+ * Enclaves that are being created from the image are not affected.
+ *
+ * @param path The path of an enclave image file, as passed to
+ * **oe_create_enclave()**, or null to remove every image.
+ *
+ * @returns Returns OE_OK.
+ *
+ */
+oe_result_t oe_evict_enclave_image(const char* path);
+
+/**
+ * Type of the functions that create an enclave, such as the
+ * **oe_create_<name>_enclave()** functions generated by oeedger8r.
+ */
+typedef oe_result_t (*oe_enclave_create_function_t)(
+    const char* path,
+    oe_enclave_type_t type,
+    uint32_t flags,
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+    const oe_enclave_config_t* configs,
+    uint32_t config_count,
+#else
+    const void* config,
+    uint32_t config_size,
+#endif
+    oe_enclave_t** enclave);
+
+/**
+ * Type of the function that prepares a released enclave for its next user.
+ *
+ * The function typically makes an ECALL that clears the state left behind
+ * by the previous user. Returning anything other than OE_OK discards the
+ * enclave.
+ */
+typedef oe_result_t (*oe_enclave_reset_function_t)(
+    oe_enclave_t* enclave,
+    void* arg);
+
+/**
+ * Settings of an enclave pool, passed to **oe_create_enclave_pool()**.
+ */
+typedef struct _oe_enclave_pool_settings
+{
+    /** The function that creates each enclave of the pool. */
+    oe_enclave_create_function_t create;
+
+    /** The arguments passed to **create**. The configurations must remain
+     * valid until the pool is terminated. */
+    const char* path;
+    oe_enclave_type_t type;
+    uint32_t flags;
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+    const oe_enclave_config_t* configs;
+    uint32_t config_count;
+#else
+    const void* config;
+    uint32_t config_size;
+#endif
+
+    /** The number of enclaves that the pool keeps ready. If **reset** is not
+     * null, this includes the enclaves that are handed out. */
+    size_t size;
+
+    /** The number of background threads that create enclaves. 0 means 1. */
+    size_t num_threads;
+
+    /** Called on each released enclave. If null, released enclaves are
+     * terminated and replaced by new ones. */
+    oe_enclave_reset_function_t reset;
+    void* reset_arg;
+} oe_enclave_pool_settings_t;
+
+/**
+ * Statistics of an enclave pool, cumulative since the pool was created.
+ */
+typedef struct _oe_enclave_pool_statistics
+{
+    /** The number of acquisitions served by a ready enclave. */
+    uint64_t hits;
+
+    /** The number of acquisitions that had to create an enclave. */
+    uint64_t misses;
+
+    /** The number of enclaves created, and the number of failed attempts. */
+    uint64_t enclaves_created;
+    uint64_t create_failures;
+
+    /** The total and the longest time taken to create an enclave. */
+    uint64_t total_create_usec;
+    uint64_t max_create_usec;
+
+    /** The number of released enclaves that were reset and kept, and the
+     * number that were terminated. */
+    uint64_t enclaves_reused;
+    uint64_t enclaves_discarded;
+
+    /** The number of enclaves that are ready now. */
+    uint64_t enclaves_ready;
+} oe_enclave_pool_statistics_t;
+
+/**
+ * Opaque type of an enclave pool.
+ */
+typedef struct _oe_enclave_pool oe_enclave_pool_t;
+
+/**
+ * Create a pool of enclaves from one enclave image.
+ *
+ * This function creates a pool that keeps **settings->size** enclaves created
+ * and initialized ahead of time, so that **oe_enclave_pool_acquire()** hands
+ * out an enclave without waiting for it to be created. Background threads
+ * create the enclaves, and replace each enclave that is handed out. If the
+ * pool has a reset function, an enclave that is handed out is only replaced
+ * once it is released and cannot be reset, so that released enclaves are
+ * reused. The first enclave is created before the function returns, so that
+ * a bad image or a bad setting fails here.
+ *
+ * @param settings The settings of the pool. They are copied.
+ * @param pool This points to the pool upon success.
+ *
+ * @retval OE_OK The pool was created.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Memory could not be allocated.
+ * @retval OE_THREAD_CREATE_ERROR A background thread could not be created.
+ * @returns The result of **settings->create** if it failed.
+ *
+ */
+oe_result_t oe_create_enclave_pool(
+    const oe_enclave_pool_settings_t* settings,
+    oe_enclave_pool_t** pool);
+
+/**
+ * Take an enclave from a pool.
+ *
+ * The enclave is one that the pool created ahead of time if there is one,
+ * or one that is created on the calling thread otherwise. The enclave then
+ * belongs to the caller, which passes it back to
+ * **oe_enclave_pool_release()**, or terminates it with
+ * **oe_terminate_enclave()**. The latter keeps a pool with a reset function
+ * one enclave short for good.
+ *
+ * @param pool The pool.
+ * @param enclave This points to the enclave upon success.
+ *
+ * @retval OE_OK An enclave was acquired.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @returns The result of the create function of the pool if it failed.
+ *
+ */
+oe_result_t oe_enclave_pool_acquire(
+    oe_enclave_pool_t* pool,
+    oe_enclave_t** enclave);
+
+/**
+ * Give an enclave back to the pool that it was acquired from.
+ *
+ * If the pool has a reset function that succeeds on the enclave, and the
+ * pool is not full, the enclave is kept for the next acquisition. Otherwise
+ * it is terminated on the calling thread.
+ *
+ * @param pool The pool.
+ * @param enclave The enclave.
+ *
+ * @retval OE_OK The enclave was kept or terminated.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ *
+ */
+oe_result_t oe_enclave_pool_release(
+    oe_enclave_pool_t* pool,
+    oe_enclave_t* enclave);
+
+/**
+ * Get the statistics of an enclave pool.
+ *
+ * @param pool The pool.
+ * @param statistics The statistics upon success.
+ *
+ * @retval OE_OK The statistics were retrieved.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ *
+ */
+oe_result_t oe_get_enclave_pool_statistics(
+    oe_enclave_pool_t* pool,
+    oe_enclave_pool_statistics_t* statistics);
+
+/**
+ * Terminate an enclave pool.
+ *
+ * This function stops the background threads of the pool and terminates
+ * the enclaves that are ready. Enclaves that were acquired from the pool
+ * are not affected, and must be terminated with **oe_terminate_enclave()**.
+ *
+ * @param pool The pool.
+ *
+ * @retval OE_OK The pool was terminated.
+ * @retval OE_INVALID_PARAMETER The pool is null.
+ *
+ */
+oe_result_t oe_terminate_enclave_pool(oe_enclave_pool_t* pool);
+
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+
+/**
+ * Get the statistics of the context-switchless worker threads of an enclave.
+ *
+ * The statistics are cumulative since the enclave was created, and can be
+ * used to tune **host_worker_spin_count** of the
+ * **oe_enclave_config_context_switchless_t** configuration.
+ *
+ * @param enclave The instance of the enclave.
+ * @param statistics The statistics upon success.
+ *
+ * @retval OE_OK The statistics were successfully retrieved.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid, or
+ * context-switchless calls are not configured for the enclave.
+ *
+ */
+oe_result_t oe_get_switchless_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_statistics_t* statistics);
+
+#endif /* OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE */
+
 #if (OE_API_VERSION < 2)
 #error "Only OE_API_VERSION of 2 is supported"
 #else
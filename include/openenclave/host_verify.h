@@ -42,6 +42,60 @@ oe_result_t oe_verify_remote_report(
     size_t report_size,
     oe_report_t* parsed_report);
 
+/**
+ * Verify a batch of remote reports.
+ *
+ * This function verifies each report as oe_verify_remote_report() does, and
+ * shares the work between the reports of a batch. The reports are grouped by
+ * the platform family (FMSPC) they come from, so that the revocation
+ * collateral of each family is fetched and parsed once for the batch, and
+ * the signatures of the reports are verified by a pool of threads.
+ *
+ * @param reports The reports to verify.
+ * @param report_sizes The sizes of the **reports**.
+ * @param count The number of reports.
+ * @param results On return, the result of verifying each report.
+ * @param parsed_reports Optional array of **count** **oe_report_t**
+ * structures to populate with the properties of each verified report.
+ *
+ * @retval OE_OK Every report was verified.
+ * @retval OE_VERIFY_FAILED At least one report failed verification, as
+ * given by its entry of **results**.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ *
+ */
+oe_result_t oe_verify_remote_reports(
+    const uint8_t* const* reports,
+    const size_t* report_sizes,
+    size_t count,
+    oe_result_t* results,
+    oe_report_t* parsed_reports);
+
+/**
+ * Get the statistics of the cache of the collateral used to verify remote
+ * reports.
+ *
+ * Remote report verification keeps the parsed and verified revocation lists
+ * and TCB info of each platform until the earliest of their next update
+ * dates, so that verifying further reports from the same platform does not
+ * fetch and verify them again.
+ *
+ * @param statistics The structure to fill in with the statistics.
+ *
+ * @retval OE_OK The statistics were returned.
+ * @retval OE_INVALID_PARAMETER **statistics** is null.
+ */
+oe_result_t oe_get_collateral_cache_statistics(
+    oe_collateral_cache_statistics_t* statistics);
+
+/**
+ * Drop all the cached collateral used to verify remote reports, so that the
+ * next verifications fetch it again. The statistics are kept.
+ *
+ * @retval OE_OK The cache was flushed.
+ */
+oe_result_t oe_flush_collateral_cache(void);
+
 /**
  * identity validation callback type
  * @param[in] identity a pointer to an enclave's identity information
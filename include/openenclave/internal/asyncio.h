@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_INTERNAL_ASYNCIO_H
+#define _OE_INTERNAL_ASYNCIO_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/switchless_ring.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Asynchronous I/O rings
+**
+**     The host allocates a fixed set of request slots, each with a data
+**     buffer, and a pair of rings in host memory when the enclave is created.
+**     The enclave fills in a slot and pushes it to the submission ring. Host
+**     worker threads pop it, perform the operation, fill in the outcome and
+**     push the slot to the completion ring, which the enclave polls. Neither
+**     side leaves its own context to hand a request to the other.
+**
+**==============================================================================
+*/
+
+/* Every slot fits in either ring at once, so pushes never fail. */
+#define OE_ASYNC_IO_MAX_REQUESTS OE_SWITCHLESS_RING_CAPACITY
+
+/* The default size of the data buffer of each slot. */
+#define OE_ASYNC_IO_DEFAULT_BUFFER_SIZE (16 * 1024)
+
+/* The largest data buffer that the enclave accepts for each slot. */
+#define OE_ASYNC_IO_MAX_BUFFER_SIZE (1024 * 1024)
+
+typedef enum _oe_async_io_opcode
+{
+    OE_ASYNC_IO_OP_NONE = 0,
+    OE_ASYNC_IO_OP_READ,
+    OE_ASYNC_IO_OP_WRITE,
+    OE_ASYNC_IO_OP_RECV,
+    OE_ASYNC_IO_OP_SEND,
+} oe_async_io_opcode_t;
+
+/* A request slot in host memory. The enclave fills in the operation before
+ * it submits the slot, and the host fills in the outcome before it completes
+ * the slot. The data of the operation is in the buffer of the slot. */
+typedef struct _oe_async_io_request
+{
+    uint32_t opcode;
+    int32_t flags;
+    int64_t fd;
+    uint64_t count;
+    volatile int64_t result;
+    volatile int32_t error;
+    uint32_t padding;
+} oe_async_io_request_t;
+
+/* The memory that the host shares with the enclave. */
+typedef struct _oe_async_io_rings
+{
+    oe_switchless_ring submission_ring;
+    oe_switchless_ring completion_ring;
+
+    /* num_requests slots, and num_requests buffers of buffer_size bytes. */
+    oe_async_io_request_t* requests;
+    uint8_t* buffers;
+    uint64_t num_requests;
+    uint64_t buffer_size;
+
+    /* The number of host threads that serve the submission ring. */
+    uint64_t num_workers;
+} oe_async_io_rings_t;
+
+/* The outcome of an asynchronous operation, as reported to the enclave. */
+typedef struct _oe_async_io_completion
+{
+    uint64_t user_data;
+    ssize_t result;
+    int error;
+} oe_async_io_completion_t;
+
+/* Handles OE_ECALL_INIT_ASYNC_IO, which passes the oe_async_io_rings_t. */
+oe_result_t oe_handle_init_async_io(uint64_t arg_in);
+
+/* Returns true if the host set up the rings for this enclave. */
+bool oe_async_io_is_available(void);
+
+/* Returns the largest transfer that a single operation performs. */
+size_t oe_async_io_get_buffer_size(void);
+
+/* Submits an operation on a host descriptor. The data of a write or send
+ * is copied at once, while buf of a read or receive must stay valid until
+ * the operation is reaped by oe_async_io_reap(). Transfers are truncated to
+ * the buffer size. Returns 0, or -1 with oe_errno set to OE_ENOSYS if the
+ * rings are not available or to OE_EAGAIN if all slots are in use. */
+int oe_async_io_submit_host(
+    oe_async_io_opcode_t opcode,
+    int64_t host_fd,
+    void* buf,
+    size_t count,
+    int flags,
+    uint64_t user_data);
+
+/* Reaps up to count completed operations without leaving the enclave, and
+ * returns how many were reaped. */
+size_t oe_async_io_reap(oe_async_io_completion_t* completions, size_t count);
+
+/* Performs an operation on a host descriptor through the rings and waits for
+ * it. Returns false if the operation could not be submitted, e.g. because
+ * every host worker may be busy, in which case the caller should fall back to
+ * an OCALL. Otherwise *result receives the
+ * result, and oe_errno is set if it is -1. */
+bool oe_async_io_call_host(
+    oe_async_io_opcode_t opcode,
+    int64_t host_fd,
+    void* buf,
+    size_t count,
+    int flags,
+    ssize_t* result);
+
+OE_EXTERNC_END
+
+#endif /* _OE_INTERNAL_ASYNCIO_H */
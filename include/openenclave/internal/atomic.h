@@ -12,10 +12,12 @@
 #pragma intrinsic(_InterlockedDecrement64)
 #pragma intrinsic(_InterlockedCompareExchange64)
 #pragma intrinsic(_InterlockedCompareExchangePointer)
+#pragma intrinsic(_InterlockedCompareExchange)
 __int64 _InterlockedIncrement64(__int64* lpAddend);
 __int64 _InterlockedDecrement64(__int64* lpAddend);
 __int64 _InterlockedCompareExchange64(__int64* Dest, __int64 val, __int64 old);
 void* _InterlockedCompareExchangePointer(void** Dest, void* newptr, void* old);
+long _InterlockedCompareExchange(long volatile* Dest, long val, long old);
 #endif
 
 /* Atomically increment **x** and return its new value */
@@ -58,6 +60,23 @@ bool oe_atomic_compare_and_swap(
 #endif
 }
 
+OE_INLINE
+bool oe_atomic_compare_and_swap_32(
+    uint32_t volatile* dest,
+    uint32_t old,
+    uint32_t newval)
+{
+#if defined(__GNUC__)
+    return __atomic_compare_exchange_n(
+        dest, &old, newval, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchange(
+               (long volatile*)dest, (long)newval, (long)old) == (long)old;
+#else
+#error "unsupported"
+#endif
+}
+
 OE_INLINE
 bool oe_atomic_compare_and_swap_ptr(
     void* volatile* dest,
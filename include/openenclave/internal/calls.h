@@ -76,6 +76,12 @@ typedef enum _oe_func
     OE_ECALL_CALL_ENCLAVE_FUNCTION,
     OE_ECALL_VIRTUAL_EXCEPTION_HANDLER,
     OE_ECALL_INIT_CONTEXT_SWITCHLESS,
+    OE_ECALL_CONTEXT_SWITCHLESS_WORKER,
+    OE_ECALL_INIT_TIME_PAGE,
+    OE_ECALL_INIT_ASYNC_IO,
+    OE_ECALL_INIT_THREAD_POOL,
+    OE_ECALL_THREAD_POOL_WORKER,
+    OE_ECALL_STOP_THREAD_POOL,
     /* Caution: always add new ECALL function numbers here */
     OE_ECALL_MAX,
 
@@ -86,6 +92,9 @@ typedef enum _oe_func
     OE_OCALL_FREE,
     OE_OCALL_SLEEP,
     OE_OCALL_GET_TIME,
+    OE_OCALL_GET_OCALL_BUFFER,
+    OE_OCALL_WAKE_SWITCHLESS_WORKER,
+    OE_OCALL_PARK_SWITCHLESS_WORKER,
     /* Caution: always add new OCALL function numbers here */
     OE_OCALL_MAX, /* This value is never used */
 
@@ -176,6 +185,21 @@ OE_INLINE uint16_t oe_get_result_from_call_arg1(uint64_t arg)
     return (uint16_t)(0x000000000000ffff & arg);
 }
 
+/*
+**==============================================================================
+**
+** OE_OCALL_BUFFER_SIZE
+**
+**     The size of the host memory region that the host allocates for each
+**     enclave thread context (TCS). The enclave obtains its region once
+**     through OE_OCALL_GET_OCALL_BUFFER and bump-allocates OCALL arguments
+**     and marshalling buffers from it.
+**
+**==============================================================================
+*/
+
+#define OE_OCALL_BUFFER_SIZE (64 * 1024)
+
 /*
 **==============================================================================
 **
@@ -52,6 +52,12 @@ int32_t oe_datetime_compare(
     const oe_datetime_t* date1,
     const oe_datetime_t* date2);
 
+/**
+ * Get the current UTC time. In an enclave, the time comes from the host and
+ * must not be relied upon for anything but a hint.
+ */
+oe_result_t oe_datetime_now(oe_datetime_t* value);
+
 OE_EXTERNC_END
 
 #endif /* _OE_INTERNAL_DATETIME_H */
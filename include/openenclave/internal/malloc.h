@@ -44,6 +44,9 @@ typedef struct _oe_malloc_stats
  */
 oe_result_t oe_get_malloc_stats(oe_malloc_stats_t* stats);
 
+/* Get the number of heap bytes that oe_sbrk() has handed out */
+size_t oe_get_sbrk_extent(void);
+
 /* Dump the list of all in-use allocations */
 void oe_debug_malloc_dump(void);
 
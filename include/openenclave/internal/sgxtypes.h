@@ -529,15 +529,27 @@ struct _oe_thread_data
     uint64_t __stack_limit_addr;
     uint64_t __first_ssa_gpr;
     uint64_t __stack_guard; /* 0x28 for x64 */
-    uint64_t __reserved_0;
+
+    /* The host memory region for OCALL marshalling of this TCS (see
+     * OE_OCALL_BUFFER_SIZE), which persists across ECALLs */
+    uint8_t* ocall_buffer;
+
     uint64_t __ssa_frame_size;
-    uint64_t __last_error;
+
+    /* The end of the bytes of ocall_buffer in use, and the start of the most
+     * recent allocation from it */
+    uint32_t ocall_buffer_used;
+    uint32_t ocall_buffer_top;
 
     /* The threads implementations uses this to put threads on queues */
     oe_thread_data_t* next;
 
     uint64_t __tls_addr;
-    uint64_t __tls_array;
+
+    /* The number of allocations from ocall_buffer not freed yet */
+    uint32_t ocall_buffer_live;
+    uint32_t __reserved_1;
+
     uint64_t __exception_flag; /* number of exceptions being handled */
     uint64_t __cxx_thread_info[6];
 
@@ -597,7 +609,11 @@ typedef struct _td
     /* Return arguments from OCALL */
     uint16_t oret_func;
     uint16_t oret_result;
-    uint16_t padding[2];
+
+    /* State of the thread in the wait/wake handshake of the enclave
+     * synchronization primitives, which persists across ECALLs */
+    volatile uint32_t wait_state;
+
     uint64_t oret_arg;
 
     /* List of Callsite structures (most recent call is first) */
@@ -7,25 +7,107 @@
 #include <openenclave/bits/defs.h>
 #include <openenclave/bits/types.h>
 #include <openenclave/internal/calls.h>
+#include <openenclave/internal/switchless_ring.h>
 #include <openenclave/internal/thread.h>
 
+/*
+** The default number of polls an idle host worker makes before parking.
+*/
+#define OE_SWITCHLESS_DEFAULT_HOST_WORKER_SPIN_COUNT 4096
+
+/*
+** The maximum number of switchless OCALLs a host worker takes from the ring
+** at once.
+*/
+#define OE_SWITCHLESS_HOST_WORKER_BATCH_SIZE 4
+
+/*
+** The states of a host worker. The state doubles as the futex word that a
+** parked worker waits on. Only the worker moves itself between RUNNING and
+** PARKED. The enclave moves a PARKED worker to WAKING to ask the host to wake
+** it up, which the host does when handling the regular OCALL that the enclave
+** falls back to.
+*/
+#define OE_HOST_WORKER_RUNNING 0
+#define OE_HOST_WORKER_PARKED 1
+#define OE_HOST_WORKER_WAKING 2
+
+/*
+** The context of a host worker. Switchless OCALLs are not posted to a specific
+** worker, but to the ring of the switchless manager, which all host workers
+** drain.
+*/
 typedef struct _host_worker_thread_context
 {
-    volatile oe_call_host_function_args_t* call_arg;
+    oe_switchless_ring* ring;
     volatile bool is_stopping;
     oe_enclave_t* enclave;
+    volatile uint32_t state;
+    volatile uint64_t* num_parked;
+    uint64_t spin_count;
+    volatile uint64_t park_count;
+    volatile uint64_t wake_count;
+    volatile uint64_t call_count;
 } oe_host_worker_context_t;
 
+/*
+** The number of polls an idle enclave worker makes before parking.
+*/
+#define OE_SWITCHLESS_ENCLAVE_WORKER_SPIN_COUNT 4096
+
+/*
+** The states of an enclave worker, which double as the futex word that a
+** parked worker waits on in the host. Only the worker moves itself from
+** RUNNING to PARKED, and the host moves it back when it posts an ECALL to the
+** worker or stops it.
+*/
+#define OE_ENCLAVE_WORKER_RUNNING 0
+#define OE_ENCLAVE_WORKER_PARKED 1
+
+/*
+** The context shared between the host and an enclave worker thread. The host
+** posts an ECALL by writing to call_arg. The enclave worker, which occupies a
+** TCS for its lifetime, clears call_arg, executes the call and sets
+** call_arg->result once done.
+*/
+typedef struct _enclave_worker_thread_context
+{
+    volatile oe_call_enclave_function_args_t* call_arg;
+    volatile bool is_stopping;
+    oe_enclave_t* enclave;
+    volatile uint32_t state;
+    volatile uint64_t park_count;
+    volatile uint64_t call_count;
+} oe_enclave_worker_context_t;
+
 typedef struct _oe_switchless_call_manager
 {
+    oe_switchless_ring* ring;
     oe_host_worker_context_t* host_worker_contexts;
     oe_thread_t* host_worker_threads;
     size_t num_host_workers;
+    /* The number of host workers that are not RUNNING */
+    volatile uint64_t num_parked_host_workers;
+    oe_enclave_worker_context_t* enclave_worker_contexts;
+    oe_thread_t* enclave_worker_threads;
+    size_t num_enclave_workers;
 } oe_switchless_call_manager_t;
 
 oe_result_t oe_start_switchless_manager(
     oe_enclave_t* enclave,
-    size_t num_host_workers);
+    size_t num_host_workers,
+    size_t num_enclave_workers,
+    size_t host_worker_spin_count);
+
+void oe_wake_switchless_host_workers(oe_switchless_call_manager_t* manager);
+
+void oe_park_switchless_enclave_worker(
+    oe_switchless_call_manager_t* manager,
+    uint64_t arg);
+
+void oe_unpark_switchless_enclave_worker(oe_enclave_worker_context_t* context);
+
+oe_result_t oe_stop_switchless_enclave_workers(oe_enclave_t* enclave);
 
 oe_result_t oe_stop_switchless_manager(oe_enclave_t* enclave);
 
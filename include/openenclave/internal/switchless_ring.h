@@ -0,0 +1,147 @@
+/* Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. */
+
+#ifndef _SWITCHLESS_RING_H_
+#define _SWITCHLESS_RING_H_
+
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/defs.h>
+
+OE_EXTERNC_BEGIN
+
+/**
+ * @brief The number of slots in an oe_switchless_ring. Must be a power of 2.
+ */
+#define OE_SWITCHLESS_RING_CAPACITY 64
+
+/**
+ * @brief The cache line size that the ring is padded to.
+ */
+#define OE_SWITCHLESS_RING_CACHE_LINE_SIZE 64
+
+/**
+ * @struct _oe_switchless_ring_slot
+ *
+ * @brief A slot of an oe_switchless_ring.
+ *
+ * Each slot occupies its own cache line, so that producers filling
+ * neighbouring slots do not contend for the same line.
+ */
+typedef struct _oe_switchless_ring_slot
+{
+    /**
+     * @internal
+     */
+    volatile uint64_t sequence;
+    /**
+     * @internal
+     */
+    void* volatile item;
+    /**
+     * @internal
+     */
+    uint8_t padding[OE_SWITCHLESS_RING_CACHE_LINE_SIZE - 2 * sizeof(uint64_t)];
+} oe_switchless_ring_slot;
+
+/**
+ * @struct _oe_switchless_ring
+ *
+ * @brief A bounded, multi-producer, multi-consumer, FIFO ring of pointers
+ *        that is multithread stable.
+ *
+ * Any number of threads may call oe_switchless_ring_push() and
+ * oe_switchless_ring_pop() concurrently without the use of any mutex. Each
+ * slot carries a sequence number that tells producers and consumers whether
+ * the slot is free or filled for the current lap around the ring. The enqueue
+ * and dequeue positions, as well as each slot, are kept on separate cache
+ * lines.
+ *
+ * @note The ring should be allocated on a cache line boundary and initialized
+ *       with oe_switchless_ring_init() before use.
+ */
+typedef struct _oe_switchless_ring
+{
+    /**
+     * @internal
+     */
+    volatile uint64_t enqueue_pos;
+    /**
+     * @internal
+     */
+    uint8_t padding0[OE_SWITCHLESS_RING_CACHE_LINE_SIZE - sizeof(uint64_t)];
+    /**
+     * @internal
+     */
+    volatile uint64_t dequeue_pos;
+    /**
+     * @internal
+     */
+    uint8_t padding1[OE_SWITCHLESS_RING_CACHE_LINE_SIZE - sizeof(uint64_t)];
+    /**
+     * @internal
+     */
+    oe_switchless_ring_slot slots[OE_SWITCHLESS_RING_CAPACITY];
+} oe_switchless_ring;
+
+/**
+ * @function oe_switchless_ring_init
+ *
+ * @brief Initializes an _oe_switchless_ring.
+ *
+ * @param p_ring An uninitialized _oe_switchless_ring.
+ *
+ * @pre p_ring is non-NULL and points to an uninitialized ring.
+ * @post p_ring is empty and prepared to use with oe_switchless_ring_push()
+ *       and oe_switchless_ring_pop().
+ */
+void oe_switchless_ring_init(oe_switchless_ring* p_ring);
+
+/**
+ * @function oe_switchless_ring_push
+ *
+ * @brief Appends an item to the tail of an _oe_switchless_ring.
+ *
+ * @param p_ring The _oe_switchless_ring to append the item to.
+ * @param item The item to append.
+ * @return true if the item was appended, or false if the ring is full.
+ *
+ * @note It is safe to call this method from any number of threads
+ *       concurrently.
+ */
+bool oe_switchless_ring_push(oe_switchless_ring* p_ring, void* item);
+
+/**
+ * @function oe_switchless_ring_pop
+ *
+ * @brief Removes up to count items from the head of an _oe_switchless_ring.
+ *
+ * The items are claimed with a single atomic operation, which lets a consumer
+ * drain several items in a batch.
+ *
+ * @param p_ring The _oe_switchless_ring to remove the items from.
+ * @param items The array that receives the removed items in FIFO order.
+ * @param count The maximum number of items to remove.
+ * @return The number of items removed, which is 0 if the ring is empty.
+ *
+ * @note It is safe to call this method from any number of threads
+ *       concurrently.
+ */
+size_t oe_switchless_ring_pop(
+    oe_switchless_ring* p_ring,
+    void** items,
+    size_t count);
+
+/**
+ * @function oe_switchless_ring_is_empty
+ *
+ * @brief Checks whether an _oe_switchless_ring has no items and no pending
+ *        push.
+ *
+ * @param p_ring The _oe_switchless_ring to check.
+ * @return true if the ring is empty.
+ */
+bool oe_switchless_ring_is_empty(const oe_switchless_ring* p_ring);
+
+OE_EXTERNC_END
+
+#endif /* _SWITCHLESS_RING_H_ */
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYSCALL_ASYNCIO_H
+#define _OE_SYSCALL_ASYNCIO_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/asyncio.h>
+#include <openenclave/internal/syscall/types.h>
+
+OE_EXTERNC_BEGIN
+
+/* Asynchronous I/O on the host descriptor behind an enclave descriptor, for
+ * enclaves whose host configured OE_ENCLAVE_CONFIG_ASYNC_IO. Operations are
+ * submitted to rings in shared memory and performed by host workers, so
+ * neither submitting nor polling leaves the enclave.
+ *
+ * The submission functions return 0, or -1 with oe_errno set to OE_ENOSYS if
+ * the rings are not available, to OE_EAGAIN if too many operations are in
+ * flight, or to the error of resolving the descriptor. The data of a write
+ * or send is copied at once, while buf of a read or receive must stay valid
+ * until the operation is polled. Each operation transfers at most
+ * oe_async_io_get_buffer_size() bytes, and reports the count that it
+ * transferred like the corresponding system call.
+ */
+int oe_async_io_read(int fd, void* buf, size_t count, uint64_t user_data);
+
+int oe_async_io_write(
+    int fd,
+    const void* buf,
+    size_t count,
+    uint64_t user_data);
+
+int oe_async_io_recv(
+    int sockfd,
+    void* buf,
+    size_t len,
+    int flags,
+    uint64_t user_data);
+
+int oe_async_io_send(
+    int sockfd,
+    const void* buf,
+    size_t len,
+    int flags,
+    uint64_t user_data);
+
+/* Returns up to count completed operations, without waiting for any. */
+size_t oe_async_io_poll(oe_async_io_completion_t* completions, size_t count);
+
+/* While enabled, blocking reads and writes of host files and blocking
+ * receives and sends of host sockets go through the rings when they are
+ * available, instead of making an OCALL. Disabled by default. */
+void oe_async_io_set_blocking_mode(bool enabled);
+
+bool oe_async_io_get_blocking_mode(void);
+
+/* Called by devices to perform a blocking operation through the rings.
+ * Returns false if the operation should be made with an OCALL instead.
+ * Otherwise *ret receives the result, and oe_errno is set if it is -1. */
+bool oe_async_io_blocking_call(
+    oe_async_io_opcode_t opcode,
+    oe_host_fd_t host_fd,
+    void* buf,
+    size_t count,
+    int flags,
+    ssize_t* ret);
+
+OE_EXTERNC_END
+
+#endif // _OE_SYSCALL_ASYNCIO_H
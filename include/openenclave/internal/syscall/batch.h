@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYSCALL_BATCH_H
+#define _OE_SYSCALL_BATCH_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/syscall/sys/stat.h>
+#include <openenclave/internal/syscall/types.h>
+
+OE_EXTERNC_BEGIN
+
+/* The maximum number of operations in a batch. */
+#define OE_SYSCALL_BATCH_MAX 64
+
+typedef enum _oe_syscall_batch_opcode
+{
+    OE_SYSCALL_BATCH_OP_NONE = 0,
+    OE_SYSCALL_BATCH_OP_READ,
+    OE_SYSCALL_BATCH_OP_WRITE,
+    OE_SYSCALL_BATCH_OP_RECV,
+    OE_SYSCALL_BATCH_OP_SEND,
+    OE_SYSCALL_BATCH_OP_CLOSE,
+    OE_SYSCALL_BATCH_OP_FSTAT,
+} oe_syscall_batch_opcode_t;
+
+/* An operation submitted to the host. Its data lies at data_offset in the
+ * input buffer for writes and sends, and in the output buffer otherwise. */
+struct oe_syscall_batch_sqe
+{
+    uint32_t opcode;
+    int32_t flags;
+    oe_host_fd_t fd;
+    uint64_t data_offset;
+    uint64_t data_size;
+};
+
+/* The completion of an operation, filled in by the host. */
+struct oe_syscall_batch_cqe
+{
+    int64_t result;
+    int32_t error;
+    uint32_t padding;
+};
+
+OE_STATIC_ASSERT(sizeof(struct oe_syscall_batch_sqe) == 32);
+OE_STATIC_ASSERT(sizeof(struct oe_syscall_batch_cqe) == 16);
+
+/* An operation queued in the enclave. */
+typedef struct _oe_syscall_batch_op
+{
+    oe_syscall_batch_opcode_t opcode;
+    int fd;
+    int flags;
+    void* buf;
+    size_t count;
+} oe_syscall_batch_op_t;
+
+/* A batch of operations that the host performs in order, for the cost of a
+ * single OCALL. Initialize it with oe_syscall_batch_init(), queue up to
+ * OE_SYSCALL_BATCH_MAX operations, then call oe_syscall_batch_submit().
+ *
+ * Each operation goes straight to the host descriptor behind fd, so only
+ * descriptors of devices that implement oe_fd_ops_t.release are accepted.
+ */
+typedef struct _oe_syscall_batch
+{
+    size_t count;
+    oe_syscall_batch_op_t ops[OE_SYSCALL_BATCH_MAX];
+
+    /* The outcomes of the last submission of num_results operations. */
+    size_t num_results;
+    ssize_t results[OE_SYSCALL_BATCH_MAX];
+    int errors[OE_SYSCALL_BATCH_MAX];
+} oe_syscall_batch_t;
+
+void oe_syscall_batch_init(oe_syscall_batch_t* batch);
+
+/* The queueing functions return the index of the operation in the batch, or
+ * -1 with oe_errno set to OE_EAGAIN if the batch is full. */
+int oe_syscall_batch_read(
+    oe_syscall_batch_t* batch,
+    int fd,
+    void* buf,
+    size_t count);
+
+int oe_syscall_batch_write(
+    oe_syscall_batch_t* batch,
+    int fd,
+    const void* buf,
+    size_t count);
+
+int oe_syscall_batch_recv(
+    oe_syscall_batch_t* batch,
+    int sockfd,
+    void* buf,
+    size_t len,
+    int flags);
+
+int oe_syscall_batch_send(
+    oe_syscall_batch_t* batch,
+    int sockfd,
+    const void* buf,
+    size_t len,
+    int flags);
+
+int oe_syscall_batch_close(oe_syscall_batch_t* batch, int fd);
+
+int oe_syscall_batch_fstat(
+    oe_syscall_batch_t* batch,
+    int fd,
+    struct oe_stat* buf);
+
+/* Performs the queued operations with one call to the host and empties the
+ * batch. Returns 0 if the host was called, in which case the outcome of each
+ * operation is given by oe_syscall_batch_result(). Otherwise returns -1 and
+ * sets oe_errno. */
+int oe_syscall_batch_submit(oe_syscall_batch_t* batch);
+
+/* Returns the result of the operation at index in the last submission, as
+ * the corresponding system call would. If it is -1, *error receives the
+ * error number. */
+ssize_t oe_syscall_batch_result(
+    const oe_syscall_batch_t* batch,
+    size_t index,
+    int* error);
+
+OE_EXTERNC_END
+
+#endif // _OE_SYSCALL_BATCH_H
@@ -8,6 +8,7 @@
 #include <openenclave/bits/types.h>
 #include <openenclave/internal/syscall/sys/epoll.h>
 #include <openenclave/internal/syscall/sys/socket.h>
+#include <openenclave/internal/syscall/sys/stat.h>
 #include <openenclave/internal/syscall/sys/uio.h>
 #include <openenclave/internal/syscall/types.h>
 
@@ -44,6 +45,11 @@ typedef struct _oe_fd_ops
     int (*close)(oe_fd_t* desc);
 
     oe_host_fd_t (*get_host_fd)(oe_fd_t* desc);
+
+    /* Optional. Frees the descriptor after a batch closed its host
+     * descriptor. Devices that implement it let batches (see batch.h)
+     * operate on the descriptor returned by get_host_fd() directly. */
+    void (*release)(oe_fd_t* desc);
 } oe_fd_ops_t;
 
 /* File operations. */
@@ -55,6 +61,35 @@ typedef struct _oe_file_ops
     oe_off_t (*lseek)(oe_fd_t* file, oe_off_t offset, int whence);
 
     int (*getdents64)(oe_fd_t* file, struct oe_dirent* dirp, uint32_t count);
+
+    /* The positional operations leave the file offset unchanged. */
+    ssize_t (*pread)(oe_fd_t* file, void* buf, size_t count, oe_off_t offset);
+
+    ssize_t (*pwrite)(
+        oe_fd_t* file,
+        const void* buf,
+        size_t count,
+        oe_off_t offset);
+
+    ssize_t (*preadv)(
+        oe_fd_t* file,
+        const struct oe_iovec* iov,
+        int iovcnt,
+        oe_off_t offset);
+
+    ssize_t (*pwritev)(
+        oe_fd_t* file,
+        const struct oe_iovec* iov,
+        int iovcnt,
+        oe_off_t offset);
+
+    int (*fstat)(oe_fd_t* file, struct oe_stat* buf);
+
+    int (*fsync)(oe_fd_t* file);
+
+    int (*fdatasync)(oe_fd_t* file);
+
+    int (*ftruncate)(oe_fd_t* file, oe_off_t length);
 } oe_file_ops_t;
 
 /* Socket operations .*/
@@ -65,6 +65,8 @@ int oe_stat(const char* pathname, struct oe_stat* buf);
 
 int oe_stat_d(uint64_t devid, const char* pathname, struct oe_stat* buf);
 
+int oe_fstat(int fd, struct oe_stat* buf);
+
 int oe_mkdir(const char* pathname, oe_mode_t mode);
 
 int oe_mkdir_d(uint64_t devid, const char* pathname, oe_mode_t mode);
@@ -47,6 +47,16 @@ int oe_truncate(const char* path, oe_off_t length);
 
 int oe_truncate_d(uint64_t devid, const char* path, oe_off_t length);
 
+ssize_t oe_pread(int fd, void* buf, size_t count, oe_off_t offset);
+
+ssize_t oe_pwrite(int fd, const void* buf, size_t count, oe_off_t offset);
+
+int oe_ftruncate(int fd, oe_off_t length);
+
+int oe_fsync(int fd);
+
+int oe_fdatasync(int fd);
+
 #endif /* !defined(WIN32) */
 
 int oe_link(const char* oldpath, const char* newpath);
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_INTERNAL_THREADPOOL_H
+#define _OE_INTERNAL_THREADPOOL_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Enclave thread pool
+**
+**     The host lends a fixed number of its threads to the enclave when the
+**     enclave is created. Each of them enters the enclave once, through
+**     OE_ECALL_THREAD_POOL_WORKER, and runs tasks that enclave threads
+**     submit to a queue in enclave memory until the enclave is terminated.
+**     Submitting a task never leaves the enclave unless a worker has to be
+**     woken up.
+**
+**     The pool never holds more tasks than it has workers, so that a task
+**     never waits behind another task for a worker.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_thread_pool_task oe_thread_pool_task_t;
+
+struct _oe_thread_pool_task
+{
+    /* Link in the queue of the pool */
+    oe_thread_pool_task_t* next;
+
+    /* Run by a worker */
+    void (*run)(oe_thread_pool_task_t* task);
+
+    /* Run by the worker after the pool has released the slot of the task,
+     * so that a new task can be submitted as soon as this one finishes. May
+     * be null. */
+    void (*finish)(oe_thread_pool_task_t* task);
+};
+
+/* Return the number of workers that the host lends to the enclave. */
+size_t oe_thread_pool_get_num_workers(void);
+
+/* Queue the task to run on a worker. Fails with OE_OUT_OF_THREADS if every
+ * worker already has a task, and with OE_UNSUPPORTED if the pool has no
+ * workers. */
+oe_result_t oe_thread_pool_submit(oe_thread_pool_task_t* task);
+
+/* Run the destructors of the pthread keys and the thread-local variables of
+ * the current thread, and set its thread-local variables back to their
+ * initial values, so that the next task of a worker starts out as a new
+ * thread would. Each platform implements this. */
+void oe_thread_pool_reset_thread(void);
+
+/* Handlers of the ECALLs of the thread pool */
+oe_result_t oe_handle_init_thread_pool(uint64_t arg_in);
+oe_result_t oe_handle_thread_pool_worker(void);
+oe_result_t oe_handle_stop_thread_pool(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_INTERNAL_THREADPOOL_H */
@@ -35,6 +35,57 @@ int oe_sleep_msec(uint64_t milliseconds);
 
 uint64_t oe_get_time(void);
 
+/*
+**==============================================================================
+**
+** oe_get_fresh_time()
+**
+**     Like oe_get_time(), but always asks the host for the current time
+**     through an OCALL rather than reading the time page, which may lag
+**     behind by up to its resolution. The time is returned as the host
+**     reports it, so it is not clamped like the time read from the page.
+**
+**==============================================================================
+*/
+
+uint64_t oe_get_fresh_time(void);
+
+/*
+**==============================================================================
+**
+** oe_time_page_t
+**
+**     A page of host memory that a host thread refreshes with the current
+**     time, so that the enclave can read the time without an OCALL. The
+**     enclave only ever reads the page, and never trusts the time to be more
+**     than a hint: time that goes backwards is clamped to the latest time
+**     that oe_get_time() read from the page.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_time_page
+{
+    /* Milliseconds elapsed since the Epoch, or 0 until the first update */
+    volatile uint64_t time_msec;
+
+    /* Milliseconds between updates of time_msec */
+    uint64_t resolution_msec;
+} oe_time_page_t;
+
+/*
+**==============================================================================
+**
+** oe_handle_init_time_page()
+**
+**     Handle the OE_ECALL_INIT_TIME_PAGE from the host, whose argument is the
+**     address of the oe_time_page_t.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_handle_init_time_page(uint64_t arg_in);
+
 OE_EXTERNC_END
 
 #endif /* _OE_INCLUDE_TIME_H */
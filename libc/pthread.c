@@ -8,7 +8,10 @@
 #include <openenclave/internal/pthreadhooks.h>
 #include <openenclave/internal/sgxtypes.h>
 #include <openenclave/internal/thread.h>
+#include <openenclave/internal/threadpool.h>
+#include <errno.h>
 #include <pthread.h>
+#include <stdlib.h>
 
 #ifdef pthread_equal
 #undef pthread_equal
@@ -41,18 +44,69 @@
 #undef pthread
 #endif
 
-OE_STATIC_ASSERT(sizeof(struct __pthread) <= OE_THREAD_LOCAL_SPACE);
 OE_STATIC_ASSERT(sizeof(pthread_once_t) == sizeof(oe_once_t));
 OE_STATIC_ASSERT(sizeof(pthread_spinlock_t) == sizeof(oe_spinlock_t));
 OE_STATIC_ASSERT(sizeof(pthread_mutex_t) >= sizeof(oe_mutex_t));
 OE_STATIC_ASSERT(sizeof(pthread_cond_t) >= sizeof(oe_cond_t));
 OE_STATIC_ASSERT(sizeof(pthread_rwlock_t) >= sizeof(oe_rwlock_t));
 
-static __thread struct __pthread _pthread_self = {.locale = C_LOCALE};
+/* Every pthread_t points to the start of a thread_header_t, so that the flag
+ * that tells the threads of the pool apart can be read from any of them */
+typedef struct _thread_header
+{
+    struct __pthread pthread;
+
+    /* POOL_THREAD_MAGIC for a thread of the pool, and 0 otherwise */
+    uint64_t magic;
+} thread_header_t;
+
+OE_STATIC_ASSERT(sizeof(thread_header_t) <= OE_THREAD_LOCAL_SPACE);
+
+static __thread thread_header_t _pthread_self = {
+    .pthread = {.locale = C_LOCALE}};
+
+/*
+**==============================================================================
+**
+** Threads of the enclave thread pool:
+**
+**     Unless the enclave registers its own hooks, pthread_create() runs the
+**     new thread on a worker of the thread pool that the host lends to the
+**     enclave (see threadpool.h). The thread runs on the TLS of its worker,
+**     which the worker resets after each thread, once the destructors of its
+**     pthread keys and thread-local variables have run.
+**
+**==============================================================================
+*/
+
+#define POOL_THREAD_MAGIC 0x8d2f5e61c3b7a904
+
+typedef struct _pool_thread
+{
+    /* The pthread_t of the thread points here, so this must come first */
+    thread_header_t base;
+
+    oe_thread_pool_task_t task;
+    void* (*start_routine)(void*);
+    void* arg;
+    void* retval;
+
+    /* Guards the fields below, which join and detach wait on */
+    oe_mutex_t mutex;
+    oe_cond_t cond;
+    bool done;
+    bool detached;
+} pool_thread_t;
+
+/* The pool thread that the current worker runs, if any */
+static __thread pool_thread_t* _current_pool_thread;
 
 pthread_t __pthread_self()
 {
-    return &_pthread_self;
+    if (_current_pool_thread)
+        return &_current_pool_thread->base.pthread;
+
+    return &_pthread_self.pthread;
 }
 
 OE_WEAK_ALIAS(__pthread_self, pthread_self);
@@ -64,39 +118,191 @@ void oe_register_pthread_hooks(oe_pthread_hooks_t* pthread_hooks)
     _pthread_hooks = pthread_hooks;
 }
 
+static pool_thread_t* _get_pool_thread(pthread_t thread)
+{
+    thread_header_t* header = (thread_header_t*)thread;
+
+    if (!header || header->magic != POOL_THREAD_MAGIC)
+        return NULL;
+
+    return (pool_thread_t*)header;
+}
+
+static void _free_pool_thread(pool_thread_t* pool_thread)
+{
+    oe_cond_destroy(&pool_thread->cond);
+    oe_mutex_destroy(&pool_thread->mutex);
+    pool_thread->base.magic = 0;
+    free(pool_thread);
+}
+
+static void _run_pool_thread(oe_thread_pool_task_t* task)
+{
+    pool_thread_t* pool_thread =
+        (pool_thread_t*)((uint8_t*)task - OE_OFFSETOF(pool_thread_t, task));
+
+    _current_pool_thread = pool_thread;
+    pool_thread->retval = pool_thread->start_routine(pool_thread->arg);
+    _current_pool_thread = NULL;
+}
+
+static void _finish_pool_thread(oe_thread_pool_task_t* task)
+{
+    pool_thread_t* pool_thread =
+        (pool_thread_t*)((uint8_t*)task - OE_OFFSETOF(pool_thread_t, task));
+    bool detached;
+
+    oe_mutex_lock(&pool_thread->mutex);
+    {
+        pool_thread->done = true;
+        detached = pool_thread->detached;
+        oe_cond_broadcast(&pool_thread->cond);
+    }
+    oe_mutex_unlock(&pool_thread->mutex);
+
+    /* Otherwise, the thread that joins this one frees it */
+    if (detached)
+        _free_pool_thread(pool_thread);
+}
+
+static int _create_pool_thread(
+    pthread_t* thread,
+    const pthread_attr_t* attr,
+    void* (*start_routine)(void*),
+    void* arg)
+{
+    pool_thread_t* pool_thread;
+
+    if (!thread || !start_routine)
+        return EINVAL;
+
+    if (!(pool_thread = calloc(1, sizeof(pool_thread_t))))
+        return EAGAIN;
+
+    pool_thread->base.pthread.locale = C_LOCALE;
+    pool_thread->base.magic = POOL_THREAD_MAGIC;
+    pool_thread->task.run = _run_pool_thread;
+    pool_thread->task.finish = _finish_pool_thread;
+    pool_thread->start_routine = start_routine;
+    pool_thread->arg = arg;
+    pool_thread->detached = attr && attr->_a_detach;
+    oe_mutex_init(&pool_thread->mutex);
+    oe_cond_init(&pool_thread->cond);
+
+    /* A detached thread may finish and be freed before this returns */
+    *thread = &pool_thread->base.pthread;
+
+    /* Fails when every worker already runs a thread */
+    if (oe_thread_pool_submit(&pool_thread->task) != OE_OK)
+    {
+        _free_pool_thread(pool_thread);
+        return EAGAIN;
+    }
+
+    return 0;
+}
+
+static int _join_pool_thread(pthread_t thread, void** retval)
+{
+    pool_thread_t* pool_thread = _get_pool_thread(thread);
+
+    if (!pool_thread)
+        return ESRCH;
+
+    if (pool_thread == _current_pool_thread)
+        return EDEADLK;
+
+    oe_mutex_lock(&pool_thread->mutex);
+    {
+        if (pool_thread->detached)
+        {
+            oe_mutex_unlock(&pool_thread->mutex);
+            return EINVAL;
+        }
+
+        while (!pool_thread->done)
+            oe_cond_wait(&pool_thread->cond, &pool_thread->mutex);
+    }
+    oe_mutex_unlock(&pool_thread->mutex);
+
+    if (retval)
+        *retval = pool_thread->retval;
+
+    _free_pool_thread(pool_thread);
+
+    return 0;
+}
+
+static int _detach_pool_thread(pthread_t thread)
+{
+    pool_thread_t* pool_thread = _get_pool_thread(thread);
+    bool done;
+
+    if (!pool_thread)
+        return ESRCH;
+
+    oe_mutex_lock(&pool_thread->mutex);
+    {
+        if (pool_thread->detached)
+        {
+            oe_mutex_unlock(&pool_thread->mutex);
+            return EINVAL;
+        }
+
+        pool_thread->detached = true;
+        done = pool_thread->done;
+    }
+    oe_mutex_unlock(&pool_thread->mutex);
+
+    /* Otherwise, the thread frees itself when it finishes */
+    if (done)
+        _free_pool_thread(pool_thread);
+
+    return 0;
+}
+
 int pthread_create(
     pthread_t* thread,
     const pthread_attr_t* attr,
     void* (*start_routine)(void*),
     void* arg)
 {
-    if (!_pthread_hooks || !_pthread_hooks->create)
+    if (_pthread_hooks && _pthread_hooks->create)
+        return _pthread_hooks->create(thread, attr, start_routine, arg);
+
+    if (oe_thread_pool_get_num_workers() == 0)
     {
         oe_assert("pthread_create(): panic" == NULL);
         return -1;
     }
 
-    return _pthread_hooks->create(thread, attr, start_routine, arg);
+    return _create_pool_thread(thread, attr, start_routine, arg);
 }
 
 int pthread_join(pthread_t thread, void** retval)
 {
-    if (!_pthread_hooks || !_pthread_hooks->join)
+    if (_pthread_hooks && _pthread_hooks->join)
+        return _pthread_hooks->join(thread, retval);
+
+    if (oe_thread_pool_get_num_workers() == 0)
     {
         oe_assert("pthread_join(): panic" == NULL);
         return -1;
     }
 
-    return _pthread_hooks->join(thread, retval);
+    return _join_pool_thread(thread, retval);
 }
 
 int pthread_detach(pthread_t thread)
 {
-    if (!_pthread_hooks || !_pthread_hooks->detach)
+    if (_pthread_hooks && _pthread_hooks->detach)
+        return _pthread_hooks->detach(thread);
+
+    if (oe_thread_pool_get_num_workers() == 0)
     {
         oe_assert("pthread_detach(): panic" == NULL);
         return -1;
     }
 
-    return _pthread_hooks->detach(thread);
+    return _detach_pool_thread(thread);
 }
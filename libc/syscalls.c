@@ -90,7 +90,7 @@ static long _syscall_gettimeofday(long n, long x1, long x2)
         goto done;
 
     tv->tv_sec = msec / _SEC_TO_MSEC;
-    tv->tv_usec = msec % _MSEC_TO_USEC;
+    tv->tv_usec = (msec % _SEC_TO_MSEC) * _MSEC_TO_USEC;
 
     ret = 0;
 
@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+
+#include <openenclave/internal/syscall/asyncio.h>
+#include <openenclave/internal/syscall/fd.h>
+#include <openenclave/internal/syscall/fdtable.h>
+#include <openenclave/internal/syscall/raise.h>
+
+static bool _blocking_mode;
+
+static int _submit(
+    oe_async_io_opcode_t opcode,
+    int fd,
+    void* buf,
+    size_t count,
+    int flags,
+    uint64_t user_data)
+{
+    int ret = -1;
+    oe_fd_t* desc;
+    oe_host_fd_t host_fd;
+
+    if (!oe_async_io_is_available())
+        OE_RAISE_ERRNO(OE_ENOSYS);
+
+    if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    if ((opcode == OE_ASYNC_IO_OP_RECV || opcode == OE_ASYNC_IO_OP_SEND) &&
+        desc->type != OE_FD_TYPE_SOCKET)
+    {
+        OE_RAISE_ERRNO(OE_ENOTSOCK);
+    }
+
+    /* Only descriptors that are backed by a host descriptor qualify. */
+    if (!desc->ops.fd.get_host_fd)
+        OE_RAISE_ERRNO(OE_ENOTSUP);
+
+    if ((host_fd = desc->ops.fd.get_host_fd(desc)) == -1)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    if (oe_async_io_submit_host(
+            opcode, host_fd, buf, count, flags, user_data) != 0)
+    {
+        OE_RAISE_ERRNO(oe_errno);
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+int oe_async_io_read(int fd, void* buf, size_t count, uint64_t user_data)
+{
+    return _submit(OE_ASYNC_IO_OP_READ, fd, buf, count, 0, user_data);
+}
+
+int oe_async_io_write(
+    int fd,
+    const void* buf,
+    size_t count,
+    uint64_t user_data)
+{
+    return _submit(OE_ASYNC_IO_OP_WRITE, fd, (void*)buf, count, 0, user_data);
+}
+
+int oe_async_io_recv(
+    int sockfd,
+    void* buf,
+    size_t len,
+    int flags,
+    uint64_t user_data)
+{
+    return _submit(OE_ASYNC_IO_OP_RECV, sockfd, buf, len, flags, user_data);
+}
+
+int oe_async_io_send(
+    int sockfd,
+    const void* buf,
+    size_t len,
+    int flags,
+    uint64_t user_data)
+{
+    return _submit(
+        OE_ASYNC_IO_OP_SEND, sockfd, (void*)buf, len, flags, user_data);
+}
+
+size_t oe_async_io_poll(oe_async_io_completion_t* completions, size_t count)
+{
+    return oe_async_io_reap(completions, count);
+}
+
+void oe_async_io_set_blocking_mode(bool enabled)
+{
+    _blocking_mode = enabled;
+}
+
+bool oe_async_io_get_blocking_mode(void)
+{
+    return _blocking_mode;
+}
+
+/*
+**==============================================================================
+**
+** oe_async_io_blocking_call()
+**
+**     Reads and writes may transfer fewer bytes than asked for, so a read is
+**     truncated to a single buffer, while a write is split into as many
+**     buffers as it takes. A receive that does not fit in a buffer is left to
+**     the OCALL, since its flags may ask for the whole buffer to be filled.
+**
+**==============================================================================
+*/
+
+bool oe_async_io_blocking_call(
+    oe_async_io_opcode_t opcode,
+    oe_host_fd_t host_fd,
+    void* buf,
+    size_t count,
+    int flags,
+    ssize_t* ret)
+{
+    size_t buffer_size = oe_async_io_get_buffer_size();
+    uint8_t* p = (uint8_t*)buf;
+    size_t total = 0;
+
+    if (!_blocking_mode || !oe_async_io_is_available())
+        return false;
+
+    if (opcode == OE_ASYNC_IO_OP_RECV && count > buffer_size)
+        return false;
+
+    if (opcode == OE_ASYNC_IO_OP_READ || opcode == OE_ASYNC_IO_OP_RECV)
+        return oe_async_io_call_host(opcode, host_fd, buf, count, flags, ret);
+
+    do
+    {
+        size_t n = count - total;
+        ssize_t result;
+
+        if (n > buffer_size)
+            n = buffer_size;
+
+        if (!oe_async_io_call_host(opcode, host_fd, p, n, flags, &result))
+        {
+            /* Let the OCALL perform the whole write if nothing was written. */
+            if (total == 0)
+                return false;
+
+            break;
+        }
+
+        if (result == -1)
+        {
+            /* Report the bytes that were written before the error. */
+            if (total == 0)
+            {
+                *ret = -1;
+                return true;
+            }
+
+            break;
+        }
+
+        total += (size_t)result;
+        p += result;
+
+        if ((size_t)result < n)
+            break;
+    } while (total < count);
+
+    *ret = (ssize_t)total;
+    return true;
+}
@@ -0,0 +1,437 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+
+#include <openenclave/bits/safecrt.h>
+#include <openenclave/bits/safemath.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/syscall/batch.h>
+#include <openenclave/internal/syscall/fd.h>
+#include <openenclave/internal/syscall/fdtable.h>
+#include <openenclave/internal/syscall/raise.h>
+#include "syscall_t.h"
+
+/* The state of a queued operation while the batch is submitted. */
+typedef struct _pending
+{
+    /* The descriptor, or NULL if the operation is not sent to the host. */
+    oe_fd_t* desc;
+    oe_host_fd_t host_fd;
+    size_t sqe_index;
+} pending_t;
+
+void oe_syscall_batch_init(oe_syscall_batch_t* batch)
+{
+    if (batch)
+        oe_memset_s(batch, sizeof(*batch), 0, sizeof(*batch));
+}
+
+static int _queue(
+    oe_syscall_batch_t* batch,
+    oe_syscall_batch_opcode_t opcode,
+    int fd,
+    void* buf,
+    size_t count,
+    int flags)
+{
+    int ret = -1;
+    oe_syscall_batch_op_t* op;
+
+    if (!batch || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (batch->count == OE_SYSCALL_BATCH_MAX)
+        OE_RAISE_ERRNO(OE_EAGAIN);
+
+    op = &batch->ops[batch->count];
+    op->opcode = opcode;
+    op->fd = fd;
+    op->flags = flags;
+    op->buf = buf;
+    op->count = count;
+
+    ret = (int)batch->count++;
+
+done:
+    return ret;
+}
+
+int oe_syscall_batch_read(
+    oe_syscall_batch_t* batch,
+    int fd,
+    void* buf,
+    size_t count)
+{
+    return _queue(batch, OE_SYSCALL_BATCH_OP_READ, fd, buf, count, 0);
+}
+
+int oe_syscall_batch_write(
+    oe_syscall_batch_t* batch,
+    int fd,
+    const void* buf,
+    size_t count)
+{
+    return _queue(batch, OE_SYSCALL_BATCH_OP_WRITE, fd, (void*)buf, count, 0);
+}
+
+int oe_syscall_batch_recv(
+    oe_syscall_batch_t* batch,
+    int sockfd,
+    void* buf,
+    size_t len,
+    int flags)
+{
+    return _queue(batch, OE_SYSCALL_BATCH_OP_RECV, sockfd, buf, len, flags);
+}
+
+int oe_syscall_batch_send(
+    oe_syscall_batch_t* batch,
+    int sockfd,
+    const void* buf,
+    size_t len,
+    int flags)
+{
+    return _queue(
+        batch, OE_SYSCALL_BATCH_OP_SEND, sockfd, (void*)buf, len, flags);
+}
+
+int oe_syscall_batch_close(oe_syscall_batch_t* batch, int fd)
+{
+    return _queue(batch, OE_SYSCALL_BATCH_OP_CLOSE, fd, NULL, 0, 0);
+}
+
+int oe_syscall_batch_fstat(
+    oe_syscall_batch_t* batch,
+    int fd,
+    struct oe_stat* buf)
+{
+    if (!buf)
+    {
+        oe_errno = OE_EINVAL;
+        return -1;
+    }
+
+    return _queue(batch, OE_SYSCALL_BATCH_OP_FSTAT, fd, buf, sizeof(*buf), 0);
+}
+
+static bool _is_input(oe_syscall_batch_opcode_t opcode)
+{
+    return opcode == OE_SYSCALL_BATCH_OP_WRITE ||
+           opcode == OE_SYSCALL_BATCH_OP_SEND;
+}
+
+/*
+**==============================================================================
+**
+** _resolve()
+**
+**     Find the host descriptor of the operation at index, or return the error
+**     number that the operation fails with. Operations on a descriptor that
+**     is closed earlier in the batch are rejected, as the host may reuse the
+**     descriptor number.
+**
+**==============================================================================
+*/
+
+static int _resolve(
+    const oe_syscall_batch_t* batch,
+    const pending_t* pending,
+    size_t index,
+    oe_fd_t** desc_out,
+    oe_host_fd_t* host_fd_out)
+{
+    const oe_syscall_batch_op_t* op = &batch->ops[index];
+    oe_fd_t* desc;
+    oe_host_fd_t host_fd;
+
+    switch (op->opcode)
+    {
+        case OE_SYSCALL_BATCH_OP_READ:
+        case OE_SYSCALL_BATCH_OP_WRITE:
+        case OE_SYSCALL_BATCH_OP_RECV:
+        case OE_SYSCALL_BATCH_OP_SEND:
+        case OE_SYSCALL_BATCH_OP_CLOSE:
+        case OE_SYSCALL_BATCH_OP_FSTAT:
+            break;
+        default:
+            return OE_EINVAL;
+    }
+
+    if (!(desc = oe_fdtable_get(op->fd, OE_FD_TYPE_ANY)))
+        return OE_EBADF;
+
+    if (!desc->ops.fd.release || !desc->ops.fd.get_host_fd)
+        return OE_ENOTSUP;
+
+    if ((op->opcode == OE_SYSCALL_BATCH_OP_RECV ||
+         op->opcode == OE_SYSCALL_BATCH_OP_SEND) &&
+        desc->type != OE_FD_TYPE_SOCKET)
+    {
+        return OE_ENOTSOCK;
+    }
+
+    if (op->opcode == OE_SYSCALL_BATCH_OP_FSTAT &&
+        desc->type != OE_FD_TYPE_FILE)
+    {
+        return OE_ENOTSUP;
+    }
+
+    if ((host_fd = desc->ops.fd.get_host_fd(desc)) == -1)
+        return OE_EBADF;
+
+    for (size_t i = 0; i < index; i++)
+    {
+        if (pending[i].desc == desc &&
+            batch->ops[i].opcode == OE_SYSCALL_BATCH_OP_CLOSE)
+        {
+            return OE_EBADF;
+        }
+    }
+
+    *desc_out = desc;
+    *host_fd_out = host_fd;
+    return 0;
+}
+
+/*
+**==============================================================================
+**
+** _complete()
+**
+**     Check the completion of an operation, which the host filled in, the way
+**     the corresponding OCALL is checked, and copy out its data.
+**
+**==============================================================================
+*/
+
+static void _complete(
+    oe_syscall_batch_t* batch,
+    size_t index,
+    const pending_t* pending,
+    const struct oe_syscall_batch_sqe* sqe,
+    const struct oe_syscall_batch_cqe* cqe,
+    const uint8_t* out_data)
+{
+    const oe_syscall_batch_op_t* op = &batch->ops[index];
+    int64_t result = cqe->result;
+    int error = cqe->error;
+
+    batch->results[index] = -1;
+    batch->errors[index] = OE_EINVAL;
+
+    if (result == -1)
+    {
+        /* The host must report why the operation failed. */
+        if (error > 0)
+            batch->errors[index] = error;
+        return;
+    }
+
+    switch (op->opcode)
+    {
+        case OE_SYSCALL_BATCH_OP_READ:
+        case OE_SYSCALL_BATCH_OP_RECV:
+        {
+            if (result < 0 || (uint64_t)result > op->count)
+                return;
+
+            oe_memcpy_s(
+                op->buf,
+                op->count,
+                out_data + sqe->data_offset,
+                (size_t)result);
+            break;
+        }
+        case OE_SYSCALL_BATCH_OP_WRITE:
+        case OE_SYSCALL_BATCH_OP_SEND:
+        {
+            if (result < 0 || (uint64_t)result > op->count)
+                return;
+            break;
+        }
+        case OE_SYSCALL_BATCH_OP_FSTAT:
+        {
+            if (result != 0)
+                return;
+
+            oe_memcpy_s(
+                op->buf, op->count, out_data + sqe->data_offset, op->count);
+            break;
+        }
+        case OE_SYSCALL_BATCH_OP_CLOSE:
+        {
+            if (result != 0)
+                return;
+
+            /* Free the descriptor as oe_close() would. */
+            pending->desc->ops.fd.release(pending->desc);
+            oe_fdtable_release(op->fd);
+            break;
+        }
+        default:
+            return;
+    }
+
+    batch->results[index] = (ssize_t)result;
+    batch->errors[index] = 0;
+}
+
+int oe_syscall_batch_submit(oe_syscall_batch_t* batch)
+{
+    int ret = -1;
+    pending_t pending[OE_SYSCALL_BATCH_MAX];
+    struct oe_syscall_batch_sqe* sqes = NULL;
+    struct oe_syscall_batch_cqe* cqes = NULL;
+    uint8_t* in_data = NULL;
+    uint8_t* out_data = NULL;
+    size_t in_size = 0;
+    size_t out_size = 0;
+    size_t num_sqes = 0;
+    int retval = -1;
+
+    if (!batch || batch->count > OE_SYSCALL_BATCH_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    batch->num_results = 0;
+
+    /* Resolve the descriptors and lay out the data of each operation. */
+    for (size_t i = 0; i < batch->count; i++)
+    {
+        const oe_syscall_batch_op_t* op = &batch->ops[i];
+        size_t* size = _is_input(op->opcode) ? &in_size : &out_size;
+        int error;
+
+        pending[i].desc = NULL;
+        pending[i].host_fd = -1;
+        pending[i].sqe_index = num_sqes;
+
+        error = _resolve(
+            batch, pending, i, &pending[i].desc, &pending[i].host_fd);
+
+        batch->results[i] = -1;
+        batch->errors[i] = error;
+
+        if (error)
+            continue;
+
+        if (oe_safe_add_sizet(*size, op->count, size) != OE_OK)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        num_sqes++;
+    }
+
+    if (num_sqes > 0)
+    {
+        size_t in_offset = 0;
+        size_t out_offset = 0;
+
+        if (!(sqes = oe_calloc(num_sqes, sizeof(*sqes))) ||
+            !(cqes = oe_calloc(num_sqes, sizeof(*cqes))))
+        {
+            OE_RAISE_ERRNO(OE_ENOMEM);
+        }
+
+        if ((in_size && !(in_data = oe_malloc(in_size))) ||
+            (out_size && !(out_data = oe_malloc(out_size))))
+        {
+            OE_RAISE_ERRNO(OE_ENOMEM);
+        }
+
+        for (size_t i = 0; i < batch->count; i++)
+        {
+            const oe_syscall_batch_op_t* op = &batch->ops[i];
+            struct oe_syscall_batch_sqe* sqe = &sqes[pending[i].sqe_index];
+
+            if (!pending[i].desc)
+                continue;
+
+            sqe->opcode = (uint32_t)op->opcode;
+            sqe->flags = op->flags;
+            sqe->fd = pending[i].host_fd;
+            sqe->data_size = op->count;
+
+            if (_is_input(op->opcode))
+            {
+                sqe->data_offset = in_offset;
+                oe_memcpy_s(
+                    in_data + in_offset,
+                    in_size - in_offset,
+                    op->buf,
+                    op->count);
+                in_offset += op->count;
+            }
+            else
+            {
+                sqe->data_offset = out_offset;
+                out_offset += op->count;
+            }
+        }
+
+        if (oe_syscall_batch_ocall(
+                &retval,
+                sqes,
+                cqes,
+                num_sqes,
+                in_data,
+                in_size,
+                out_data,
+                out_size) != OE_OK)
+        {
+            OE_RAISE_ERRNO(OE_EINVAL);
+        }
+
+        if (retval != 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        for (size_t i = 0; i < batch->count; i++)
+        {
+            size_t j = pending[i].sqe_index;
+
+            if (pending[i].desc)
+                _complete(batch, i, &pending[i], &sqes[j], &cqes[j], out_data);
+        }
+    }
+
+    batch->num_results = batch->count;
+    batch->count = 0;
+    ret = 0;
+
+done:
+
+    if (sqes)
+        oe_free(sqes);
+
+    if (cqes)
+        oe_free(cqes);
+
+    if (in_data)
+        oe_free(in_data);
+
+    if (out_data)
+        oe_free(out_data);
+
+    return ret;
+}
+
+ssize_t oe_syscall_batch_result(
+    const oe_syscall_batch_t* batch,
+    size_t index,
+    int* error)
+{
+    if (error)
+        *error = 0;
+
+    if (!batch || index >= batch->num_results)
+    {
+        if (error)
+            *error = OE_EINVAL;
+        return -1;
+    }
+
+    if (error)
+        *error = batch->errors[index];
+
+    return batch->results[index];
+}
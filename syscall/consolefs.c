@@ -312,6 +312,14 @@ done:
     return ret;
 }
 
+static void _consolefs_release(oe_fd_t* file_)
+{
+    file_t* file = _cast_file(file_);
+
+    if (file)
+        oe_free(file);
+}
+
 static oe_off_t _consolefs_lseek(oe_fd_t* file_, oe_off_t offset, int whence)
 {
     oe_off_t ret = -1;
@@ -365,6 +373,106 @@ done:
     return -1;
 }
 
+/* The standard devices are not seekable, so positional IO is unsupported. */
+static ssize_t _consolefs_pread(
+    oe_fd_t* file,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    OE_UNUSED(file);
+    OE_UNUSED(buf);
+    OE_UNUSED(count);
+    OE_UNUSED(offset);
+    OE_RAISE_ERRNO(OE_ESPIPE);
+
+done:
+    return -1;
+}
+
+static ssize_t _consolefs_pwrite(
+    oe_fd_t* file,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    OE_UNUSED(file);
+    OE_UNUSED(buf);
+    OE_UNUSED(count);
+    OE_UNUSED(offset);
+    OE_RAISE_ERRNO(OE_ESPIPE);
+
+done:
+    return -1;
+}
+
+static ssize_t _consolefs_preadv(
+    oe_fd_t* file,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset)
+{
+    OE_UNUSED(file);
+    OE_UNUSED(iov);
+    OE_UNUSED(iovcnt);
+    OE_UNUSED(offset);
+    OE_RAISE_ERRNO(OE_ESPIPE);
+
+done:
+    return -1;
+}
+
+static ssize_t _consolefs_pwritev(
+    oe_fd_t* file,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset)
+{
+    OE_UNUSED(file);
+    OE_UNUSED(iov);
+    OE_UNUSED(iovcnt);
+    OE_UNUSED(offset);
+    OE_RAISE_ERRNO(OE_ESPIPE);
+
+done:
+    return -1;
+}
+
+static int _consolefs_fstat(oe_fd_t* file_, struct oe_stat* buf)
+{
+    int ret = -1;
+    file_t* file = _cast_file(file_);
+
+    if (!file || !buf)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (oe_syscall_fstat_ocall(&ret, file->host_fd, buf) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+done:
+    return ret;
+}
+
+/* The standard devices do not support synchronization or truncation. */
+static int _consolefs_fsync(oe_fd_t* file)
+{
+    OE_UNUSED(file);
+    OE_RAISE_ERRNO(OE_EINVAL);
+
+done:
+    return -1;
+}
+
+static int _consolefs_ftruncate(oe_fd_t* file, oe_off_t length)
+{
+    OE_UNUSED(file);
+    OE_UNUSED(length);
+    OE_RAISE_ERRNO(OE_EINVAL);
+
+done:
+    return -1;
+}
+
 static oe_file_ops_t _ops = {
     .fd.read = _consolefs_read,
     .fd.write = _consolefs_write,
@@ -375,8 +483,17 @@ static oe_file_ops_t _ops = {
     .fd.fcntl = _consolefs_fcntl,
     .fd.close = _consolefs_close,
     .fd.get_host_fd = _consolefs_gethostfd,
+    .fd.release = _consolefs_release,
     .lseek = _consolefs_lseek,
     .getdents64 = _consolefs_getdents64,
+    .pread = _consolefs_pread,
+    .pwrite = _consolefs_pwrite,
+    .preadv = _consolefs_preadv,
+    .pwritev = _consolefs_pwritev,
+    .fstat = _consolefs_fstat,
+    .fsync = _consolefs_fsync,
+    .fdatasync = _consolefs_fsync,
+    .ftruncate = _consolefs_ftruncate,
 };
 
 static oe_file_ops_t _get_ops(void)
@@ -21,8 +21,11 @@
 #include <openenclave/internal/utils.h>
 #include "syscall_t.h"
 
-/* The map allocation grows in multiples of the chunk size. */
-#define MAP_CHUNK_SIZE 1024
+/* The initial capacity of the map, which must be a power of two. */
+#define MAP_MIN_CAPACITY 64
+
+/* Marks the unused slots of the map. */
+#define MAP_EMPTY_FD -1
 
 #define DEVICE_MAGIC 0x4504f4c
 #define EPOLL_MAGIC 0x708f5a51
@@ -30,7 +33,7 @@
 /* epoll_ctl() adds/modifies/deletes this mapping. */
 typedef struct _mapping
 {
-    /* The fd parameter from epoll_ctl(). */
+    /* The fd parameter from epoll_ctl(), or MAP_EMPTY_FD. */
     int fd;
 
     /* The event parameter from epoll_ctl(). */
@@ -56,7 +59,9 @@ typedef struct _epoll
     /* The host file descriptor created by epoll_create(). */
     oe_host_fd_t host_fd;
 
-    /* Mappings added by epoll_ctl(OE_EPOLL_CTL_ADD) */
+    /* Mappings added by epoll_ctl(OE_EPOLL_CTL_ADD), kept in an open
+     * addressing hash table keyed by fd, which is never more than half
+     * full. */
     mapping_t* map;
     size_t map_size;
     size_t map_capacity;
@@ -87,35 +92,71 @@ static epoll_t* _cast_epoll(const oe_fd_t* epoll_)
     return epoll;
 }
 
-/* Reserve space in the mapping array (does not change map_size). */
-static int _map_reserve(epoll_t* epoll, size_t new_capacity)
+/* Get the slot where the lookup of the given fd starts. File descriptors
+ * are small and dense, so they serve as their own hash. */
+static size_t _map_slot(size_t capacity, int fd)
 {
-    int ret = -1;
+    return (size_t)(unsigned int)fd & (capacity - 1);
+}
+
+/* Find the slot that holds the given fd, or the empty slot where it would
+ * be inserted. The map must have at least one empty slot. */
+static mapping_t* _map_probe(mapping_t* map, size_t capacity, int fd)
+{
+    size_t i = _map_slot(capacity, fd);
+
+    while (map[i].fd != fd && map[i].fd != MAP_EMPTY_FD)
+        i = (i + 1) & (capacity - 1);
+
+    return &map[i];
+}
+
+/* Allocate an empty map with the given capacity. */
+static mapping_t* _map_new(size_t capacity)
+{
+    mapping_t* map;
+
+    if (!(map = oe_calloc(capacity, sizeof(mapping_t))))
+        return NULL;
+
+    for (size_t i = 0; i < capacity; i++)
+        map[i].fd = MAP_EMPTY_FD;
+
+    return map;
+}
 
-    new_capacity = oe_round_up_to_multiple(new_capacity, MAP_CHUNK_SIZE);
+/* Make room for one more mapping (does not change map_size). */
+static int _map_reserve(epoll_t* epoll)
+{
+    int ret = -1;
+    mapping_t* map = NULL;
+    size_t capacity;
 
-    if (new_capacity > epoll->map_capacity)
+    /* Keep the load factor at or below one half. */
+    if (2 * (epoll->map_size + 1) <= epoll->map_capacity)
     {
-        mapping_t* p;
-        const size_t n = new_capacity;
+        ret = 0;
+        goto done;
+    }
 
-        /* Reallocate the table. */
-        if (!(p = oe_realloc(epoll->map, n * sizeof(mapping_t))))
-            goto done;
+    capacity = epoll->map_capacity ? 2 * epoll->map_capacity : MAP_MIN_CAPACITY;
 
-        /* Zero-fill the unused portion. */
-        {
-            const size_t num_bytes = (n - epoll->map_size) * sizeof(mapping_t);
-            void* ptr = p + epoll->map_size;
+    if (!(map = _map_new(capacity)))
+        goto done;
 
-            if (oe_memset_s(ptr, num_bytes, 0, num_bytes) != OE_OK)
-                goto done;
-        }
+    /* Rehash the mappings into the new table. */
+    for (size_t i = 0; i < epoll->map_capacity; i++)
+    {
+        const mapping_t* mapping = &epoll->map[i];
 
-        epoll->map = p;
-        epoll->map_capacity = n;
+        if (mapping->fd != MAP_EMPTY_FD)
+            *_map_probe(map, capacity, mapping->fd) = *mapping;
     }
 
+    oe_free(epoll->map);
+    epoll->map = map;
+    epoll->map_capacity = capacity;
+
     ret = 0;
 
 done:
@@ -125,18 +166,49 @@ done:
 /* Find the mapping for the given file descriptor. */
 static mapping_t* _map_find(epoll_t* epoll, int fd)
 {
+    mapping_t* mapping;
+
+    if (!epoll->map || fd == MAP_EMPTY_FD)
+        return NULL;
+
+    mapping = _map_probe(epoll->map, epoll->map_capacity, fd);
+
+    return mapping->fd == fd ? mapping : NULL;
+}
+
+/* Remove the mapping for the given file descriptor. Since the map uses
+ * linear probing, the mappings that follow in the same cluster are shifted
+ * back so that lookups never stop early at the freed slot. */
+static bool _map_remove(epoll_t* epoll, int fd)
+{
+    const size_t mask = epoll->map_capacity - 1;
+    mapping_t* map = epoll->map;
+    mapping_t* mapping;
     size_t i;
+    size_t j;
+
+    if (!(mapping = _map_find(epoll, fd)))
+        return false;
 
-    for (i = 0; i < epoll->map_size; i++)
+    i = (size_t)(mapping - map);
+
+    for (j = (i + 1) & mask; map[j].fd != MAP_EMPTY_FD; j = (j + 1) & mask)
     {
-        mapping_t* mapping = &epoll->map[i];
+        size_t k = _map_slot(epoll->map_capacity, map[j].fd);
+
+        /* Move the mapping at j into the hole at i, unless its home slot k
+         * lies cyclically within (i, j], where it is still reachable. */
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
 
-        if (mapping->fd == fd)
-            return mapping;
+        map[i] = map[j];
+        i = j;
     }
 
-    /* Not found */
-    return NULL;
+    map[i].fd = MAP_EMPTY_FD;
+    epoll->map_size--;
+
+    return true;
 }
 
 /* Called by oe_epoll_create1(). */
@@ -233,15 +305,21 @@ static int _epoll_ctl_add(epoll_t* epoll, int fd, struct oe_epoll_event* event)
 
     if (retval == 0)
     {
+        mapping_t* mapping;
+
         oe_spin_lock(&epoll->lock);
         locked = true;
 
-        if (_map_reserve(epoll, epoll->map_size + 1) != 0)
+        if (_map_reserve(epoll) != 0)
             OE_RAISE_ERRNO(OE_ENOMEM);
 
-        epoll->map[epoll->map_size].fd = fd;
-        epoll->map[epoll->map_size].event = *event;
-        epoll->map_size++;
+        mapping = _map_probe(epoll->map, epoll->map_capacity, fd);
+
+        if (mapping->fd == MAP_EMPTY_FD)
+            epoll->map_size++;
+
+        mapping->fd = fd;
+        mapping->event = *event;
     }
 
     ret = retval;
@@ -355,18 +433,7 @@ static int _epoll_ctl_del(epoll_t* epoll, int fd)
         bool found = false;
 
         oe_spin_lock(&epoll->lock);
-        {
-            for (size_t i = 0; epoll->map_size; i++)
-            {
-                if (epoll->map[i].fd == fd)
-                {
-                    /* Swap with last element of array. */
-                    epoll->map[i] = epoll->map[--epoll->map_size];
-                    found = true;
-                    break;
-                }
-            }
-        }
+        found = _map_remove(epoll, fd);
         oe_spin_unlock(&epoll->lock);
 
         if (!found)
@@ -454,24 +521,28 @@ static int _epoll_wait(
 
     if (retval > 0)
     {
+        const mapping_t* mapping = NULL;
+
         if (retval > maxevents)
             OE_RAISE_ERRNO(OE_EINVAL);
 
-        for (int i = 0; i < retval; i++)
+        /* Translate all of the events under a single lock acquisition. */
+        oe_spin_lock(&epoll->lock);
         {
-            struct oe_epoll_event* event = &events[i];
-            const mapping_t* mapping;
-
-            oe_spin_lock(&epoll->lock);
+            for (int i = 0; i < retval; i++)
             {
-                if ((mapping = _map_find(epoll, event->data.fd)))
-                    event->data.u64 = mapping->event.data.u64;
-            }
-            oe_spin_unlock(&epoll->lock);
+                struct oe_epoll_event* event = &events[i];
+
+                if (!(mapping = _map_find(epoll, event->data.fd)))
+                    break;
 
-            if (!mapping)
-                OE_RAISE_ERRNO(OE_ENOENT);
+                event->data.u64 = mapping->event.data.u64;
+            }
         }
+        oe_spin_unlock(&epoll->lock);
+
+        if (!mapping)
+            OE_RAISE_ERRNO(OE_ENOENT);
     }
 
     ret = (int)retval;
@@ -769,18 +840,27 @@ static int _epoll_dup(oe_fd_t* epoll_, oe_fd_t** new_epoll_out)
         new_epoll->magic = EPOLL_MAGIC;
         new_epoll->host_fd = retval;
 
+        oe_spin_lock(&epoll->lock);
+
         if (epoll->map && epoll->map_size)
         {
+            const size_t capacity = epoll->map_capacity;
             mapping_t* map;
 
-            if (!(map = oe_calloc(epoll->map_size, sizeof(mapping_t))))
+            if (!(map = oe_calloc(capacity, sizeof(mapping_t))))
+            {
+                oe_spin_unlock(&epoll->lock);
                 OE_RAISE_ERRNO(OE_ENOMEM);
+            }
 
-            memcpy(map, epoll->map, epoll->map_size * sizeof(mapping_t));
+            memcpy(map, epoll->map, capacity * sizeof(mapping_t));
             new_epoll->map = map;
             new_epoll->map_size = epoll->map_size;
+            new_epoll->map_capacity = capacity;
         }
 
+        oe_spin_unlock(&epoll->lock);
+
         *new_epoll_out = &new_epoll->base;
         new_epoll = NULL;
     }
@@ -21,6 +21,7 @@
 #include <openenclave/enclave.h>
 // clang-format on
 
+#include <openenclave/internal/syscall/asyncio.h>
 #include <openenclave/internal/syscall/device.h>
 #include <openenclave/internal/thread.h>
 #include <openenclave/internal/syscall/dirent.h>
@@ -41,6 +42,10 @@
 #define FILE_MAGIC 0xfe48c6ff
 #define DIR_MAGIC 0x8add1b0b
 
+/* The number of directory entries that readdir() fetches from the host at
+ * once. */
+#define DIRENT_CACHE_SIZE 32
+
 /* Mask to extract the access mode: O_RDONLY, O_WRONLY, O_RDWR. */
 #define ACCESS_MODE_MASK 000000003
 
@@ -90,8 +95,11 @@ typedef struct _dir
     /* The directory handle obtained from the host by opendir(). */
     uint64_t host_dir;
 
-    /* The directory entry obtained from the host by readdir(). */
-    struct oe_dirent entry;
+    /* The directory entries obtained from the host, of which the first
+     * num_entries are valid and next_entry is returned by readdir(). */
+    struct oe_dirent entries[DIRENT_CACHE_SIZE];
+    size_t num_entries;
+    size_t next_entry;
 } dir_t;
 
 static oe_file_ops_t _get_file_ops(void);
@@ -483,6 +491,13 @@ static ssize_t _hostfs_read(oe_fd_t* desc, void* buf, size_t count)
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Perform the read() through the asynchronous I/O rings if enabled. */
+    if (oe_async_io_blocking_call(
+            OE_ASYNC_IO_OP_READ, file->host_fd, buf, count, 0, &ret))
+    {
+        goto done;
+    }
+
     /* Call the host to perform the read(). */
     if (oe_syscall_read_ocall(&ret, file->host_fd, buf, count) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -544,6 +559,13 @@ static ssize_t _hostfs_write(oe_fd_t* desc, const void* buf, size_t count)
     if (!file || (count && !buf))
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Perform the write() through the asynchronous I/O rings if enabled. */
+    if (oe_async_io_blocking_call(
+            OE_ASYNC_IO_OP_WRITE, file->host_fd, (void*)buf, count, 0, &ret))
+    {
+        goto done;
+    }
+
     /* Call the host. */
     if (oe_syscall_write_ocall(&ret, file->host_fd, buf, count) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -623,6 +645,227 @@ done:
     return ret;
 }
 
+/* Get the file for desc, or fail with errnum if it is an open directory,
+ * which has no host file descriptor. */
+static file_t* _cast_host_file(const oe_fd_t* desc, int errnum)
+{
+    file_t* ret = NULL;
+    file_t* file = _cast_file(desc);
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (file->dir)
+        OE_RAISE_ERRNO(errnum);
+
+    ret = file;
+
+done:
+    return ret;
+}
+
+/* The host performs the positional operations in a single call, without
+ * moving the file offset, so concurrent readers can share a file. */
+static ssize_t _hostfs_pread(
+    oe_fd_t* desc,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_host_file(desc, OE_EISDIR);
+
+    if (!file || (count && !buf) || offset < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (oe_syscall_pread_ocall(&ret, file->host_fd, buf, count, offset) !=
+        OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+done:
+    return ret;
+}
+
+static ssize_t _hostfs_pwrite(
+    oe_fd_t* desc,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_host_file(desc, OE_EISDIR);
+
+    if (!file || (count && !buf) || offset < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (oe_syscall_pwrite_ocall(&ret, file->host_fd, buf, count, offset) !=
+        OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+done:
+    return ret;
+}
+
+static ssize_t _hostfs_preadv(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_host_file(desc, OE_EISDIR);
+    void* buf = NULL;
+    size_t buf_size = 0;
+
+    if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX ||
+        offset < 0)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    /* Flatten the IO vector into contiguous heap memory. */
+    if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    /* Call the host. */
+    if (oe_syscall_preadv_ocall(
+            &ret, file->host_fd, buf, iovcnt, buf_size, offset) != OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    /* Synchronize data read with IO vector. */
+    if (ret > 0)
+    {
+        if (oe_iov_sync(iov, iovcnt, buf, buf_size) != 0)
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+done:
+
+    if (buf)
+        oe_free(buf);
+
+    return ret;
+}
+
+static ssize_t _hostfs_pwritev(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_host_file(desc, OE_EISDIR);
+    void* buf = NULL;
+    size_t buf_size = 0;
+
+    if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX ||
+        offset < 0)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    /* Flatten the IO vector into contiguous heap memory. */
+    if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    /* Call the host. */
+    if (oe_syscall_pwritev_ocall(
+            &ret, file->host_fd, buf, iovcnt, buf_size, offset) != OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+done:
+
+    if (buf)
+        oe_free(buf);
+
+    return ret;
+}
+
+/* Open directories keep no host file descriptor, so they cannot be
+ * queried with fstat(). */
+static int _hostfs_fstat(oe_fd_t* desc, struct oe_stat* buf)
+{
+    int ret = -1;
+    file_t* file = _cast_host_file(desc, OE_ENOTSUP);
+    int retval = -1;
+
+    if (buf)
+        oe_memset_s(buf, sizeof(*buf), 0, sizeof(*buf));
+
+    if (!file || !buf)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (oe_syscall_fstat_ocall(&retval, file->host_fd, buf) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = retval;
+
+done:
+    return ret;
+}
+
+static int _hostfs_fsync(oe_fd_t* desc)
+{
+    int ret = -1;
+    file_t* file = _cast_host_file(desc, OE_EINVAL);
+    int retval = -1;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (oe_syscall_fsync_ocall(&retval, file->host_fd) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = retval;
+
+done:
+    return ret;
+}
+
+static int _hostfs_fdatasync(oe_fd_t* desc)
+{
+    int ret = -1;
+    file_t* file = _cast_host_file(desc, OE_EINVAL);
+    int retval = -1;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (oe_syscall_fdatasync_ocall(&retval, file->host_fd) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = retval;
+
+done:
+    return ret;
+}
+
+static int _hostfs_ftruncate(oe_fd_t* desc, oe_off_t length)
+{
+    int ret = -1;
+    file_t* file = _cast_host_file(desc, OE_EINVAL);
+    int retval = -1;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (oe_syscall_ftruncate_ocall(&retval, file->host_fd, length) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = retval;
+
+done:
+    return ret;
+}
+
 static oe_off_t _hostfs_lseek_file(oe_fd_t* desc, oe_off_t offset, int whence)
 {
     oe_off_t ret = -1;
@@ -650,6 +893,10 @@ static int _hostfs_rewinddir(oe_fd_t* desc)
     if (oe_syscall_rewinddir_ocall(dir->host_dir) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Drop the entries that were read ahead. */
+    dir->num_entries = 0;
+    dir->next_entry = 0;
+
     ret = 0;
 
 done:
@@ -890,18 +1137,17 @@ done:
     return ret;
 }
 
-/* Get the next directory entry from the host. */
-static struct oe_dirent* _hostfs_readdir(oe_fd_t* desc)
+/* Refill the directory entry cache with a single call to the host. */
+static int _fill_dirent_cache(dir_t* dir)
 {
-    struct oe_dirent* ret = NULL;
-    dir_t* dir = _cast_dir(desc);
-    int retval = -1;
+    int ret = -1;
+    ssize_t retval = -1;
 
-    if (!dir)
-        OE_RAISE_ERRNO(OE_EINVAL);
+    dir->num_entries = 0;
+    dir->next_entry = 0;
 
-    /* Call the host to get the next directory entry. */
-    if (oe_syscall_readdir_ocall(&retval, dir->host_dir, &dir->entry) != OE_OK)
+    if (oe_syscall_readdir_ocall(
+            &retval, dir->host_dir, dir->entries, DIRENT_CACHE_SIZE) != OE_OK)
     {
         OE_RAISE_ERRNO(OE_EINVAL);
     }
@@ -910,15 +1156,49 @@ static struct oe_dirent* _hostfs_readdir(oe_fd_t* desc)
     if (retval == -1)
         OE_RAISE_ERRNO(oe_errno);
 
-    /* If end of file, then return NULL. */
-    if (retval == 1)
-        goto done;
+    /* Check that the host returned no more entries than were requested. */
+    if (retval < 0 || (size_t)retval > DIRENT_CACHE_SIZE)
+        OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* Check for an unexpected return value (indicates a coding error). */
-    if (retval != 0)
+    /* Check the bounds of each record, as the host filled them in. */
+    for (size_t i = 0; i < (size_t)retval; i++)
+    {
+        struct oe_dirent* ent = &dir->entries[i];
+
+        if (ent->d_reclen != sizeof(struct oe_dirent))
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        ent->d_name[sizeof(ent->d_name) - 1] = '\0';
+    }
+
+    dir->num_entries = (size_t)retval;
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Get the next directory entry, fetching more from the host when the cache
+ * is drained. */
+static struct oe_dirent* _hostfs_readdir(oe_fd_t* desc)
+{
+    struct oe_dirent* ret = NULL;
+    dir_t* dir = _cast_dir(desc);
+
+    if (!dir)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    ret = &dir->entry;
+    if (dir->next_entry == dir->num_entries)
+    {
+        if (_fill_dirent_cache(dir) != 0)
+            OE_RAISE_ERRNO(oe_errno);
+    }
+
+    /* If end of file, then return NULL. */
+    if (dir->next_entry == dir->num_entries)
+        goto done;
+
+    ret = &dir->entries[dir->next_entry++];
 
 done:
 
@@ -1187,6 +1467,15 @@ static oe_host_fd_t _hostfs_get_host_fd(oe_fd_t* desc)
     return file ? file->host_fd : -1;
 }
 
+/* Directories have no host file descriptor, so only files get here. */
+static void _hostfs_release(oe_fd_t* desc)
+{
+    file_t* file = _cast_file(desc);
+
+    if (file && !file->dir)
+        oe_free(file);
+}
+
 // clang-format off
 static oe_file_ops_t _file_ops =
 {
@@ -1199,8 +1488,17 @@ static oe_file_ops_t _file_ops =
     .fd.fcntl = _hostfs_fcntl,
     .fd.close = _hostfs_close,
     .fd.get_host_fd = _hostfs_get_host_fd,
+    .fd.release = _hostfs_release,
     .lseek = _hostfs_lseek,
     .getdents64 = _hostfs_getdents64,
+    .pread = _hostfs_pread,
+    .pwrite = _hostfs_pwrite,
+    .preadv = _hostfs_preadv,
+    .pwritev = _hostfs_pwritev,
+    .fstat = _hostfs_fstat,
+    .fsync = _hostfs_fsync,
+    .fdatasync = _hostfs_fdatasync,
+    .ftruncate = _hostfs_ftruncate,
 };
 // clang-format on
 
@@ -7,6 +7,7 @@
 #include <openenclave/enclave.h>
 // clang-format on
 
+#include <openenclave/internal/syscall/asyncio.h>
 #include <openenclave/internal/syscall/device.h>
 #include <openenclave/internal/thread.h>
 #include <openenclave/corelibc/string.h>
@@ -347,6 +348,12 @@ static ssize_t _hostsock_recv(
             OE_RAISE_ERRNO(OE_EINVAL);
     }
 
+    if (oe_async_io_blocking_call(
+            OE_ASYNC_IO_OP_RECV, sock->host_fd, buf, count, flags, &ret))
+    {
+        goto done;
+    }
+
     if (oe_syscall_recv_ocall(&ret, sock->host_fd, buf, count, flags) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
@@ -459,6 +466,17 @@ static ssize_t _hostsock_send(
     if (!sock || (count && !buf))
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (oe_async_io_blocking_call(
+            OE_ASYNC_IO_OP_SEND,
+            sock->host_fd,
+            (void*)buf,
+            count,
+            flags,
+            &ret))
+    {
+        goto done;
+    }
+
     if (oe_syscall_send_ocall(&ret, sock->host_fd, buf, count, flags) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
@@ -931,6 +949,14 @@ static oe_host_fd_t _hostsock_get_host_fd(oe_fd_t* sock_)
     return sock->host_fd;
 }
 
+static void _hostsock_release(oe_fd_t* sock_)
+{
+    sock_t* sock = _cast_sock(sock_);
+
+    if (sock)
+        oe_free(sock);
+}
+
 static oe_socket_ops_t _sock_ops = {
     .fd.dup = _hostsock_dup,
     .fd.ioctl = _hostsock_ioctl,
@@ -940,6 +966,7 @@ static oe_socket_ops_t _sock_ops = {
     .fd.readv = _hostsock_readv,
     .fd.writev = _hostsock_writev,
     .fd.get_host_fd = _hostsock_get_host_fd,
+    .fd.release = _hostsock_release,
     .fd.close = _hostsock_close,
     .accept = _hostsock_accept,
     .bind = _hostsock_bind,
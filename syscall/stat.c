@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include <openenclave/internal/syscall/device.h>
+#include <openenclave/internal/syscall/fdtable.h>
 #include <openenclave/internal/syscall/raise.h>
 #include <openenclave/internal/syscall/sys/stat.h>
 #include <openenclave/internal/trace.h>
@@ -44,6 +45,20 @@ done:
     return ret;
 }
 
+int oe_fstat(int fd, struct oe_stat* buf)
+{
+    int ret = -1;
+    oe_fd_t* file;
+
+    if (!(file = oe_fdtable_get(fd, OE_FD_TYPE_FILE)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = file->ops.file.fstat(file, buf);
+
+done:
+    return ret;
+}
+
 int oe_mkdir(const char* pathname, oe_mode_t mode)
 {
     int ret = -1;
@@ -148,6 +148,80 @@ static long _syscall(
             ret = oe_write(fd, buf, count);
             goto done;
         }
+        case OE_SYS_pread64:
+        {
+            int fd = (int)arg1;
+            void* buf = (void*)arg2;
+            size_t count = (size_t)arg3;
+            oe_off_t offset = (oe_off_t)arg4;
+
+            ret = oe_pread(fd, buf, count, offset);
+            goto done;
+        }
+        case OE_SYS_pwrite64:
+        {
+            int fd = (int)arg1;
+            const void* buf = (void*)arg2;
+            size_t count = (size_t)arg3;
+            oe_off_t offset = (oe_off_t)arg4;
+
+            ret = oe_pwrite(fd, buf, count, offset);
+            goto done;
+        }
+        case OE_SYS_preadv:
+        {
+            int fd = (int)arg1;
+            const struct oe_iovec* iov = (const struct oe_iovec*)arg2;
+            int iovcnt = (int)arg3;
+            /* The offset is split into a low and a high word, but the low
+             * word holds all of it on 64-bit targets. */
+            oe_off_t offset = (oe_off_t)arg4;
+
+            ret = oe_preadv(fd, iov, iovcnt, offset);
+            goto done;
+        }
+        case OE_SYS_pwritev:
+        {
+            int fd = (int)arg1;
+            const struct oe_iovec* iov = (const struct oe_iovec*)arg2;
+            int iovcnt = (int)arg3;
+            /* The offset is split into a low and a high word, but the low
+             * word holds all of it on 64-bit targets. */
+            oe_off_t offset = (oe_off_t)arg4;
+
+            ret = oe_pwritev(fd, iov, iovcnt, offset);
+            goto done;
+        }
+        case OE_SYS_fstat:
+        {
+            int fd = (int)arg1;
+            struct oe_stat* buf = (struct oe_stat*)arg2;
+
+            ret = oe_fstat(fd, buf);
+            goto done;
+        }
+        case OE_SYS_fsync:
+        {
+            int fd = (int)arg1;
+
+            ret = oe_fsync(fd);
+            goto done;
+        }
+        case OE_SYS_fdatasync:
+        {
+            int fd = (int)arg1;
+
+            ret = oe_fdatasync(fd);
+            goto done;
+        }
+        case OE_SYS_ftruncate:
+        {
+            int fd = (int)arg1;
+            oe_off_t length = (oe_off_t)arg2;
+
+            ret = oe_ftruncate(fd, length);
+            goto done;
+        }
         case OE_SYS_close:
         {
             int fd = (int)arg1;
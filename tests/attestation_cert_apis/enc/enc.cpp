@@ -10,6 +10,7 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
 #include <openenclave/internal/tests.h>
+#include <openenclave/internal/threadpool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -244,6 +245,9 @@ oe_result_t get_tls_cert_signed_with_key(
     OE_TRACE_INFO("private key:[%s]\n", private_key);
     OE_TRACE_INFO("public key:[%s]\n", public_key);
 
+    // Certificates are only reused when a time to live is set.
+    OE_TEST(oe_set_attestation_certificate_ttl(3600) == OE_OK);
+
     result = oe_generate_attestation_certificate(
         (const unsigned char*)"CN=Open Enclave SDK,O=OESDK TLS,C=US",
         private_key,
@@ -266,6 +270,48 @@ oe_result_t get_tls_cert_signed_with_key(
         "\nFrom inside enclave: verifying the certificate... %s\n",
         result == OE_OK ? "Success" : "Fail");
 
+    // The certificate is reused for the same key pair until it is rotated.
+    {
+        uint8_t* cert_again = NULL;
+        size_t cert_again_size = 0;
+
+        OE_TEST(
+            oe_generate_attestation_certificate(
+                (const unsigned char*)"CN=Open Enclave SDK,O=OESDK TLS,C=US",
+                private_key,
+                private_key_size,
+                public_key,
+                public_key_size,
+                &cert_again,
+                &cert_again_size) == OE_OK);
+        OE_TEST(cert_again_size == output_cert_size);
+        OE_TEST(memcmp(cert_again, output_cert, output_cert_size) == 0);
+        oe_free_attestation_certificate(cert_again);
+
+        OE_TEST(oe_rotate_attestation_certificates() == OE_OK);
+        OE_TEST(
+            oe_generate_attestation_certificate(
+                (const unsigned char*)"CN=Open Enclave SDK,O=OESDK TLS,C=US",
+                private_key,
+                private_key_size,
+                public_key,
+                public_key_size,
+                &cert_again,
+                &cert_again_size) == OE_OK);
+        OE_TEST(
+            cert_again_size != output_cert_size ||
+            memcmp(cert_again, output_cert, output_cert_size) != 0);
+        OE_TEST(
+            oe_verify_attestation_certificate(
+                cert_again,
+                cert_again_size,
+                enclave_identity_verifier,
+                NULL) == OE_OK);
+        oe_free_attestation_certificate(cert_again);
+
+        OE_TEST(oe_set_attestation_certificate_ttl(0) == OE_OK);
+    }
+
     // copy cert to host memory
     host_cert_buf = (uint8_t*)oe_host_malloc(output_cert_size);
     if (host_cert_buf == NULL)
@@ -304,10 +350,166 @@ oe_result_t get_tls_cert_signed_with_rsa_key(
     return get_tls_cert_signed_with_key(MBEDTLS_PK_RSA, cert, cert_size);
 }
 
+#define TEST_TTL_SECONDS 4
+
+/* The quotes made since the last call, on the thread of the ECALL and on
+ * other threads, which are those of the thread pool */
+static void _get_new_quotes(uint64_t* ecall_thread, uint64_t* other_threads)
+{
+    static uint64_t last_ecall_thread;
+    static uint64_t last_other_threads;
+    uint64_t total_ecall_thread = 0;
+    uint64_t total_other_threads = 0;
+
+    OE_TEST(
+        host_get_quote_counts(&total_ecall_thread, &total_other_threads) ==
+        OE_OK);
+
+    *ecall_thread = total_ecall_thread - last_ecall_thread;
+    *other_threads = total_other_threads - last_other_threads;
+    last_ecall_thread = total_ecall_thread;
+    last_other_threads = total_other_threads;
+}
+
+static void _generate(
+    uint8_t* private_key,
+    size_t private_key_size,
+    uint8_t* public_key,
+    size_t public_key_size,
+    uint8_t** cert,
+    size_t* cert_size)
+{
+    OE_TEST(
+        oe_generate_attestation_certificate(
+            (const unsigned char*)"CN=Open Enclave SDK,O=OESDK TLS,C=US",
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size,
+            cert,
+            cert_size) == OE_OK);
+}
+
+static bool _equal(
+    const uint8_t* cert1,
+    size_t cert1_size,
+    const uint8_t* cert2,
+    size_t cert2_size)
+{
+    return cert1_size == cert2_size && memcmp(cert1, cert2, cert1_size) == 0;
+}
+
+// Once half of the time to live has passed, a certificate is regenerated on
+// the thread pool while the old one is still returned. Without a pool, it is
+// regenerated by the caller once its time to live has passed.
+oe_result_t test_cert_regeneration()
+{
+    uint8_t* private_key = NULL;
+    size_t private_key_size = 0;
+    uint8_t* public_key = NULL;
+    size_t public_key_size = 0;
+    uint8_t* first = NULL;
+    size_t first_size = 0;
+    uint8_t* cert = NULL;
+    size_t cert_size = 0;
+    uint64_t ecall_thread = 0;
+    uint64_t other_threads = 0;
+    const uint32_t half_ttl_msec = TEST_TTL_SECONDS * 1000 / 2;
+
+    OE_TEST(
+        generate_key_pair(
+            MBEDTLS_PK_ECKEY,
+            &public_key,
+            &public_key_size,
+            &private_key,
+            &private_key_size) == OE_OK);
+    OE_TEST(oe_set_attestation_certificate_ttl(TEST_TTL_SECONDS) == OE_OK);
+    _get_new_quotes(&ecall_thread, &other_threads);
+
+    _generate(
+        private_key,
+        private_key_size,
+        public_key,
+        public_key_size,
+        &first,
+        &first_size);
+    _get_new_quotes(&ecall_thread, &other_threads);
+    OE_TEST(ecall_thread == 1 && other_threads == 0);
+
+    // Past half of the time to live, the cached certificate is returned.
+    host_sleep(half_ttl_msec + 100);
+    _generate(
+        private_key,
+        private_key_size,
+        public_key,
+        public_key_size,
+        &cert,
+        &cert_size);
+    OE_TEST(_equal(cert, cert_size, first, first_size));
+    oe_free_attestation_certificate(cert);
+
+    if (oe_thread_pool_get_num_workers() > 0)
+    {
+        // The pool regenerates the certificate before it expires, and the
+        // new certificate is returned without a remote report by the caller.
+        for (uint32_t msec = 0;; msec += 10)
+        {
+            OE_TEST(msec < half_ttl_msec);
+            _generate(
+                private_key,
+                private_key_size,
+                public_key,
+                public_key_size,
+                &cert,
+                &cert_size);
+
+            if (!_equal(cert, cert_size, first, first_size))
+                break;
+
+            oe_free_attestation_certificate(cert);
+            host_sleep(10);
+        }
+
+        _get_new_quotes(&ecall_thread, &other_threads);
+        OE_TEST(ecall_thread == 0 && other_threads == 1);
+    }
+    else
+    {
+        // Once the time to live has passed, the caller regenerates it.
+        _get_new_quotes(&ecall_thread, &other_threads);
+        OE_TEST(ecall_thread == 0 && other_threads == 0);
+
+        host_sleep(half_ttl_msec);
+        _generate(
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size,
+            &cert,
+            &cert_size);
+        OE_TEST(!_equal(cert, cert_size, first, first_size));
+
+        _get_new_quotes(&ecall_thread, &other_threads);
+        OE_TEST(ecall_thread == 1 && other_threads == 0);
+    }
+
+    OE_TEST(
+        oe_verify_attestation_certificate(
+            cert, cert_size, enclave_identity_verifier, NULL) == OE_OK);
+
+    oe_free_attestation_certificate(cert);
+    oe_free_attestation_certificate(first);
+    OE_TEST(oe_set_attestation_certificate_ttl(0) == OE_OK);
+    free(public_key);
+    free(private_key);
+
+    return OE_OK;
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
     true, /* AllowDebug */
     128,  /* HeapPageCount */
     128,  /* StackPageCount */
-    1);   /* TCSCount */
+    4);   /* TCSCount */
@@ -9,6 +9,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../../../host/calls.h"
+#include "sgx_args.h"
 #include "tls_u.h"
 
 #if defined(_WIN32)
@@ -121,6 +127,85 @@ void run_test(oe_enclave_t* enclave, int test_type)
     free(cert);
 }
 
+static ocall_table_t _sgx_ocall_table;
+static std::vector<oe_ocall_func_t> _counting_ocalls;
+static std::thread::id _ecall_thread;
+static std::atomic<uint64_t> _ecall_thread_quotes;
+static std::atomic<uint64_t> _other_thread_quotes;
+
+/*
+ * Make the quote, and count it by the host thread that made it: the thread
+ * of the ECALL, or a thread lent to the enclave thread pool.
+ */
+static void _count_quote_ocall(
+    const uint8_t* input_buffer,
+    size_t input_buffer_size,
+    uint8_t* output_buffer,
+    size_t output_buffer_size,
+    size_t* output_bytes_written)
+{
+    oe_get_quote_ocall_args_t* args_out =
+        (oe_get_quote_ocall_args_t*)output_buffer;
+
+    _sgx_ocall_table.ocalls[sgx_fcn_id_oe_get_quote_ocall](
+        input_buffer,
+        input_buffer_size,
+        output_buffer,
+        output_buffer_size,
+        output_bytes_written);
+
+    if (args_out->_result == OE_OK && args_out->_retval == OE_OK)
+    {
+        if (std::this_thread::get_id() == _ecall_thread)
+            _ecall_thread_quotes++;
+        else
+            _other_thread_quotes++;
+    }
+}
+
+void host_sleep(uint32_t msec)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(msec));
+}
+
+void host_get_quote_counts(
+    uint64_t* ecall_thread_quotes,
+    uint64_t* other_thread_quotes)
+{
+    *ecall_thread_quotes = _ecall_thread_quotes;
+    *other_thread_quotes = _other_thread_quotes;
+}
+
+/*
+ * Run the certificate regeneration test, counting the quotes the enclave
+ * makes. Each enclave creation registers the SGX OCALL table again, so the
+ * counting table is registered here, after it.
+ */
+static void run_regeneration_test(oe_enclave_t* enclave)
+{
+    oe_result_t ecall_result = OE_FAILURE;
+
+    _sgx_ocall_table = _ocall_tables[OE_SGX_OCALL_FUNCTION_TABLE_ID];
+    _counting_ocalls.assign(
+        _sgx_ocall_table.ocalls,
+        _sgx_ocall_table.ocalls + _sgx_ocall_table.num_ocalls);
+    _counting_ocalls[sgx_fcn_id_oe_get_quote_ocall] = _count_quote_ocall;
+    _ecall_thread = std::this_thread::get_id();
+
+    OE_TEST(
+        oe_register_ocall_function_table(
+            OE_SGX_OCALL_FUNCTION_TABLE_ID,
+            &_counting_ocalls[0],
+            _counting_ocalls.size()) == OE_OK);
+    OE_TEST(test_cert_regeneration(enclave, &ecall_result) == OE_OK);
+    OE_TEST(ecall_result == OE_OK);
+    OE_TEST(
+        oe_register_ocall_function_table(
+            OE_SGX_OCALL_FUNCTION_TABLE_ID,
+            _sgx_ocall_table.ocalls,
+            _sgx_ocall_table.num_ocalls) == OE_OK);
+}
+
 int main(int argc, const char* argv[])
 {
 #ifdef OE_USE_LIBSGX
@@ -184,8 +269,31 @@ int main(int argc, const char* argv[])
     run_test(enclave, TEST_EC_KEY);
     run_test(enclave, TEST_RSA_KEY);
 
+    /* Without a thread pool, expired certificates are regenerated by the
+     * caller */
+    run_regeneration_test(enclave);
+
     result = oe_terminate_enclave(enclave);
     OE_TEST(result == OE_OK);
+
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+    /* Lend two host threads to the enclave, to regenerate certificates */
+    oe_enclave_config_thread_pool_t thread_pool_config = {2};
+    oe_enclave_config_t config;
+
+    config.config_type = OE_ENCLAVE_CONFIG_THREAD_POOL;
+    config.u.thread_pool_config = &thread_pool_config;
+
+    if ((result = oe_create_tls_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, &config, 1, &enclave)) !=
+        OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    run_regeneration_test(enclave);
+
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK);
+#endif
     OE_TRACE_INFO("=== passed all tests (tls)\n");
     return 0;
 #else
@@ -5,6 +5,7 @@
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/error.h>
 #include <openenclave/internal/tests.h>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <thread>
@@ -140,6 +141,43 @@ static void _test_multithreaded(
         thread.join();
 }
 
+// Compare creating enclaves from the cached image of the file with creating
+// them after evicting the image, which loads and patches it every time.
+static void _test_image_cache(const char* path, uint32_t flags)
+{
+    const int iterations = 20;
+    double seconds[2];
+
+    OE_TEST(oe_preload_enclave_image(NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_preload_enclave_image("no-such-enclave") == OE_NOT_FOUND);
+
+    for (int evict = 0; evict < 2; evict++)
+    {
+        OE_TEST(oe_preload_enclave_image(path) == OE_OK);
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < iterations; i++)
+        {
+            if (evict)
+                OE_TEST(oe_evict_enclave_image(path) == OE_OK);
+
+            _launch_enclave(path, flags, true);
+        }
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        seconds[evict] = elapsed.count();
+    }
+
+    printf(
+        "create: %.3f ms with the cached image, %.3f ms without\n",
+        seconds[0] * 1000 / iterations,
+        seconds[1] * 1000 / iterations);
+
+    OE_TEST(oe_evict_enclave_image(NULL) == OE_OK);
+}
+
 int main(int argc, const char* argv[])
 {
     if (argc != 2)
@@ -162,5 +200,10 @@ int main(int argc, const char* argv[])
     _test_multithreaded(argv[1], flags, false);
     _test_multithreaded(argv[1], flags, true);
 
+    // Test creation with and without the image cache, and creation by
+    // threads that load the image at the same time.
+    _test_image_cache(argv[1], flags);
+    _test_multithreaded(argv[1], flags, true);
+
     return 0;
 }
@@ -151,10 +151,14 @@ void enc_test(test_args* args)
     }
 }
 
+void enc_noop()
+{
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
     true, /* AllowDebug */
     1024, /* HeapPageCount */
     1024, /* StackPageCount */
-    2);   /* TCSCount */
+    16);  /* TCSCount */
@@ -6,9 +6,12 @@
 #include <openenclave/internal/error.h>
 #include <openenclave/internal/tests.h>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <thread>
+#include <vector>
 #include "ecall_u.h"
 
 #if 0
@@ -59,6 +62,37 @@ void TestECall(oe_enclave_t* enclave)
     prev = args.thread_data.last_sp;
 }
 
+// Measure how the ECALL throughput scales with the number of host threads,
+// which all compete for the TCSs of the enclave.
+const size_t CALLS_PER_THREAD = 20000;
+
+void BenchmarkECalls(oe_enclave_t* enclave)
+{
+    for (size_t num_threads = 1; num_threads <= 16; num_threads *= 2)
+    {
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < num_threads; i++)
+        {
+            threads.push_back(std::thread([enclave]() {
+                for (size_t j = 0; j < CALLS_PER_THREAD; j++)
+                    OE_TEST(enc_noop(enclave) == OE_OK);
+            }));
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        std::chrono::duration<double> seconds =
+            std::chrono::steady_clock::now() - start;
+        printf(
+            "%zu threads: %.0f ECALLs/sec\n",
+            num_threads,
+            (double)(num_threads * CALLS_PER_THREAD) / seconds.count());
+    }
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -87,6 +121,9 @@ int main(int argc, const char* argv[])
         TestECall(enclave);
     }
 
+    printf("=== BenchmarkECalls()\n");
+    BenchmarkECalls(enclave);
+
     if ((result = oe_terminate_enclave(enclave)) != OE_OK)
     {
         oe_put_err("oe_terminate_enclave(): result=%u", result);
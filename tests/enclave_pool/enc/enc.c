@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include "enclave_pool_test_t.h"
+
+/* The state that a user of the enclave leaves behind */
+static int _state;
+
+int enc_get_state(void)
+{
+    return _state;
+}
+
+void enc_set_state(int state)
+{
+    _state = state;
+}
+
+void enc_reset(void)
+{
+    _state = 0;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    256,  /* StackPageCount */
+    2);   /* TCSCount */
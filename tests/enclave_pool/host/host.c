@@ -0,0 +1,228 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "enclave_pool_test_u.h"
+
+#define POOL_SIZE 2
+#define ITERATIONS 20
+
+/* Reset the enclave, unless arg points to true */
+static oe_result_t _reset(oe_enclave_t* enclave, void* arg)
+{
+    if (arg && *(bool*)arg)
+        return OE_FAILURE;
+
+    return enc_reset(enclave);
+}
+
+static oe_enclave_pool_statistics_t _get_statistics(oe_enclave_pool_t* pool)
+{
+    oe_enclave_pool_statistics_t statistics;
+
+    OE_TEST(oe_get_enclave_pool_statistics(pool, &statistics) == OE_OK);
+
+    return statistics;
+}
+
+/* Wait for the background threads to fill the pool */
+static void _wait_until_full(oe_enclave_pool_t* pool)
+{
+    for (size_t i = 0; i < 6000; i++)
+    {
+        if (_get_statistics(pool).enclaves_ready == POOL_SIZE)
+            return;
+
+        usleep(10000);
+    }
+
+    OE_TEST("the pool was not filled in a minute" == NULL);
+}
+
+static int _get_state(oe_enclave_t* enclave)
+{
+    int state = -1;
+
+    OE_TEST(enc_get_state(enclave, &state) == OE_OK);
+
+    return state;
+}
+
+static double _seconds_since(const struct timespec* start)
+{
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (double)(end.tv_sec - start->tv_sec) +
+           (double)(end.tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+static void _init_settings(
+    oe_enclave_pool_settings_t* settings,
+    const char* path,
+    uint32_t flags)
+{
+    memset(settings, 0, sizeof(*settings));
+    settings->create = oe_create_enclave_pool_test_enclave;
+    settings->path = path;
+    settings->type = OE_ENCLAVE_TYPE_SGX;
+    settings->flags = flags;
+    settings->size = POOL_SIZE;
+    settings->num_threads = 1;
+}
+
+// A reset enclave goes back to the pool, with the state of its previous user
+// cleared.
+static void _test_reset(const char* path, uint32_t flags)
+{
+    oe_enclave_pool_settings_t settings;
+    oe_enclave_pool_statistics_t statistics;
+    oe_enclave_pool_t* pool = NULL;
+    oe_enclave_t* enclave = NULL;
+    oe_enclave_t* other = NULL;
+
+    _init_settings(&settings, path, flags);
+    settings.reset = _reset;
+
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) == OE_OK);
+    _wait_until_full(pool);
+
+    OE_TEST(oe_enclave_pool_acquire(pool, &enclave) == OE_OK);
+    OE_TEST(_get_state(enclave) == 0);
+    OE_TEST(enc_set_state(enclave, 42) == OE_OK);
+    OE_TEST(oe_enclave_pool_release(pool, enclave) == OE_OK);
+
+    OE_TEST(oe_enclave_pool_acquire(pool, &enclave) == OE_OK);
+    OE_TEST(_get_state(enclave) == 0);
+
+    /* The pool waited for the enclave instead of replacing it */
+    statistics = _get_statistics(pool);
+    OE_TEST(statistics.hits == 2);
+    OE_TEST(statistics.misses == 0);
+    OE_TEST(statistics.enclaves_reused == 1);
+    OE_TEST(statistics.enclaves_discarded == 0);
+    OE_TEST(statistics.enclaves_created == POOL_SIZE);
+    OE_TEST(statistics.create_failures == 0);
+    OE_TEST(statistics.max_create_usec > 0);
+
+    /* An acquired enclave outlives the pool */
+    OE_TEST(oe_enclave_pool_acquire(pool, &other) == OE_OK);
+    OE_TEST(oe_enclave_pool_release(pool, enclave) == OE_OK);
+    OE_TEST(oe_terminate_enclave_pool(pool) == OE_OK);
+    OE_TEST(_get_state(other) == 0);
+    OE_TEST(oe_terminate_enclave(other) == OE_OK);
+}
+
+// Without a reset function, every released enclave is replaced.
+static void _test_discard(const char* path, uint32_t flags)
+{
+    oe_enclave_pool_settings_t settings;
+    oe_enclave_pool_statistics_t statistics;
+    oe_enclave_pool_t* pool = NULL;
+    oe_enclave_t* enclave = NULL;
+
+    _init_settings(&settings, path, flags);
+
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) == OE_OK);
+
+    for (size_t i = 0; i < POOL_SIZE * 2; i++)
+    {
+        OE_TEST(oe_enclave_pool_acquire(pool, &enclave) == OE_OK);
+        OE_TEST(_get_state(enclave) == 0);
+        OE_TEST(enc_set_state(enclave, 42) == OE_OK);
+        OE_TEST(oe_enclave_pool_release(pool, enclave) == OE_OK);
+    }
+
+    _wait_until_full(pool);
+
+    statistics = _get_statistics(pool);
+    OE_TEST(statistics.hits + statistics.misses == POOL_SIZE * 2);
+    OE_TEST(statistics.enclaves_discarded == POOL_SIZE * 2);
+    OE_TEST(statistics.enclaves_reused == 0);
+
+    OE_TEST(oe_terminate_enclave_pool(pool) == OE_OK);
+}
+
+// Compare creating an enclave with taking a ready one from a pool.
+static void _run_benchmark(const char* path, uint32_t flags)
+{
+    oe_enclave_pool_settings_t settings;
+    oe_enclave_pool_t* pool = NULL;
+    oe_enclave_t* enclave = NULL;
+    struct timespec start;
+    double create_seconds = 0;
+    double acquire_seconds = 0;
+    bool discard = false;
+
+    for (size_t i = 0; i < ITERATIONS; i++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        OE_TEST(
+            oe_create_enclave_pool_test_enclave(
+                path, OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave) == OE_OK);
+        create_seconds += _seconds_since(&start);
+        OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+    }
+
+    _init_settings(&settings, path, flags);
+    settings.reset = _reset;
+    settings.reset_arg = &discard;
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) == OE_OK);
+
+    for (size_t i = 0; i < ITERATIONS; i++)
+    {
+        _wait_until_full(pool);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        OE_TEST(oe_enclave_pool_acquire(pool, &enclave) == OE_OK);
+        acquire_seconds += _seconds_since(&start);
+
+        /* Alternate between reusing and replacing the enclave */
+        discard = (i % 2) == 0;
+        OE_TEST(oe_enclave_pool_release(pool, enclave) == OE_OK);
+    }
+
+    OE_TEST(oe_terminate_enclave_pool(pool) == OE_OK);
+
+    printf(
+        "create: %.3f ms, acquire: %.3f ms\n",
+        create_seconds * 1000 / ITERATIONS,
+        acquire_seconds * 1000 / ITERATIONS);
+}
+
+int main(int argc, const char* argv[])
+{
+    const uint32_t flags = oe_get_create_flags();
+    oe_enclave_pool_settings_t settings;
+    oe_enclave_pool_t* pool = NULL;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    _init_settings(&settings, argv[1], flags);
+    settings.size = 0;
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) == OE_INVALID_PARAMETER);
+    OE_TEST(pool == NULL);
+
+    /* A bad image fails the creation of the pool */
+    _init_settings(&settings, "no-such-enclave", flags);
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) != OE_OK);
+    OE_TEST(pool == NULL);
+
+    _test_reset(argv[1], flags);
+    _test_discard(argv[1], flags);
+    _run_benchmark(argv[1], flags);
+
+    printf("=== passed all tests (enclave_pool)\n");
+
+    return 0;
+}
@@ -162,6 +162,83 @@ static int _verify_report(const char* report_filename, bool pass)
     return ret;
 }
 
+static uint8_t* _read_file(const char* filename, size_t* size)
+{
+    FILE* fp = fopen(filename, "rb");
+    uint8_t* data = NULL;
+
+    OE_TEST(fp != NULL);
+
+    fseek(fp, 0, SEEK_END);
+    *size = (size_t)ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    data = (uint8_t*)malloc(*size);
+    OE_TEST(data != NULL);
+    OE_TEST(fread(data, sizeof(uint8_t), *size, fp) == *size);
+
+    fclose(fp);
+    return data;
+}
+
+// Verify copies of a report in one batch, with a bad report among them.
+static void _verify_reports(const char* report_filename, bool pass)
+{
+    const size_t count = 16;
+    const size_t bad_index = count / 2;
+    const uint8_t* reports[count];
+    size_t report_sizes[count];
+    oe_result_t results[count];
+    oe_report_t parsed_reports[count];
+    size_t size = 0;
+    size_t bad_size = 0;
+    uint8_t* data = _read_file(report_filename, &size);
+    uint8_t* bad_data = _read_file(REPORT_BAD_FILENAME, &bad_size);
+
+    OE_TRACE_INFO("\n\nVerifying a batch of report %s\n", report_filename);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        reports[i] = data;
+        report_sizes[i] = size;
+    }
+
+    reports[bad_index] = bad_data;
+    report_sizes[bad_index] = bad_size;
+
+    OE_TEST(
+        oe_verify_remote_reports(
+            reports, report_sizes, count, results, parsed_reports) ==
+        OE_VERIFY_FAILED);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pass && i != bad_index)
+        {
+            OE_TEST(results[i] == OE_OK);
+            OE_TEST(parsed_reports[i].size == parsed_reports[0].size);
+        }
+        else
+            OE_TEST(results[i] != OE_OK);
+    }
+
+    // Every report of the batch is checked against the single report API.
+    for (size_t i = 0; i < count; i++)
+        OE_TEST(
+            (oe_verify_remote_report(reports[i], report_sizes[i], NULL) ==
+             OE_OK) == (results[i] == OE_OK));
+
+    OE_TEST(
+        oe_verify_remote_reports(NULL, report_sizes, count, results, NULL) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_verify_remote_reports(reports, report_sizes, 0, results, NULL) ==
+        OE_INVALID_PARAMETER);
+
+    free(data);
+    free(bad_data);
+}
+
 int main()
 {
     const uint32_t flags = oe_get_create_flags();
@@ -183,7 +260,10 @@ int main()
         _verify_cert(CERT_RSA_FILENAME, true);
 
     if (_validate_file(REPORT_FILENAME, false))
+    {
         _verify_report(REPORT_FILENAME, true);
+        _verify_reports(REPORT_FILENAME, true);
+    }
 
     // These files are checked in and should always exist.
     if (_validate_file(CERT_EC_BAD_FILENAME, true))
@@ -193,7 +273,10 @@ int main()
         _verify_cert(CERT_RSA_BAD_FILENAME, false);
 
     if (_validate_file(REPORT_BAD_FILENAME, true))
+    {
         _verify_report(REPORT_BAD_FILENAME, false);
+        _verify_reports(REPORT_BAD_FILENAME, false);
+    }
 
     return 0;
 }
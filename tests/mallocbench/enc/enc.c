@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mallocbench_t.h"
+
+/* The number of blocks that each thread keeps alive at any time */
+#define NUM_SLOTS 256
+
+int enc_uses_thread_cache(void)
+{
+#if defined(OE_USE_THREAD_CACHE_MALLOC)
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+static uint32_t _next(uint32_t* state)
+{
+    /* xorshift32 */
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/* Mostly small blocks, with the occasional larger one. */
+static size_t _get_alloc_size(uint32_t* state)
+{
+    uint32_t r = _next(state);
+
+    if (r % 16 == 0)
+        return 1024 + r % 8192;
+
+    return 8 + r % 504;
+}
+
+/* Allocate and free blocks in random order, as a server enclave handling
+ * requests would. Each block is filled with a byte derived from its size,
+ * which is checked when the block is freed, so that blocks handed out twice
+ * are caught. */
+int enc_malloc_bench(size_t iterations, uint32_t seed)
+{
+    uint8_t* slots[NUM_SLOTS] = {NULL};
+    size_t sizes[NUM_SLOTS] = {0};
+    uint32_t state = seed ? seed : 1;
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        size_t index = _next(&state) % NUM_SLOTS;
+
+        if (slots[index])
+        {
+            uint8_t fill = (uint8_t)sizes[index];
+
+            if (slots[index][0] != fill ||
+                slots[index][sizes[index] - 1] != fill)
+                return -1;
+
+            free(slots[index]);
+            slots[index] = NULL;
+        }
+        else
+        {
+            size_t size = _get_alloc_size(&state);
+
+            if (!(slots[index] = (uint8_t*)malloc(size)))
+                return -1;
+
+            memset(slots[index], (int)(size & 0xff), size);
+            sizes[index] = size;
+        }
+    }
+
+    for (size_t i = 0; i < NUM_SLOTS; i++)
+        free(slots[i]);
+
+    return 0;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    64,   /* StackPageCount */
+    8);   /* TCSCount */
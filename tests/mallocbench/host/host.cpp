@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "mallocbench_u.h"
+
+#define MAX_THREADS 8
+#define ITERATIONS 200000
+
+static void _bench_thread(oe_enclave_t* enclave, uint32_t seed)
+{
+    int retval = -1;
+
+    OE_TEST(enc_malloc_bench(enclave, &retval, ITERATIONS, seed) == OE_OK);
+    OE_TEST(retval == 0);
+}
+
+// Measure the rate of malloc and free calls as the number of enclave threads
+// making them grows. With a single lock in front of the heap, the aggregate
+// rate stops growing, or even drops, as threads are added.
+static void _run_malloc_benchmark(oe_enclave_t* enclave)
+{
+    for (uint32_t num_threads = 1; num_threads <= MAX_THREADS;
+         num_threads *= 2)
+    {
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < num_threads; i++)
+            threads.push_back(std::thread(_bench_thread, enclave, i + 1));
+
+        for (auto& t : threads)
+            t.join();
+
+        std::chrono::duration<double> seconds =
+            std::chrono::steady_clock::now() - start;
+        double calls = (double)num_threads * ITERATIONS;
+
+        printf(
+            "%u enclave thread(s): %.0f malloc/free calls/sec\n",
+            num_threads,
+            calls / seconds.count());
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    int uses_thread_cache = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    result = oe_create_mallocbench_enclave(
+        argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave);
+
+    if (result != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    OE_TEST(enc_uses_thread_cache(enclave, &uses_thread_cache) == OE_OK);
+    printf(
+        "=== Allocator: %s\n",
+        uses_thread_cache ? "thread-caching" : "dlmalloc");
+
+    _run_malloc_benchmark(enclave);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (mallocbench)\n");
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/globals.h>
+#include <openenclave/internal/tests.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "memory_t.h"
+
+#define NUM_BLOCKS 64
+
+/* Larger than the blocks that a thread-caching front-end would keep */
+#define BLOCK_SIZE 4096
+
+#define PROFILED_ALLOCATIONS 1000
+#define PROFILED_SIZE 100
+#define SAMPLE_INTERVAL 4
+
+static void _check_stats(const oe_heap_stats_t* stats)
+{
+    uint64_t histogram_chunks = 0;
+
+    OE_TEST(stats->heap_size == __oe_get_heap_size());
+    OE_TEST(stats->sbrk_extent <= stats->heap_size);
+    OE_TEST(stats->system_bytes <= stats->sbrk_extent);
+    OE_TEST(stats->peak_system_bytes >= stats->system_bytes);
+    OE_TEST(
+        stats->in_use_bytes + stats->free_bytes <= stats->system_bytes);
+    OE_TEST(stats->largest_free_chunk <= stats->free_bytes);
+
+    for (size_t i = 0; i < OE_HEAP_STATS_HISTOGRAM_SIZE; i++)
+        histogram_chunks += stats->free_chunk_histogram[i];
+
+    OE_TEST(histogram_chunks == stats->free_chunks);
+}
+
+void test_heap_stats(void)
+{
+    oe_heap_stats_t before;
+    oe_heap_stats_t allocated;
+    oe_heap_stats_t fragmented;
+    void* blocks[NUM_BLOCKS];
+
+    OE_TEST(oe_get_heap_stats(NULL) == OE_INVALID_PARAMETER);
+
+    OE_TEST(oe_get_heap_stats(&before) == OE_OK);
+    _check_stats(&before);
+
+    for (size_t i = 0; i < NUM_BLOCKS; i++)
+        OE_TEST((blocks[i] = malloc(BLOCK_SIZE)) != NULL);
+
+    OE_TEST(oe_get_heap_stats(&allocated) == OE_OK);
+    _check_stats(&allocated);
+    OE_TEST(
+        allocated.in_use_bytes >=
+        before.in_use_bytes + NUM_BLOCKS * BLOCK_SIZE);
+
+    /* Freeing every other block leaves free chunks between the others */
+    for (size_t i = 0; i < NUM_BLOCKS; i += 2)
+        free(blocks[i]);
+
+    OE_TEST(oe_get_heap_stats(&fragmented) == OE_OK);
+    _check_stats(&fragmented);
+    OE_TEST(
+        fragmented.in_use_bytes + NUM_BLOCKS / 2 * BLOCK_SIZE <=
+        allocated.in_use_bytes);
+    OE_TEST(fragmented.free_chunks > 0);
+
+    for (size_t i = 1; i < NUM_BLOCKS; i += 2)
+        free(blocks[i]);
+}
+
+static OE_NEVER_INLINE void _allocate_for_profiler(void)
+{
+    for (size_t i = 0; i < PROFILED_ALLOCATIONS; i++)
+    {
+        void* ptr = malloc(PROFILED_SIZE);
+        OE_TEST(ptr != NULL);
+        free(ptr);
+    }
+}
+
+void test_allocation_profiler(void)
+{
+    static oe_allocation_site_t sites[64];
+    size_t num_sites = 0;
+    uint64_t samples = 0;
+    uint64_t bytes = 0;
+    oe_result_t result;
+
+    result = oe_start_allocation_profiler(SAMPLE_INTERVAL);
+
+    if (result == OE_UNSUPPORTED)
+    {
+        printf("=== skipped allocation profiler test, not built in\n");
+        return;
+    }
+
+    OE_TEST(result == OE_OK);
+    OE_TEST(oe_start_allocation_profiler(0) == OE_INVALID_PARAMETER);
+
+    _allocate_for_profiler();
+
+    OE_TEST(
+        oe_get_allocation_profile(NULL, &num_sites) == OE_BUFFER_TOO_SMALL);
+    OE_TEST(num_sites > 0 && num_sites <= OE_COUNTOF(sites));
+
+    num_sites = OE_COUNTOF(sites);
+    OE_TEST(oe_get_allocation_profile(sites, &num_sites) == OE_OK);
+
+    for (size_t i = 0; i < num_sites; i++)
+    {
+        samples += sites[i].samples;
+        bytes += sites[i].bytes;
+
+        OE_TEST(sites[i].num_frames <= OE_ALLOCATION_PROFILE_MAX_FRAMES);
+
+        /* The sites are sorted by bytes */
+        if (i > 0)
+            OE_TEST(sites[i].bytes <= sites[i - 1].bytes);
+    }
+
+    /* Only the allocations above were made since the profiler started */
+    OE_TEST(samples == PROFILED_ALLOCATIONS / SAMPLE_INTERVAL);
+    OE_TEST(bytes == samples * PROFILED_SIZE);
+
+    OE_TEST(oe_dump_allocation_profile() == OE_OK);
+
+    OE_TEST(oe_stop_allocation_profiler() == OE_OK);
+    OE_TEST(oe_get_allocation_profile(NULL, &num_sites) == OE_NOT_FOUND);
+}
@@ -24,6 +24,12 @@ static void _malloc_basic_test(oe_enclave_t* enclave)
     OE_TEST(test_posix_memalign(enclave) == OE_OK);
 }
 
+static void _heap_stats_test(oe_enclave_t* enclave)
+{
+    OE_TEST(test_heap_stats(enclave) == OE_OK);
+    OE_TEST(test_allocation_profiler(enclave) == OE_OK);
+}
+
 static void _malloc_stress_test_single_thread(
     oe_enclave_t* enclave,
     int thread_num)
@@ -136,6 +142,9 @@ int main(int argc, const char* argv[])
     printf("===Starting basic malloc test.\n");
     _malloc_basic_test(enclave);
 
+    printf("===Starting heap statistics test.\n");
+    _heap_stats_test(enclave);
+
     printf("===Starting malloc stress test.\n");
     _malloc_stress_test(enclave);
 
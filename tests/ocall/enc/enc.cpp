@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <openenclave/corelibc/stdlib.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/edger8r/enclave.h>
 #include <openenclave/enclave.h>
@@ -96,6 +97,46 @@ void enc_test_reentrancy()
     OE_TEST(OE_OK == result);
 }
 
+static void _test_reverse_buffer(size_t size)
+{
+    unsigned char* buffer = (unsigned char*)oe_malloc(size);
+    OE_TEST(buffer != NULL);
+
+    for (size_t i = 0; i < size; i++)
+        buffer[i] = (unsigned char)i;
+
+    OE_TEST(host_reverse_buffer(buffer, size) == OE_OK);
+
+    for (size_t i = 0; i < size; i++)
+        OE_TEST(buffer[i] == (unsigned char)(size - 1 - i));
+
+    oe_free(buffer);
+}
+
+void enc_test_ocall_buffer()
+{
+    /* Allocations from the per-TCS region are released in LIFO order */
+    {
+        void* first = oe_allocate_ocall_buffer(64);
+        void* second = oe_allocate_ocall_buffer(64);
+        OE_TEST(first != NULL && second != NULL);
+        OE_TEST(oe_is_outside_enclave(first, 64));
+        OE_TEST(oe_is_outside_enclave(second, 64));
+        OE_TEST((unsigned char*)second == (unsigned char*)first + 64);
+
+        oe_free_ocall_buffer(second);
+        oe_free_ocall_buffer(first);
+        OE_TEST(oe_allocate_ocall_buffer(64) == first);
+        oe_free_ocall_buffer(first);
+    }
+
+    /* Marshalled data that fits in the per-TCS region */
+    _test_reverse_buffer(256);
+
+    /* Marshalled data that falls back to oe_host_malloc */
+    _test_reverse_buffer(OE_OCALL_BUFFER_SIZE + 1);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
@@ -22,6 +22,16 @@ void host_func2(const unsigned char*)
     g_func2_ok = true;
 }
 
+void host_reverse_buffer(unsigned char* buffer, size_t size)
+{
+    for (size_t i = 0; i < size / 2; i++)
+    {
+        unsigned char tmp = buffer[i];
+        buffer[i] = buffer[size - 1 - i];
+        buffer[size - 1 - i] = tmp;
+    }
+}
+
 static oe_enclave_t* g_enclave = NULL;
 static bool g_reentrancy_tested = false;
 void host_test_reentrancy()
@@ -116,6 +126,12 @@ int main(int argc, const char* argv[])
         OE_TEST(g_reentrancy_tested);
     }
 
+    /* Call enc_test_ocall_buffer */
+    {
+        result = enc_test_ocall_buffer(enclave);
+        OE_TEST(OE_OK == result);
+    }
+
     oe_terminate_enclave(enclave);
 
     printf("=== passed all tests (%s)\n", argv[0]);
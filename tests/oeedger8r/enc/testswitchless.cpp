@@ -11,8 +11,10 @@ void test_switchless_edl_ocalls()
     int c = 0;
     OE_TEST(ocall_sum(&c, 5, 6) == OE_OK);
 
-    // Switchless calls are not yet implemented
+    // Without host workers, switchless calls fall back to regular calls
+    c = 0;
     OE_TEST(switchless_ocall_sum(&c, 5, 6) == OE_OK);
+    OE_TEST(c == 11);
 
     printf("=== test_switchless_edl_ocalls passed\n");
 }
@@ -11,8 +11,10 @@ void test_switchless_edl_ecalls(oe_enclave_t* enclave)
     int c = 0;
     OE_TEST(ecall_sum(enclave, &c, 5, 6) == OE_OK);
 
-    // Switchless calls are not yet implemented
-    OE_TEST(switchless_ecall_sum(enclave, &c, 5, 6) == OE_UNSUPPORTED);
+    // Without enclave workers, switchless calls fall back to regular calls
+    c = 0;
+    OE_TEST(switchless_ecall_sum(enclave, &c, 5, 6) == OE_OK);
+    OE_TEST(c == 11);
 
     printf("=== test_switchless_edl_ecalls passed\n");
 }
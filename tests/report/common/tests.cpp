@@ -583,6 +583,51 @@ void test_remote_report()
             oe_free_report(report_buffer_ptr);
         }
     }
+
+    /*
+     * Post conditions:
+     *     2. Reports made in a row, which reuse the QE target info and the
+     *        quote size of the first, contain their own report data.
+     */
+    {
+        uint8_t* first_report = NULL;
+        size_t first_report_size = 0;
+
+        OE_TEST(
+            GetReport_v2(
+                flags,
+                report_data,
+                OE_REPORT_DATA_SIZE,
+                NULL,
+                0,
+                &first_report,
+                &first_report_size) == OE_OK);
+
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            report_data[0] = static_cast<uint8_t>(i);
+            OE_TEST(
+                GetReport_v2(
+                    flags,
+                    report_data,
+                    OE_REPORT_DATA_SIZE,
+                    NULL,
+                    0,
+                    &report_buffer_ptr,
+                    &report_ptr_size) == OE_OK);
+            OE_TEST(report_ptr_size == first_report_size);
+            ValidateReport(
+                report_buffer_ptr,
+                report_ptr_size,
+                true,
+                report_data,
+                OE_REPORT_DATA_SIZE);
+            oe_free_report(report_buffer_ptr);
+        }
+
+        report_data[0] = 0;
+        oe_free_report(first_report);
+    }
 #endif
 
     /*
@@ -667,6 +712,40 @@ void test_remote_report()
     }
 }
 
+#ifdef OE_BUILD_ENCLAVE
+/*
+ * The host fails the first quote and returns a quote size larger than the
+ * buffer. The report is made again with the QE target info asked for anew,
+ * and must not use the size from the failed quote.
+ */
+void test_remote_report_after_failed_quote()
+{
+    uint8_t report_data[OE_REPORT_DATA_SIZE];
+    uint8_t* report_buffer_ptr = NULL;
+    size_t report_ptr_size = 0;
+
+    for (uint32_t i = 0; i < OE_REPORT_DATA_SIZE; ++i)
+        report_data[i] = static_cast<uint8_t>(i);
+
+    OE_TEST(
+        GetReport_v2(
+            OE_REPORT_FLAGS_REMOTE_ATTESTATION,
+            report_data,
+            OE_REPORT_DATA_SIZE,
+            NULL,
+            0,
+            &report_buffer_ptr,
+            &report_ptr_size) == OE_OK);
+    ValidateReport(
+        report_buffer_ptr,
+        report_ptr_size,
+        true,
+        report_data,
+        OE_REPORT_DATA_SIZE);
+    oe_free_report(report_buffer_ptr);
+}
+#endif
+
 void test_parse_report_negative()
 {
     uint8_t* report_buffer = NULL;
@@ -886,4 +965,45 @@ void test_remote_verify_report()
         oe_free_report(report_ptr);
 #endif
     }
+
+    /*
+     * The first verification caches the collateral of the platform and the
+     * PCK certificate chain of the quote, and the next one uses them, unless
+     * the collateral has already expired.
+     */
+    {
+        oe_collateral_cache_statistics_t before;
+        oe_collateral_cache_statistics_t after;
+
+        OE_TEST(
+            GetReport_v2(flags, NULL, 0, NULL, 0, &report_ptr, &report_size) ==
+            OE_OK);
+
+        OE_TEST(oe_flush_collateral_cache() == OE_OK);
+        OE_TEST(oe_get_collateral_cache_statistics(&before) == OE_OK);
+        OE_TEST(before.entries == 0);
+
+        OE_TEST(VerifyReport(report_ptr, report_size, NULL) == OE_OK);
+        OE_TEST(VerifyReport(report_ptr, report_size, NULL) == OE_OK);
+
+        OE_TEST(oe_get_collateral_cache_statistics(&after) == OE_OK);
+        OE_TEST(after.misses > before.misses);
+        OE_TEST(
+            after.hits + after.misses == before.hits + before.misses + 2);
+        OE_TEST(after.entries == after.hits - before.hits);
+
+        OE_TEST(after.pck_chain_misses == before.pck_chain_misses + 1);
+        OE_TEST(after.pck_chain_hits == before.pck_chain_hits + 1);
+        OE_TEST(after.pck_chain_entries == 1);
+        OE_TEST(
+            after.qe_identity_hits + after.qe_identity_misses ==
+            before.qe_identity_hits + before.qe_identity_misses + 2);
+
+        OE_TEST(oe_flush_collateral_cache() == OE_OK);
+        OE_TEST(oe_get_collateral_cache_statistics(&after) == OE_OK);
+        OE_TEST(after.entries == 0);
+        OE_TEST(after.pck_chain_entries == 0);
+
+        oe_free_report(report_ptr);
+    }
 }
@@ -22,6 +22,9 @@ extern oe_enclave_t* g_enclave;
 
 void test_local_report(sgx_target_info_t* target_info);
 void test_remote_report();
+#ifdef OE_BUILD_ENCLAVE
+void test_remote_report_after_failed_quote();
+#endif
 void test_parse_report_negative();
 void test_local_verify_report();
 void test_remote_verify_report();
@@ -113,6 +113,11 @@ void enclave_test_remote_report()
     test_remote_report();
 }
 
+void enclave_test_remote_report_after_failed_quote()
+{
+    test_remote_report_after_failed_quote();
+}
+
 void enclave_test_parse_report_negative()
 {
     test_parse_report_negative();
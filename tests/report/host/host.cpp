@@ -10,8 +10,10 @@
 #include <ctime>
 #include <vector>
 #include "../../../common/sgx/tcbinfo.h"
+#include "../../../host/calls.h"
 #include "../../../host/sgx/quote.h"
 #include "../common/tests.h"
+#include "sgx_args.h"
 #include "tests_u.h"
 
 #ifdef _WIN32
@@ -67,6 +69,69 @@ int load_and_verify_report()
     return 0;
 }
 
+#ifdef OE_USE_LIBSGX
+static ocall_table_t _sgx_ocall_table;
+static bool _quote_failed;
+
+/*
+ * Make the quote, then report to the enclave that it failed, with a quote
+ * size larger than the maximum report size, as a host might do.
+ */
+static void _fail_first_quote_ocall(
+    const uint8_t* input_buffer,
+    size_t input_buffer_size,
+    uint8_t* output_buffer,
+    size_t output_buffer_size,
+    size_t* output_bytes_written)
+{
+    oe_get_quote_ocall_args_t* args_in =
+        (oe_get_quote_ocall_args_t*)input_buffer;
+    oe_get_quote_ocall_args_t* args_out =
+        (oe_get_quote_ocall_args_t*)output_buffer;
+
+    _sgx_ocall_table.ocalls[sgx_fcn_id_oe_get_quote_ocall](
+        input_buffer,
+        input_buffer_size,
+        output_buffer,
+        output_buffer_size,
+        output_bytes_written);
+
+    if (!_quote_failed && args_out->_result == OE_OK &&
+        args_in->quote_size_out)
+    {
+        _quote_failed = true;
+        args_out->_retval = OE_PLATFORM_ERROR;
+        *args_in->quote_size_out = OE_MAX_REPORT_SIZE * 2;
+    }
+}
+
+/*
+ * The enclave has the QE target info and the quote size cached, so its
+ * first quote is for a buffer of the cached size. The quote fails, and the
+ * report must be made again for the same buffer.
+ */
+static void test_remote_report_after_failed_quote(oe_enclave_t* enclave)
+{
+    _sgx_ocall_table = _ocall_tables[OE_SGX_OCALL_FUNCTION_TABLE_ID];
+    std::vector<oe_ocall_func_t> ocalls(
+        _sgx_ocall_table.ocalls,
+        _sgx_ocall_table.ocalls + _sgx_ocall_table.num_ocalls);
+    ocalls[sgx_fcn_id_oe_get_quote_ocall] = _fail_first_quote_ocall;
+
+    OE_TEST(
+        oe_register_ocall_function_table(
+            OE_SGX_OCALL_FUNCTION_TABLE_ID, &ocalls[0], ocalls.size()) ==
+        OE_OK);
+    OE_TEST(enclave_test_remote_report_after_failed_quote(enclave) == OE_OK);
+    OE_TEST(_quote_failed);
+    OE_TEST(
+        oe_register_ocall_function_table(
+            OE_SGX_OCALL_FUNCTION_TABLE_ID,
+            _sgx_ocall_table.ocalls,
+            _sgx_ocall_table.num_ocalls) == OE_OK);
+}
+#endif
+
 int main(int argc, const char* argv[])
 {
     sgx_target_info_t target_info;
@@ -169,6 +234,7 @@ int main(int argc, const char* argv[])
      */
     OE_TEST(enclave_test_local_report(enclave, &target_info) == OE_OK);
     OE_TEST(enclave_test_remote_report(enclave) == OE_OK);
+    test_remote_report_after_failed_quote(enclave);
 
     OE_TEST(enclave_test_parse_report_negative(enclave) == OE_OK);
 
@@ -193,6 +193,7 @@ static void _test_time_functions(void)
         /* Check for accuracy within a second */
         OE_TEST(now >= tmp - SEC_TO_USEC);
         OE_TEST(now <= tmp + SEC_TO_USEC);
+        OE_TEST(tv.tv_usec >= 0 && tv.tv_usec < 1000000);
     }
 
     /* Test clock_gettime() */
@@ -207,6 +208,22 @@ static void _test_time_functions(void)
         OE_TEST(tmp <= now + SEC_TO_USEC);
     }
 
+    /* Test that the time never goes backwards */
+    {
+        uint64_t prev = oe_get_time();
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            uint64_t tmp = oe_get_time();
+            OE_TEST(tmp != (uint64_t)-1);
+            OE_TEST(tmp >= prev);
+            prev = tmp;
+        }
+
+        /* The fresh time comes straight from the host */
+        OE_TEST(oe_get_fresh_time() != (uint64_t)-1);
+    }
+
     /* Test nanosleep() */
     {
         const uint64_t SLEEP_SECS = 3;
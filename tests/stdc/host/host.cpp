@@ -55,6 +55,28 @@ int main(int argc, const char* argv[])
         oe_put_err("oe_terminate_enclave(): result=%u", result);
     }
 
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+    /* Run the tests again, reading the time from the time page */
+    oe_enclave_config_time_page_t time_page_config = {10};
+    oe_enclave_config_t config;
+    config.config_type = OE_ENCLAVE_CONFIG_TIME_PAGE;
+    config.u.time_page_config = &time_page_config;
+
+    result = oe_create_stdc_enclave(
+        argv[1], OE_ENCLAVE_TYPE_SGX, flags, &config, 1, &enclave);
+    if (result != OE_OK)
+    {
+        oe_put_err("oe_create_stdc_enclave(): result=%u", result);
+    }
+
+    TestStdc(enclave);
+
+    if ((result = oe_terminate_enclave(enclave)) != OE_OK)
+    {
+        oe_put_err("oe_terminate_enclave(): result=%u", result);
+    }
+#endif
+
     printf("=== passed all tests (%s)\n", argv[0]);
 
     return 0;
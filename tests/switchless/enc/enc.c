@@ -75,10 +75,81 @@ int enc_echo_regular(char* in, char out[STRING_LEN], int repeats)
     return 0;
 }
 
+int enc_echo_single(char* in, char out[STRING_LEN])
+{
+    if (oe_strcmp(in, STRING_HELLO) != 0)
+    {
+        return -1;
+    }
+
+    oe_strlcpy(out, in, STRING_LEN);
+
+    return 0;
+}
+
+int enc_switchless_burst(int repeats)
+{
+    char in[STRING_LEN] = STRING_HELLO;
+    char out[STRING_LEN];
+    char stack_allocated_str[STRING_LEN] = HOST_STACK_STRING;
+    int return_val;
+
+    for (int i = 0; i < repeats; i++)
+    {
+        if (host_echo_switchless(
+                &return_val, in, out, HOST_PARAM_STRING, stack_allocated_str) !=
+                OE_OK ||
+            return_val != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+#define MAX_ASYNC_OCALLS 64
+
+// Make count asynchronous OCALLs that are waited on, followed by one that is
+// not. The host adds up the values, which total count * (count + 1) / 2 + 1.
+int enc_async_ocalls(int count)
+{
+    oe_async_ocall_t handles[MAX_ASYNC_OCALLS];
+    bool completed = false;
+
+    if (count <= 0 || count > MAX_ASYNC_OCALLS)
+        return -1;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (host_record_async(&handles[i], i + 1) != OE_OK || !handles[i])
+            return -1;
+    }
+
+    if (oe_poll_async_ocall(handles[0], &completed) != OE_OK)
+        return -1;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (oe_wait_async_ocall(handles[i]) != OE_OK)
+            return -1;
+    }
+
+    // A handle can only be waited on once.
+    if (oe_wait_async_ocall(handles[0]) != OE_INVALID_PARAMETER ||
+        oe_poll_async_ocall(handles[0], &completed) != OE_INVALID_PARAMETER)
+        return -1;
+
+    if (host_record_async(NULL, 1) != OE_OK)
+        return -1;
+
+    return 0;
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
     true, /* AllowDebug */
     1024, /* HeapPageCount */
     1024, /* StackPageCount */
-    2);   /* TCSCount */
+    10);  /* TCSCount */
@@ -36,6 +36,98 @@ int host_echo_regular(char* in, char* out, char* str1, char str2[STRING_LEN])
     return 0;
 }
 
+static int _async_total;
+
+void host_record_async(int value)
+{
+    __atomic_add_fetch(&_async_total, value, __ATOMIC_SEQ_CST);
+}
+
+#define ASYNC_OCALLS 32
+
+static void _test_async_ocalls(oe_enclave_t* enclave)
+{
+    const int expected = ASYNC_OCALLS * (ASYNC_OCALLS + 1) / 2 + 1;
+    int return_val = -1;
+
+    OE_TEST(enc_async_ocalls(enclave, &return_val, ASYNC_OCALLS) == OE_OK);
+    OE_TEST(return_val == 0);
+
+    // The last OCALL was not waited on, so it may still be in flight.
+    for (int i = 0; i < 1000; i++)
+    {
+        if (__atomic_load_n(&_async_total, __ATOMIC_SEQ_CST) == expected)
+            break;
+
+        struct timespec delay = {0, 1000 * 1000};
+        nanosleep(&delay, NULL);
+    }
+
+    OE_TEST(__atomic_load_n(&_async_total, __ATOMIC_SEQ_CST) == expected);
+    printf("Asynchronous OCALLs completed\n");
+}
+
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+
+#define MAX_BENCHMARK_THREADS 8
+#define BENCHMARK_REPEATS 1000
+
+static void* _switchless_burst_thread(void* arg)
+{
+    oe_enclave_t* enclave = (oe_enclave_t*)arg;
+    int return_val;
+
+    OE_TEST(
+        enc_switchless_burst(enclave, &return_val, BENCHMARK_REPEATS) ==
+        OE_OK);
+    OE_TEST(return_val == 0);
+
+    return NULL;
+}
+
+// Measure the throughput of switchless OCALLs and the rate at which they fall
+// back to regular OCALLs as the number of enclave threads making them grows.
+static void _run_switchless_benchmark(oe_enclave_t* enclave)
+{
+    for (int num_threads = 1; num_threads <= MAX_BENCHMARK_THREADS;
+         num_threads *= 2)
+    {
+        pthread_t threads[MAX_BENCHMARK_THREADS];
+        oe_switchless_statistics_t before, after;
+        struct timespec start, end;
+
+        OE_TEST(oe_get_switchless_statistics(enclave, &before) == OE_OK);
+        clock_gettime(CLOCK_REALTIME, &start);
+
+        for (int i = 0; i < num_threads; i++)
+            OE_TEST(
+                pthread_create(
+                    &threads[i], NULL, _switchless_burst_thread, enclave) ==
+                0);
+
+        for (int i = 0; i < num_threads; i++)
+            OE_TEST(pthread_join(threads[i], NULL) == 0);
+
+        clock_gettime(CLOCK_REALTIME, &end);
+        OE_TEST(oe_get_switchless_statistics(enclave, &after) == OE_OK);
+
+        double seconds = (double)(end.tv_sec - start.tv_sec) +
+                         (double)(end.tv_nsec - start.tv_nsec) / 1000000000.0;
+        uint64_t calls = (uint64_t)num_threads * BENCHMARK_REPEATS;
+        uint64_t handled = after.host_worker_calls - before.host_worker_calls;
+
+        OE_TEST(handled <= calls);
+        printf(
+            "%d enclave thread(s): %.0f switchless OCALLs/sec, "
+            "miss rate %.2f%%\n",
+            num_threads,
+            (double)calls / seconds,
+            100.0 * (double)(calls - handled) / (double)calls);
+    }
+}
+
+#endif /* OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE */
+
 int main(int argc, const char* argv[])
 {
     oe_enclave_t* enclave = NULL;
@@ -50,8 +142,9 @@ int main(int argc, const char* argv[])
     const uint32_t flags = oe_get_create_flags();
 
 #ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
-    // Enable switchless and configure host worker number
-    oe_enclave_config_context_switchless_t config = {2, 0};
+    // Enable switchless, configure the worker numbers, and use a small spin
+    // budget so that idle host workers park quickly.
+    oe_enclave_config_context_switchless_t config = {2, 1, 1000};
     oe_enclave_config_t configs[] = {{
         .config_type = OE_ENCLAVE_CONFIG_CONTEXT_SWITCHLESS,
         .u.context_switchless_config = &config,
@@ -96,6 +189,61 @@ int main(int argc, const char* argv[])
     regular_microseconds += (double)(end.tv_sec - start.tv_sec) * 1000000.0 +
                             (double)(end.tv_nsec - start.tv_nsec) / 1000.0;
 
+    // Switchless ECALLs are handled by the enclave worker, or fall back to
+    // regular ECALLs when the worker is busy.
+    double switchless_ecall_microseconds = 0;
+    clock_gettime(CLOCK_REALTIME, &start);
+    for (int i = 0; i < repeats; i++)
+    {
+        memset(out, 0, sizeof(out));
+        OE_TEST(
+            enc_echo_single(enclave, &return_val, "Hello World", out) ==
+            OE_OK);
+        OE_TEST(return_val == 0);
+        OE_TEST(strcmp(out, "Hello World") == 0);
+    }
+    clock_gettime(CLOCK_REALTIME, &end);
+    switchless_ecall_microseconds +=
+        (double)(end.tv_sec - start.tv_sec) * 1000000.0 +
+        (double)(end.tv_nsec - start.tv_nsec) / 1000.0;
+
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+    // Let the host workers run out of their spin budget and park, then make
+    // switchless OCALLs again, which wake them up.
+    struct timespec idle = {0, 100 * 1000 * 1000};
+    nanosleep(&idle, NULL);
+
+    OE_TEST(
+        enc_echo_switchless(
+            enclave, &return_val, "Hello World", out, repeats) == OE_OK);
+    OE_TEST(return_val == 0);
+
+    // The enclave worker parked while idle as well, and is woken up by the
+    // next switchless ECALL, which it handles rather than falling back.
+    memset(out, 0, sizeof(out));
+    OE_TEST(
+        enc_echo_single(enclave, &return_val, "Hello World", out) == OE_OK);
+    OE_TEST(strcmp(out, "Hello World") == 0);
+
+    oe_switchless_statistics_t statistics;
+    OE_TEST(oe_get_switchless_statistics(enclave, &statistics) == OE_OK);
+    OE_TEST(statistics.host_worker_parks > 0);
+    OE_TEST(statistics.enclave_worker_parks > 0);
+    OE_TEST(statistics.enclave_worker_calls == (uint64_t)repeats + 1);
+    printf(
+        "Host workers parked %llu times and were woken up %llu times\n",
+        (unsigned long long)statistics.host_worker_parks,
+        (unsigned long long)statistics.host_worker_wakes);
+    printf(
+        "Enclave workers parked %llu times and handled %llu ECALLs\n",
+        (unsigned long long)statistics.enclave_worker_parks,
+        (unsigned long long)statistics.enclave_worker_calls);
+
+    _run_switchless_benchmark(enclave);
+#endif
+
+    _test_async_ocalls(enclave);
+
     result = oe_terminate_enclave(enclave);
     OE_TEST(result == OE_OK);
 
@@ -106,6 +254,10 @@ int main(int argc, const char* argv[])
         (int)switchless_microseconds / 1000,
         (int)regular_microseconds / 1000,
         (double)regular_microseconds / switchless_microseconds);
+    printf(
+        "Time spent in repeating switchless ECALL %d times: %d ms\n",
+        repeats,
+        (int)switchless_ecall_microseconds / 1000);
     printf("=== passed all tests (switchless)\n");
 
     return 0;
@@ -0,0 +1,212 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+
+// enclave.h must come before socket.h
+#include <openenclave/corelibc/errno.h>
+#include <openenclave/internal/syscall/asyncio.h>
+#include <openenclave/internal/syscall/batch.h>
+#include <openenclave/internal/syscall/netinet/in.h>
+#include <openenclave/internal/syscall/sys/socket.h>
+#include <openenclave/internal/syscall/unistd.h>
+#include <openenclave/internal/tests.h>
+
+#include <asyncio_test_t.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_CHUNK_SIZE (64 * 1024)
+
+static int _sockfd[2] = {-1, -1};
+static uint8_t _send_buf[MAX_CHUNK_SIZE];
+static uint8_t _recv_buf[MAX_CHUNK_SIZE];
+
+int enc_init(int* rings_available)
+{
+    OE_TEST(oe_load_module_host_socket_interface() == OE_OK);
+    OE_TEST(oe_socketpair(OE_AF_LOCAL, OE_SOCK_STREAM, 0, _sockfd) == 0);
+
+    *rings_available = oe_async_io_is_available();
+
+    /* Without the rings, the API reports that it is not available. */
+    if (!*rings_available)
+    {
+        OE_TEST(oe_async_io_send(_sockfd[0], _send_buf, 1, 0, 0) == -1);
+        OE_TEST(oe_errno == OE_ENOSYS);
+    }
+
+    return 0;
+}
+
+int enc_fini(void)
+{
+    OE_TEST(oe_close(_sockfd[0]) == 0);
+    OE_TEST(oe_close(_sockfd[1]) == 0);
+    _sockfd[0] = _sockfd[1] = -1;
+
+    return 0;
+}
+
+/* Send the chunk on one end of the pair and receive it on the other, with an
+ * OCALL per send and receive. */
+static void _transfer_ocall(size_t size)
+{
+    size_t sent = 0;
+    size_t received = 0;
+
+    while (sent < size)
+    {
+        ssize_t n = oe_send(_sockfd[0], _send_buf + sent, size - sent, 0);
+        OE_TEST(n > 0);
+        sent += (size_t)n;
+    }
+
+    while (received < size)
+    {
+        ssize_t n =
+            oe_recv(_sockfd[1], _recv_buf + received, size - received, 0);
+        OE_TEST(n > 0);
+        received += (size_t)n;
+    }
+}
+
+/* Send and receive with a single OCALL per round trip. */
+static void _transfer_batch(size_t size)
+{
+    static oe_syscall_batch_t batch;
+    size_t sent = 0;
+    size_t received = 0;
+
+    while (received < size)
+    {
+        int send_index = -1;
+        int recv_index;
+        ssize_t n;
+        int error;
+
+        oe_syscall_batch_init(&batch);
+
+        if (sent < size)
+            send_index = oe_syscall_batch_send(
+                &batch, _sockfd[0], _send_buf + sent, size - sent, 0);
+
+        /* The host performs the send first, so there is data to receive. */
+        recv_index = oe_syscall_batch_recv(
+            &batch, _sockfd[1], _recv_buf + received, size - received, 0);
+        OE_TEST(recv_index >= 0);
+
+        OE_TEST(oe_syscall_batch_submit(&batch) == 0);
+
+        if (send_index >= 0)
+        {
+            n = oe_syscall_batch_result(&batch, (size_t)send_index, &error);
+            OE_TEST(n > 0);
+            sent += (size_t)n;
+        }
+
+        n = oe_syscall_batch_result(&batch, (size_t)recv_index, &error);
+        OE_TEST(n > 0);
+        received += (size_t)n;
+    }
+}
+
+/* Send and receive through the rings, without leaving the enclave. */
+static void _transfer_rings(size_t size)
+{
+    size_t sent = 0;
+    size_t received = 0;
+    bool sending = false;
+    bool receiving = false;
+
+    /* The send may complete after the data is received on the other end. */
+    while (received < size || sending)
+    {
+        oe_async_io_completion_t completions[2];
+        size_t count;
+
+        if (!sending && sent < size)
+        {
+            OE_TEST(
+                oe_async_io_send(
+                    _sockfd[0], _send_buf + sent, size - sent, 0, 0) == 0);
+            sending = true;
+        }
+
+        if (!receiving && received < size)
+        {
+            OE_TEST(
+                oe_async_io_recv(
+                    _sockfd[1],
+                    _recv_buf + received,
+                    size - received,
+                    0,
+                    1) == 0);
+            receiving = true;
+        }
+
+        count = oe_async_io_poll(completions, OE_COUNTOF(completions));
+
+        for (size_t i = 0; i < count; i++)
+        {
+            OE_TEST(completions[i].result > 0);
+
+            if (completions[i].user_data == 0)
+            {
+                sent += (size_t)completions[i].result;
+                sending = false;
+            }
+            else
+            {
+                received += (size_t)completions[i].result;
+                receiving = false;
+            }
+        }
+    }
+
+    OE_TEST(sent == size && !receiving);
+}
+
+int enc_loopback(enum loopback_mode mode, size_t chunk_size, size_t iterations)
+{
+    OE_TEST(chunk_size > 0 && chunk_size <= MAX_CHUNK_SIZE);
+
+    if (mode == LOOPBACK_BLOCKING)
+        oe_async_io_set_blocking_mode(true);
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        memset(_send_buf, (int)(i & 0xff), chunk_size);
+        memset(_recv_buf, 0, chunk_size);
+
+        switch (mode)
+        {
+            case LOOPBACK_OCALL:
+            case LOOPBACK_BLOCKING:
+                _transfer_ocall(chunk_size);
+                break;
+            case LOOPBACK_BATCH:
+                _transfer_batch(chunk_size);
+                break;
+            case LOOPBACK_RINGS:
+                _transfer_rings(chunk_size);
+                break;
+            default:
+                OE_TEST("unknown mode" == NULL);
+        }
+
+        OE_TEST(memcmp(_send_buf, _recv_buf, chunk_size) == 0);
+    }
+
+    oe_async_io_set_blocking_mode(false);
+
+    return 0;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    256,  /* HeapPageCount */
+    256,  /* StackPageCount */
+    2);   /* TCSCount */
@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <time.h>
+#include "asyncio_test_u.h"
+
+#define CHUNK_SIZE (16 * 1024)
+#define ITERATIONS 2000
+
+static const char* _mode_names[] = {
+    "regular OCALLs",
+    "batched OCALLs",
+    "asynchronous I/O rings",
+    "blocking calls on the rings",
+};
+
+// Measure the throughput of sending a chunk on one end of a socketpair and
+// receiving it on the other end, for each way that the enclave has of asking
+// the host to perform the I/O.
+static void _run_loopback_benchmark(oe_enclave_t* enclave, bool has_rings)
+{
+    for (int mode = LOOPBACK_OCALL; mode <= LOOPBACK_BLOCKING; mode++)
+    {
+        struct timespec start, end;
+        int retval = -1;
+
+        if (!has_rings &&
+            (mode == LOOPBACK_RINGS || mode == LOOPBACK_BLOCKING))
+        {
+            printf("%s: skipped, no rings\n", _mode_names[mode]);
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        OE_TEST(
+            enc_loopback(
+                enclave,
+                &retval,
+                (enum loopback_mode)mode,
+                CHUNK_SIZE,
+                ITERATIONS) == OE_OK);
+        OE_TEST(retval == 0);
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double seconds = (double)(end.tv_sec - start.tv_sec) +
+                         (double)(end.tv_nsec - start.tv_nsec) / 1000000000.0;
+        double megabytes = (double)CHUNK_SIZE * ITERATIONS / (1024 * 1024);
+
+        printf(
+            "%s: %.1f MB/s (%.0f round trips/sec)\n",
+            _mode_names[mode],
+            megabytes / seconds,
+            ITERATIONS / seconds);
+    }
+}
+
+static void _run_test(oe_enclave_t* enclave, bool expect_rings)
+{
+    int rings_available = 0;
+    int retval = -1;
+
+    OE_TEST(enc_init(enclave, &retval, &rings_available) == OE_OK);
+    OE_TEST(retval == 0);
+    OE_TEST(rings_available == expect_rings);
+
+    _run_loopback_benchmark(enclave, rings_available);
+
+    OE_TEST(enc_fini(enclave, &retval) == OE_OK);
+    OE_TEST(retval == 0);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    OE_TEST(
+        oe_create_asyncio_test_enclave(
+            argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave) ==
+        OE_OK);
+    _run_test(enclave, false);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+    /* Run the benchmark again with two host workers serving the rings */
+    oe_enclave_config_async_io_t async_io_config = {2, 0};
+    oe_enclave_config_t config;
+    config.config_type = OE_ENCLAVE_CONFIG_ASYNC_IO;
+    config.u.async_io_config = &async_io_config;
+
+    OE_TEST(
+        oe_create_asyncio_test_enclave(
+            argv[1], OE_ENCLAVE_TYPE_SGX, flags, &config, 1, &enclave) ==
+        OE_OK);
+    _run_test(enclave, true);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+#endif
+
+    printf("=== passed all tests (asyncio)\n");
+
+    return 0;
+}
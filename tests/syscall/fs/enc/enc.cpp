@@ -5,12 +5,16 @@
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/print.h>
+#include <openenclave/internal/syscall/batch.h>
 #include <openenclave/internal/syscall/device.h>
+#include <openenclave/internal/syscall/sys/uio.h>
 #include <openenclave/internal/syscall/unistd.h>
 #include <openenclave/internal/tests.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/mount.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include <set>
 #include <string>
 #include "../../cpio/commands.h"
@@ -538,6 +542,200 @@ extern "C" void test_dup_case2(const char* tmp_dir)
     OE_TEST(umount("/") == 0);
 }
 
+/* Scan a directory with more entries than hostfs reads from the host at
+ * once. */
+static void test_readdir_many(const char* tmp_dir)
+{
+    const size_t num_files = 100;
+    char dirname[OE_PATH_MAX];
+    char path[OE_PATH_MAX];
+    char name[32];
+    DIR* dir;
+    struct dirent* ent;
+    set<string> names;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    OE_TEST(mount("/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, NULL) == 0);
+
+    mkpath(dirname, tmp_dir, "many");
+    OE_TEST(mkdir(dirname, 0777) == 0);
+
+    for (size_t i = 0; i < num_files; i++)
+    {
+        snprintf(name, sizeof(name), "file%zu", i);
+        _touch(mkpath(path, dirname, name));
+    }
+
+    OE_TEST((dir = opendir(dirname)));
+
+    /* Stop partway through, then rewind and read every entry. */
+    for (size_t i = 0; i < 10; i++)
+        OE_TEST(readdir(dir));
+
+    rewinddir(dir);
+
+    while ((ent = readdir(dir)))
+    {
+        /* Each entry is returned once. */
+        OE_TEST(names.insert(ent->d_name).second);
+    }
+
+    OE_TEST(closedir(dir) == 0);
+    OE_TEST(names.size() == num_files + 2);
+
+    for (size_t i = 0; i < num_files; i++)
+    {
+        snprintf(name, sizeof(name), "file%zu", i);
+        OE_TEST(names.count(name) == 1);
+        OE_TEST(unlink(mkpath(path, dirname, name)) == 0);
+    }
+
+    OE_TEST(rmdir(dirname) == 0);
+
+    OE_TEST(umount("/") == 0);
+}
+
+static void test_positional_io(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+    char buf[OE_PAGE_SIZE];
+    struct stat st;
+    int fd;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    OE_TEST(mount("/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, NULL) == 0);
+
+    mkpath(path, tmp_dir, "positional");
+    fd = open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+    OE_TEST(fd >= 0);
+
+    /* Write the alphabet at an offset, which leaves the file offset alone. */
+    OE_TEST(pwrite(fd, ALPHABET, sizeof(ALPHABET), 10) == sizeof(ALPHABET));
+    OE_TEST(lseek(fd, 0, SEEK_CUR) == 0);
+
+    /* Read "lmnop" back from the offset. */
+    OE_TEST(pread(fd, buf, 5, 10 + 11) == 5);
+    OE_TEST(memcmp(buf, "lmnop", 5) == 0);
+    OE_TEST(lseek(fd, 0, SEEK_CUR) == 0);
+
+    /* Read "abc" and "def" with a single vectored read. */
+    {
+        struct iovec iov[2];
+        iov[0].iov_base = buf;
+        iov[0].iov_len = 3;
+        iov[1].iov_base = buf + 3;
+        iov[1].iov_len = 3;
+        OE_TEST(preadv(fd, iov, 2, 10) == 6);
+        OE_TEST(memcmp(buf, "abcdef", 6) == 0);
+    }
+
+    /* Overwrite "xyz" with a vectored write. */
+    {
+        struct oe_iovec iov[1];
+        iov[0].iov_base = (void*)"XYZ";
+        iov[0].iov_len = 3;
+        OE_TEST(oe_pwritev(fd, iov, 1, 10 + 23) == 3);
+        OE_TEST(oe_pread(fd, buf, 3, 10 + 23) == 3);
+        OE_TEST(memcmp(buf, "XYZ", 3) == 0);
+    }
+
+    /* An empty IO vector transfers nothing. */
+    OE_TEST(oe_pwritev(fd, NULL, 0, 10) == 0);
+    OE_TEST(oe_preadv(fd, NULL, 0, 10) == 0);
+
+    /* The size is visible through the descriptor. */
+    OE_TEST(fstat(fd, &st) == 0);
+    OE_TEST(st.st_size == 10 + sizeof(ALPHABET));
+    OE_TEST(S_ISREG(st.st_mode));
+
+    OE_TEST(fsync(fd) == 0);
+    OE_TEST(fdatasync(fd) == 0);
+
+    /* Truncate through the descriptor. */
+    OE_TEST(ftruncate(fd, 5) == 0);
+    OE_TEST(fstat(fd, &st) == 0);
+    OE_TEST(st.st_size == 5);
+    OE_TEST(pread(fd, buf, sizeof(buf), 0) == 5);
+
+    /* Positional IO is not supported on the standard devices. */
+    OE_TEST(pread(OE_STDIN_FILENO, buf, 1, 0) == -1);
+    OE_TEST(errno == ESPIPE);
+
+    OE_TEST(close(fd) == 0);
+    OE_TEST(unlink(path) == 0);
+
+    OE_TEST(umount("/") == 0);
+}
+
+static void test_batch(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+    char buf[sizeof(ALPHABET)];
+    struct oe_stat st;
+    oe_syscall_batch_t batch;
+    int fd;
+    int error;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    OE_TEST(mount("/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, NULL) == 0);
+
+    mkpath(path, tmp_dir, "batch");
+    fd = open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+    OE_TEST(fd >= 0);
+
+    /* Write, stat, rewind and read back the file in one submission. */
+    oe_syscall_batch_init(&batch);
+    OE_TEST(oe_syscall_batch_write(&batch, fd, ALPHABET, 13) == 0);
+    OE_TEST(oe_syscall_batch_write(&batch, fd, ALPHABET + 13, 13) == 1);
+    OE_TEST(oe_syscall_batch_fstat(&batch, fd, &st) == 2);
+    OE_TEST(oe_syscall_batch_read(&batch, fd, buf, sizeof(buf)) == 3);
+    OE_TEST(oe_syscall_batch_submit(&batch) == 0);
+
+    OE_TEST(oe_syscall_batch_result(&batch, 0, &error) == 13);
+    OE_TEST(oe_syscall_batch_result(&batch, 1, &error) == 13);
+    OE_TEST(oe_syscall_batch_result(&batch, 2, &error) == 0);
+    OE_TEST(st.st_size == 26);
+
+    /* The read started at the end of the file. */
+    OE_TEST(oe_syscall_batch_result(&batch, 3, &error) == 0);
+    OE_TEST(error == 0);
+
+    OE_TEST(lseek(fd, 0, SEEK_SET) == 0);
+
+    /* Read, close and then use the closed descriptor. */
+    OE_TEST(oe_syscall_batch_read(&batch, fd, buf, sizeof(buf)) == 0);
+    OE_TEST(oe_syscall_batch_close(&batch, fd) == 1);
+    OE_TEST(oe_syscall_batch_read(&batch, fd, buf, sizeof(buf)) == 2);
+    OE_TEST(oe_syscall_batch_write(&batch, OE_STDOUT_FILENO, "\n", 1) == 3);
+    OE_TEST(oe_syscall_batch_submit(&batch) == 0);
+
+    OE_TEST(oe_syscall_batch_result(&batch, 0, &error) == 26);
+    OE_TEST(memcmp(buf, ALPHABET, 26) == 0);
+    OE_TEST(oe_syscall_batch_result(&batch, 1, &error) == 0);
+    OE_TEST(oe_syscall_batch_result(&batch, 2, &error) == -1);
+    OE_TEST(error == OE_EBADF);
+    OE_TEST(oe_syscall_batch_result(&batch, 3, &error) == 1);
+
+    /* The close released the enclave descriptor. */
+    OE_TEST(close(fd) == -1);
+    OE_TEST(errno == EBADF);
+
+    /* Batches hold at most OE_SYSCALL_BATCH_MAX operations. */
+    for (size_t i = 0; i < OE_SYSCALL_BATCH_MAX; i++)
+        OE_TEST(oe_syscall_batch_fstat(&batch, OE_STDOUT_FILENO, &st) >= 0);
+
+    OE_TEST(oe_syscall_batch_fstat(&batch, OE_STDOUT_FILENO, &st) == -1);
+    OE_TEST(oe_errno == OE_EAGAIN);
+    OE_TEST(oe_syscall_batch_submit(&batch) == 0);
+
+    OE_TEST(unlink(path) == 0);
+
+    OE_TEST(umount("/") == 0);
+}
+
 void test_fs(const char* src_dir, const char* tmp_dir)
 {
     (void)src_dir;
@@ -659,6 +857,12 @@ void test_fs(const char* src_dir, const char* tmp_dir)
 
     test_zero_sized_iovs();
 
+    test_positional_io(tmp_dir);
+
+    test_readdir_many(tmp_dir);
+
+    test_batch(tmp_dir);
+
     /* Note: these must come last since they change STDOUT and STDERR. */
     test_dup_case1(tmp_dir);
     test_dup_case2(tmp_dir);
@@ -2,10 +2,15 @@
 // Licensed under the MIT License.
 
 #include <openenclave/corelibc/stdio.h>
+#include <openenclave/corelibc/stdlib.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/syscall/sys/epoll.h>
 #include <openenclave/internal/syscall/sys/select.h>
 #include <openenclave/internal/syscall/sys/socket.h>
+#include <openenclave/internal/syscall/unistd.h>
 #include <openenclave/internal/tests.h>
+#include <openenclave/internal/time.h>
+#include <openenclave/internal/types.h>
 #include "../client.h"
 #include "../server.h"
 
@@ -324,6 +329,88 @@ extern "C" void test_fd_set(void)
     oe_printf("==== passed %s\n", __FUNCTION__);
 }
 
+/* Watch num_pairs readable socketpairs with a single epoll instance, and
+ * time epoll_ctl() and epoll_wait() as the number of watched fds grows. The
+ * socketpairs stay on the host, so the benchmark needs no network. */
+extern "C" void benchmark_epoll(size_t num_pairs, size_t num_waits)
+{
+    const int MAX_EVENTS = 256;
+    struct oe_epoll_event events[MAX_EVENTS];
+    int(*pairs)[2] = NULL;
+    int epfd;
+    uint64_t start;
+    uint64_t ctl_msec;
+    uint64_t wait_msec;
+    uint64_t num_events = 0;
+
+    _init();
+
+    OE_TEST((pairs = (int(*)[2])oe_calloc(num_pairs, sizeof(*pairs))));
+    OE_TEST((epfd = oe_epoll_create1(0)) >= 0);
+
+    /* Make one end of every pair readable, and watch it. */
+    start = oe_get_time();
+    for (size_t i = 0; i < num_pairs; i++)
+    {
+        struct oe_epoll_event event = {};
+
+        OE_TEST(oe_socketpair(OE_AF_LOCAL, OE_SOCK_STREAM, 0, pairs[i]) == 0);
+        OE_TEST(oe_write(pairs[i][0], "x", 1) == 1);
+
+        event.events = OE_EPOLLIN;
+        event.data.u64 = i;
+        OE_TEST(oe_epoll_ctl(epfd, OE_EPOLL_CTL_ADD, pairs[i][1], &event) == 0);
+    }
+    ctl_msec = oe_get_time() - start;
+
+    /* The watched fds stay readable, so every wait returns a full batch. */
+    start = oe_get_time();
+    for (size_t n = 0; n < num_waits; n++)
+    {
+        int count = oe_epoll_wait(epfd, events, MAX_EVENTS, 0);
+
+        OE_TEST(count > 0 && count <= MAX_EVENTS);
+
+        for (int i = 0; i < count; i++)
+            OE_TEST(events[i].data.u64 < num_pairs);
+
+        num_events += (uint64_t)count;
+    }
+    wait_msec = oe_get_time() - start;
+
+    /* Stop watching every other pair, and check that none of them is
+     * reported anymore. */
+    for (size_t i = 0; i < num_pairs; i += 2)
+        OE_TEST(oe_epoll_ctl(epfd, OE_EPOLL_CTL_DEL, pairs[i][1], NULL) == 0);
+
+    for (size_t n = 0; n < 4; n++)
+    {
+        int count = oe_epoll_wait(epfd, events, MAX_EVENTS, 0);
+
+        OE_TEST(count > 0);
+
+        for (int i = 0; i < count; i++)
+            OE_TEST(events[i].data.u64 % 2 == 1);
+    }
+
+    oe_printf(
+        "%s: %zu pairs: %llu ms to add, %llu events in %llu ms\n",
+        __FUNCTION__,
+        num_pairs,
+        OE_LLU(ctl_msec),
+        OE_LLU(num_events),
+        OE_LLU(wait_msec));
+
+    for (size_t i = 0; i < num_pairs; i++)
+    {
+        oe_close(pairs[i][0]);
+        oe_close(pairs[i][1]);
+    }
+
+    oe_close(epfd);
+    oe_free(pairs);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
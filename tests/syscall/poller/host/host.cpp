@@ -17,6 +17,10 @@
 
 static const uint16_t PORT = 12347;
 static const size_t NUM_CLIENTS = 4;
+
+/* Each socketpair takes two host fds, so stay below the default limit. */
+static const size_t NUM_EPOLL_PAIRS = 400;
+static const size_t NUM_EPOLL_WAITS = 10000;
 static oe_enclave_t* _enclave;
 
 typedef struct thread_arg
@@ -157,6 +161,14 @@ int main(int argc, const char* argv[])
 
     test_fd_set(_enclave);
 
+    if (poller_type == POLLER_TYPE_EPOLL)
+    {
+        printf("=== start benchmark_epoll()\n");
+        r = benchmark_epoll(_enclave, NUM_EPOLL_PAIRS, NUM_EPOLL_WAITS);
+        OE_TEST(r == OE_OK);
+        printf("=== passed benchmark_epoll()\n");
+    }
+
     r = oe_terminate_enclave(_enclave);
     OE_TEST(r == OE_OK);
 
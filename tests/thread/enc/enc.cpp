@@ -272,6 +272,51 @@ void enc_lock_and_unlock_mutexes(const char* mutex_ids)
     }
 }
 
+// Sum up how often contended threads got through by spinning and how often
+// they were parked.
+void enc_lock_statistics(uint64_t* spins, uint64_t* parks)
+{
+    oe_lock_statistics_t statistics;
+
+    OE_TEST(oe_get_lock_statistics(&statistics) == OE_OK);
+
+    *spins = statistics.mutex_spins + statistics.rwlock_spins +
+             statistics.cond_spins;
+    *parks = statistics.mutex_parks + statistics.rwlock_parks +
+             statistics.cond_parks;
+}
+
+void enc_set_lock_spin_count(uint32_t spin_count)
+{
+    oe_set_lock_spin_count(spin_count);
+}
+
+static oe_mutex_t _contended_mutex = OE_MUTEX_INITIALIZER;
+static std::atomic<bool> _contended_mutex_held(false);
+
+// Hold the contended mutex for the given number of pauses.
+void enc_hold_contended_mutex(uint64_t pauses)
+{
+    OE_TEST(oe_mutex_lock(&_contended_mutex) == OE_OK);
+    _contended_mutex_held = true;
+
+    for (uint64_t i = 0; i < pauses; i++)
+        asm volatile("pause");
+
+    OE_TEST(oe_mutex_unlock(&_contended_mutex) == OE_OK);
+}
+
+// Lock the contended mutex once enc_hold_contended_mutex() holds it.
+void enc_lock_contended_mutex()
+{
+    while (!_contended_mutex_held)
+        asm volatile("pause");
+
+    OE_TEST(oe_mutex_lock(&_contended_mutex) == OE_OK);
+    _contended_mutex_held = false;
+    OE_TEST(oe_mutex_unlock(&_contended_mutex) == OE_OK);
+}
+
 // test_tcs_exhaustion
 static std::atomic<size_t> g_tcs_used_thread_count(0);
 
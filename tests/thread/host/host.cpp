@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <openenclave/bits/lock.h>
 #include <openenclave/host.h>
 #include <openenclave/internal/error.h>
 #include <openenclave/internal/tests.h>
@@ -286,6 +287,69 @@ size_t host_tcs_out_thread_count()
     return g_tcs_out_thread_count;
 }
 
+// The condition variable tests always wait, so the contention counters of the
+// enclave must have moved by now.
+void test_lock_statistics(oe_enclave_t* enclave)
+{
+    uint64_t spins = 0;
+    uint64_t parks = 0;
+
+    OE_TEST(enc_lock_statistics(enclave, &spins, &parks) == OE_OK);
+    OE_TEST(spins + parks > 0);
+
+    printf(
+        "test_lock_statistics: %llu waits ended while spinning, %llu parked\n",
+        (unsigned long long)spins,
+        (unsigned long long)parks);
+}
+
+void hold_contended_mutex_thread(oe_enclave_t* enclave, uint64_t pauses)
+{
+    OE_TEST(enc_hold_contended_mutex(enclave, pauses) == OE_OK);
+}
+
+// Make a thread wait for a mutex that another thread holds for a while, and
+// return how the contention counters of the enclave moved.
+static void _contend_mutex(
+    oe_enclave_t* enclave,
+    uint32_t spin_count,
+    uint64_t* spins,
+    uint64_t* parks)
+{
+    const uint64_t pauses = 100000;
+    uint64_t spins_before = 0;
+    uint64_t parks_before = 0;
+
+    OE_TEST(enc_set_lock_spin_count(enclave, spin_count) == OE_OK);
+    OE_TEST(
+        enc_lock_statistics(enclave, &spins_before, &parks_before) == OE_OK);
+
+    std::thread holder(hold_contended_mutex_thread, enclave, pauses);
+    OE_TEST(enc_lock_contended_mutex(enclave) == OE_OK);
+    holder.join();
+
+    OE_TEST(enc_lock_statistics(enclave, spins, parks) == OE_OK);
+    *spins -= spins_before;
+    *parks -= parks_before;
+}
+
+// A waiter with a spin budget longer than the hold gets the mutex while
+// spinning, and a waiter without a spin budget is parked.
+void test_lock_contention(oe_enclave_t* enclave)
+{
+    uint64_t spins = 0;
+    uint64_t parks = 0;
+
+    _contend_mutex(enclave, OE_UINT32_MAX, &spins, &parks);
+    OE_TEST(spins > 0);
+
+    _contend_mutex(enclave, 0, &spins, &parks);
+    OE_TEST(parks > 0);
+
+    OE_TEST(
+        enc_set_lock_spin_count(enclave, OE_LOCK_DEFAULT_SPIN_COUNT) == OE_OK);
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -318,6 +382,10 @@ int main(int argc, const char* argv[])
 
     test_readers_writer_lock(enclave);
 
+    test_lock_statistics(enclave);
+
+    test_lock_contention(enclave);
+
     test_tcs_exhaustion(enclave);
 
     if ((result = oe_terminate_enclave(enclave)) != OE_OK)
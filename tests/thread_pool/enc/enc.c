@@ -0,0 +1,291 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <errno.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <openenclave/internal/threadpool.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include "thread_pool_test_t.h"
+
+#define MAX_WORKERS 64
+
+#define PARALLEL_COUNT 100000
+
+static volatile int _counter;
+static volatile int _release;
+static volatile int _started;
+
+static void* _increment(void* arg)
+{
+    __atomic_add_fetch(&_counter, 1, __ATOMIC_SEQ_CST);
+    return arg;
+}
+
+static void* _return_self(void* arg)
+{
+    pthread_t* self = (pthread_t*)arg;
+
+    *self = pthread_self();
+    return NULL;
+}
+
+static pthread_key_t _key;
+static volatile int _num_destructed;
+static __thread int _thread_value;
+
+static void _destruct(void* value)
+{
+    OE_TEST(value == &_thread_value);
+    __atomic_add_fetch(&_num_destructed, 1, __ATOMIC_SEQ_CST);
+}
+
+/* Leave a thread-local value and a key value behind, and return whether the
+ * thread started out without either */
+static void* _set_thread_state(void* arg)
+{
+    bool clean = _thread_value == 0 && pthread_getspecific(_key) == NULL;
+
+    (void)arg;
+    _thread_value = 1;
+    OE_TEST(pthread_setspecific(_key, &_thread_value) == 0);
+    return (void*)(uintptr_t)clean;
+}
+
+static void* _wait_for_release(void* arg)
+{
+    __atomic_add_fetch(&_started, 1, __ATOMIC_SEQ_CST);
+
+    while (!__atomic_load_n(&_release, __ATOMIC_ACQUIRE))
+        __builtin_ia32_pause();
+
+    return arg;
+}
+
+size_t enc_get_num_workers(void)
+{
+    return oe_thread_pool_get_num_workers();
+}
+
+/* Create and join threads until the counter reaches count, with at most
+ * max_threads threads in flight. */
+static void _create_and_join(size_t count, size_t max_threads)
+{
+    pthread_t threads[MAX_WORKERS];
+
+    for (size_t done = 0; done < count;)
+    {
+        size_t n = count - done < max_threads ? count - done : max_threads;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            void* arg = (void*)(uintptr_t)(done + i);
+            OE_TEST(pthread_create(&threads[i], NULL, _increment, arg) == 0);
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            void* retval = NULL;
+            OE_TEST(pthread_join(threads[i], &retval) == 0);
+            OE_TEST(retval == (void*)(uintptr_t)(done + i));
+        }
+
+        done += n;
+    }
+}
+
+int enc_test_threads(void)
+{
+    const size_t num_workers = oe_thread_pool_get_num_workers();
+    pthread_t threads[MAX_WORKERS];
+    pthread_t self = 0;
+    pthread_t thread;
+    pthread_attr_t attr;
+    void* retval = NULL;
+
+    OE_TEST(num_workers > 0 && num_workers <= MAX_WORKERS);
+
+    /* Every thread runs and returns its argument */
+    _counter = 0;
+    _create_and_join(100, num_workers);
+    OE_TEST(_counter == 100);
+
+    /* A thread sees its own handle in pthread_self() */
+    OE_TEST(pthread_create(&thread, NULL, _return_self, &self) == 0);
+    OE_TEST(pthread_join(thread, NULL) == 0);
+    OE_TEST(pthread_equal(thread, self));
+    OE_TEST(!pthread_equal(thread, pthread_self()));
+
+    /* The key destructors run before a thread is joined, and a thread does
+     * not see the thread-local or key values of a previous thread */
+    _num_destructed = 0;
+    OE_TEST(pthread_key_create(&_key, _destruct) == 0);
+
+    for (size_t i = 0; i < 2 * num_workers; i++)
+    {
+        OE_TEST(pthread_create(&thread, NULL, _set_thread_state, NULL) == 0);
+        OE_TEST(pthread_join(thread, &retval) == 0);
+        OE_TEST(retval == (void*)1);
+        OE_TEST(_num_destructed == (int)i + 1);
+    }
+
+    OE_TEST(pthread_key_delete(_key) == 0);
+
+    /* Creating more threads than there are workers fails with EAGAIN */
+    _release = 0;
+    _started = 0;
+
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        void* arg = (void*)(uintptr_t)i;
+        OE_TEST(
+            pthread_create(&threads[i], NULL, _wait_for_release, arg) == 0);
+    }
+
+    OE_TEST(pthread_create(&thread, NULL, _increment, NULL) == EAGAIN);
+
+    while (__atomic_load_n(&_started, __ATOMIC_ACQUIRE) != (int)num_workers)
+        __builtin_ia32_pause();
+
+    __atomic_store_n(&_release, 1, __ATOMIC_RELEASE);
+
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        OE_TEST(pthread_join(threads[i], &retval) == 0);
+        OE_TEST(retval == (void*)(uintptr_t)i);
+    }
+
+    /* A detached thread frees itself */
+    _counter = 0;
+    OE_TEST(pthread_create(&thread, NULL, _increment, NULL) == 0);
+    OE_TEST(pthread_detach(thread) == 0);
+
+    while (__atomic_load_n(&_counter, __ATOMIC_ACQUIRE) != 1)
+        __builtin_ia32_pause();
+
+    OE_TEST(pthread_attr_init(&attr) == 0);
+    OE_TEST(
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) == 0);
+    OE_TEST(pthread_create(&thread, &attr, _increment, NULL) == 0);
+    OE_TEST(pthread_attr_destroy(&attr) == 0);
+
+    while (__atomic_load_n(&_counter, __ATOMIC_ACQUIRE) != 2)
+        __builtin_ia32_pause();
+
+    return 0;
+}
+
+int enc_create_join(size_t iterations)
+{
+    _counter = 0;
+    _create_and_join(iterations, oe_thread_pool_get_num_workers());
+    OE_TEST((size_t)_counter == iterations);
+
+    return 0;
+}
+
+static uint8_t _visits[PARALLEL_COUNT];
+
+static void _visit(size_t begin, size_t end, void* arg)
+{
+    size_t grain = (size_t)arg;
+
+    OE_TEST(begin < end && end <= PARALLEL_COUNT);
+    OE_TEST(grain == 0 || end - begin <= grain);
+
+    for (size_t i = begin; i < end; i++)
+        __atomic_add_fetch(&_visits[i], 1, __ATOMIC_RELAXED);
+}
+
+/* Run an inner loop over 10 indices for each index of the outer loop */
+static void _visit_nested(size_t begin, size_t end, void* arg)
+{
+    (void)arg;
+
+    for (size_t i = begin; i < end; i++)
+        OE_TEST(oe_parallel_for(i * 10, i * 10 + 10, 1, _visit, NULL) == OE_OK);
+}
+
+static void _check_visits(size_t begin, size_t end)
+{
+    for (size_t i = 0; i < PARALLEL_COUNT; i++)
+        OE_TEST(_visits[i] == (i >= begin && i < end ? 1 : 0));
+
+    memset(_visits, 0, sizeof(_visits));
+}
+
+int enc_test_parallel_for(void)
+{
+    static const size_t grains[] = {0, 1, 7, 1000, PARALLEL_COUNT};
+
+    /* Every index of the range is passed to exactly one call */
+    for (size_t i = 0; i < OE_COUNTOF(grains); i++)
+    {
+        void* arg = (void*)grains[i];
+
+        OE_TEST(
+            oe_parallel_for(0, PARALLEL_COUNT, grains[i], _visit, arg) ==
+            OE_OK);
+        _check_visits(0, PARALLEL_COUNT);
+
+        OE_TEST(oe_parallel_for(123, 4567, grains[i], _visit, arg) == OE_OK);
+        _check_visits(123, 4567);
+    }
+
+    /* An empty range makes no calls */
+    OE_TEST(oe_parallel_for(5, 5, 0, _visit, NULL) == OE_OK);
+    _check_visits(0, 0);
+
+    /* Loops nest */
+    OE_TEST(
+        oe_parallel_for(0, PARALLEL_COUNT / 10, 0, _visit_nested, NULL) ==
+        OE_OK);
+    _check_visits(0, PARALLEL_COUNT);
+
+    OE_TEST(oe_parallel_for(0, 1, 0, NULL, NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_parallel_for(1, 0, 0, _visit, NULL) == OE_INVALID_PARAMETER);
+
+    return 0;
+}
+
+static uint64_t _hash(size_t index)
+{
+    uint64_t h = 0xcbf29ce484222325 ^ index;
+
+    for (size_t i = 0; i < 64; i++)
+        h = (h ^ (h >> 29)) * 0x100000001b3;
+
+    return h;
+}
+
+static void _hash_range(size_t begin, size_t end, void* arg)
+{
+    uint64_t sum = 0;
+
+    for (size_t i = begin; i < end; i++)
+        sum += _hash(i);
+
+    __atomic_add_fetch((uint64_t*)arg, sum, __ATOMIC_RELAXED);
+}
+
+uint64_t enc_hash_range(size_t count, bool parallel)
+{
+    uint64_t sum = 0;
+
+    if (parallel)
+        OE_TEST(oe_parallel_for(0, count, 0, _hash_range, &sum) == OE_OK);
+    else
+        _hash_range(0, count, &sum);
+
+    return sum;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    512,  /* HeapPageCount */
+    512,  /* StackPageCount */
+    8);   /* TCSCount */
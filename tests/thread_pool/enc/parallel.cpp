@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <atomic>
+#include <vector>
+#include "thread_pool_test_t.h"
+
+int enc_test_parallel_for_cpp()
+{
+    const size_t count = 50000;
+    std::vector<std::atomic<int>> visits(count);
+    std::atomic<size_t> calls(0);
+
+    for (auto& visit : visits)
+        visit = 0;
+
+    OE_TEST(
+        oe::parallel_for(0, count, 100, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                visits[i]++;
+
+            calls++;
+        }) == OE_OK);
+
+    for (auto& visit : visits)
+        OE_TEST(visit == 1);
+
+    OE_TEST(calls >= count / 100);
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <time.h>
+#include "thread_pool_test_u.h"
+
+#define ITERATIONS 10000
+#define HASH_COUNT (4 * 1024 * 1024)
+
+// Both enclaves run the loops, on the calling thread alone when there is no
+// pool.
+static void _run_parallel_for_tests(oe_enclave_t* enclave)
+{
+    int retval = -1;
+
+    OE_TEST(enc_test_parallel_for(enclave, &retval) == OE_OK);
+    OE_TEST(retval == 0);
+
+    OE_TEST(enc_test_parallel_for_cpp(enclave, &retval) == OE_OK);
+    OE_TEST(retval == 0);
+}
+
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+// Measure how many threads the enclave creates and joins per second.
+static void _run_create_join_benchmark(oe_enclave_t* enclave)
+{
+    struct timespec start, end;
+    int retval = -1;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    OE_TEST(enc_create_join(enclave, &retval, ITERATIONS) == OE_OK);
+    OE_TEST(retval == 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (double)(end.tv_sec - start.tv_sec) +
+                     (double)(end.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    printf("create/join: %.0f threads/sec\n", ITERATIONS / seconds);
+}
+
+static double _time_hash_range(oe_enclave_t* enclave, bool parallel)
+{
+    struct timespec start, end;
+    uint64_t sum = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    OE_TEST(enc_hash_range(enclave, &sum, HASH_COUNT, parallel) == OE_OK);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (double)(end.tv_sec - start.tv_sec) +
+           (double)(end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
+
+// Compare a CPU-bound loop on the calling thread with the same loop spread
+// across the pool.
+static void _run_parallel_for_benchmark(oe_enclave_t* enclave)
+{
+    double serial = _time_hash_range(enclave, false);
+    double parallel = _time_hash_range(enclave, true);
+
+    printf(
+        "parallel_for: %.3f sec serial, %.3f sec parallel (%.1fx)\n",
+        serial,
+        parallel,
+        serial / parallel);
+}
+#endif
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+    size_t num_workers = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    /* Without the config, the enclave has no pool */
+    OE_TEST(
+        oe_create_thread_pool_test_enclave(
+            argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave) == OE_OK);
+    OE_TEST(enc_get_num_workers(enclave, &num_workers) == OE_OK);
+    OE_TEST(num_workers == 0);
+    _run_parallel_for_tests(enclave);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+#ifdef OE_CONTEXT_SWITCHLESS_EXPERIMENTAL_FEATURE
+    /* Lend four host threads to the enclave */
+    oe_enclave_config_thread_pool_t thread_pool_config = {4};
+    oe_enclave_config_t config;
+    int retval = -1;
+
+    config.config_type = OE_ENCLAVE_CONFIG_THREAD_POOL;
+    config.u.thread_pool_config = &thread_pool_config;
+
+    OE_TEST(
+        oe_create_thread_pool_test_enclave(
+            argv[1], OE_ENCLAVE_TYPE_SGX, flags, &config, 1, &enclave) ==
+        OE_OK);
+    OE_TEST(enc_get_num_workers(enclave, &num_workers) == OE_OK);
+    OE_TEST(num_workers == 4);
+
+    OE_TEST(enc_test_threads(enclave, &retval) == OE_OK);
+    OE_TEST(retval == 0);
+
+    _run_parallel_for_tests(enclave);
+
+    _run_create_join_benchmark(enclave);
+    _run_parallel_for_benchmark(enclave);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+#else
+    printf("thread pool: skipped, experimental feature disabled\n");
+#endif
+
+    printf("=== passed all tests (thread_pool)\n");
+
+    return 0;
+}
@@ -260,6 +260,21 @@ let oe_gen_wrapper_prototype (fd : func_decl) (is_ecall : bool) =
   in
   sprintf "oe_result_t %s(%s)" fd.fname plist_str
 
+(** Generate the enclave wrapper prototype for a given untrusted
+    function. Asynchronous ocalls take an [oe_async_ocall_t*] first
+    parameter, which receives the handle of the call. *)
+let oe_gen_ocall_wrapper_prototype (uf : untrusted_func) =
+  let fd = uf.uf_fdecl in
+  if uf.uf_is_async then
+    let args = "oe_async_ocall_t* _handle" :: List.map gen_parm_str fd.plist in
+    let plist_str =
+      match args with
+      | [arg] -> arg
+      | _ -> "\n    " ^ String.concat ",\n    " args
+    in
+    sprintf "oe_result_t %s(%s)" fd.fname plist_str
+  else oe_gen_wrapper_prototype fd false
+
 (** Emit [struct], [union], or [enum]. *)
 let emit_composite_type =
   let emit_struct (s : struct_def) =
@@ -474,8 +489,8 @@ let gen_enclave_code (ec : enclave_content) (ep : edger8r_params) =
           f.tf_fdecl.fname ;
       if f.tf_is_switchless && not ep.experimental then
         failwithf
-          "Function '%s': switchless ecalls are not yet supported \
-           by Open Enclave SDK."
+          "Function '%s': switchless ecalls are experimental and require \
+           the --experimental option."
           f.tf_fdecl.fname )
     tfs ;
   List.iter
@@ -496,9 +511,27 @@ let gen_enclave_code (ec : enclave_content) (ep : edger8r_params) =
           f.uf_fdecl.fname ;
       if f.uf_is_switchless && not ep.experimental then
         failwithf
-          "Function '%s': switchless ocalls are not yet supported \
-           by Open Enclave SDK."
-           f.uf_fdecl.fname )
+          "Function '%s': switchless ocalls are experimental and require \
+           the --experimental option."
+           f.uf_fdecl.fname ;
+      if f.uf_is_async && not f.uf_is_switchless then
+        failwithf
+          "Function '%s': asynchronous ocalls require \
+           transition_using_threads."
+          f.uf_fdecl.fname ;
+      if f.uf_is_async && f.uf_fdecl.rtype <> Void then
+        failwithf "Function '%s': asynchronous ocalls must return void."
+          f.uf_fdecl.fname ;
+      if f.uf_is_async && List.exists is_out_or_inout_ptr f.uf_fdecl.plist
+      then
+        failwithf
+          "Function '%s': asynchronous ocalls cannot have out or in-out \
+           parameters."
+          f.uf_fdecl.fname ;
+      if f.uf_is_async && f.uf_propagate_errno then
+        failwithf
+          "Function '%s': asynchronous ocalls cannot propagate errno."
+          f.uf_fdecl.fname )
     ufs ;
   (* Map warning functions over trusted and untrusted function
      declarations *)
@@ -1136,7 +1169,11 @@ let gen_enclave_code (ec : enclave_content) (ep : edger8r_params) =
   let oe_gen_enclave_ocall_wrapper (uf : untrusted_func) =
     let fd = uf.uf_fdecl in
     let allocate_buffer, call_function, free_buffer =
-      if uf.uf_is_switchless then
+      if uf.uf_is_async then
+        ( "oe_allocate_async_ocall_buffer"
+        , "oe_async_call_host_function"
+        , "oe_free_async_ocall_buffer" )
+      else if uf.uf_is_switchless then
         ( "oe_allocate_switchless_ocall_buffer"
         , "oe_switchless_call_host_function"
         , "oe_free_switchless_ocall_buffer" )
@@ -1145,7 +1182,48 @@ let gen_enclave_code (ec : enclave_content) (ep : edger8r_params) =
         , "oe_call_host_function"
         , "oe_free_ocall_buffer" )
     in
-    [ oe_gen_wrapper_prototype fd false
+    (* An asynchronous ocall hands its marshalling buffer over to the
+       call, and returns without waiting for any output. *)
+    let call_host_function =
+      if uf.uf_is_async then
+        [ "    /* Call host function asynchronously. The marshalling buffer \
+           is owned"
+        ; "       by the asynchronous ocall from here on, even on failure. */"
+        ; "    _result = " ^ call_function ^ "("
+        ; "        "
+          ^ String.concat ",\n        "
+              [ get_function_id fd
+              ; "_input_buffer"
+              ; "_input_buffer_size"
+              ; "_output_buffer"
+              ; "_output_buffer_size"
+              ; "_handle);" ]
+        ; "    _buffer = NULL;"
+        ; "    OE_UNUSED(_pargs_out);"
+        ; "    OE_UNUSED(_output_bytes_written);" ]
+      else
+        [ "    /* Call host function. */"
+        ; "    if ((_result = " ^ call_function ^ "("
+        ; "             "
+          ^ String.concat ",\n             "
+              [ get_function_id fd
+              ; "_input_buffer"
+              ; "_input_buffer_size"
+              ; "_output_buffer"
+              ; "_output_buffer_size"
+              ; "&_output_bytes_written)) != OE_OK)" ]
+        ; "        goto done;"
+        ; ""
+        ; "    " ^ String.concat "\n    " (oe_process_output_buffer fd)
+        ; ""
+        ; "    /* Retrieve propagated errno from OCALL. */"
+        ; ( if uf.uf_propagate_errno then
+            "    errno = _pargs_out->_ocall_errno;\n"
+          else sprintf "    /* Errno propagation not enabled. */" )
+        ; ""
+        ; "    _result = OE_OK;" ]
+    in
+    [ oe_gen_ocall_wrapper_prototype uf
     ; "{"
     ; "    oe_result_t _result = OE_FAILURE;"
     ; ""
@@ -1178,25 +1256,7 @@ let gen_enclave_code (ec : enclave_content) (ep : edger8r_params) =
     ; "    "
       ^ String.concat "\n    " (oe_prepare_input_buffer fd allocate_buffer)
     ; ""
-    ; "    /* Call host function. */"
-    ; "    if ((_result = " ^ call_function ^ "("
-    ; "             "
-      ^ String.concat ",\n             "
-          [ get_function_id fd
-          ; "_input_buffer"
-          ; "_input_buffer_size"
-          ; "_output_buffer"
-          ; "_output_buffer_size"
-          ; "&_output_bytes_written)) != OE_OK)" ]
-    ; "        goto done;"
-    ; ""
-    ; "    " ^ String.concat "\n    " (oe_process_output_buffer fd)
-    ; ""
-    ; "    /* Retrieve propagated errno from OCALL. */"
-    ; ( if uf.uf_propagate_errno then "    errno = _pargs_out->_ocall_errno;\n"
-      else sprintf "    /* Errno propagation not enabled. */" )
-    ; ""
-    ; "    _result = OE_OK;"
+    ; String.concat "\n" call_host_function
     ; ""
     ; "done:"
     ; "    if (_buffer)"
@@ -1272,7 +1332,7 @@ let gen_enclave_code (ec : enclave_content) (ep : edger8r_params) =
     let oe_gen_ufunc_wrapper_prototypes =
       if ufs <> [] then
         List.map
-          (fun f -> sprintf "%s;" (oe_gen_wrapper_prototype f.uf_fdecl false))
+          (fun f -> sprintf "%s;" (oe_gen_ocall_wrapper_prototype f))
           ufs
       else ["/* There were no ocalls. */"]
     in
@@ -108,6 +108,7 @@ let get_call_conv_str (cc: call_conv) =
 type func_attr = {
   fa_dllimport : bool;                   (* use 'dllimport'? *)
   fa_convention: call_conv;              (* the calling convention *)
+  fa_async     : bool;                   (* return without waiting? *)
 }
 
 (* A declarator can be an identifier or an identifier with array form.
@@ -180,6 +181,7 @@ type untrusted_func = {
   uf_allow_list : string list; (* allow list, see above comment *)
   uf_propagate_errno : bool; (* whether this function changes errno *)
   uf_is_switchless    : bool;
+  uf_is_async         : bool; (* whether the caller does not wait for the host *)
 }
 
 type enclave_func =